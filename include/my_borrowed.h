@@ -0,0 +1,199 @@
+// my_borrowed.h
+#ifndef MY_BORROWED_H
+#define MY_BORROWED_H
+
+// ============================================================================
+// Borrowed<T>: 不持有所有权、不改动计数的借用视图
+// ============================================================================
+// 深层调用链只在少数叶子需要保留引用时,按值传 SharedPtr 每层都要一次原子
+// 加减;Borrowed 只复制对象指针和控制块指针,叶子需要时再 promote() 成
+// SharedPtr,只付一次 AddRefCopy。
+//
+//   void Handle(my::Borrowed<Request> req) {
+//     if (req->async) queue.push(req.promote());
+//   }
+//   Handle(request_sp);  // 从 SharedPtr 隐式构造,不碰计数
+//
+// 约定和 std::string_view 一样:借用期间必须有别的 SharedPtr 让对象存活,
+// 视图不能比它的源活得更久。
+//
+// 以 -DMY_SP_ENABLE_BORROW_CHECK 编译时,视图额外持有控制块的弱引用,
+// 在访问、promote() 和析构时做"对象已死"检查:强引用计数归零(视图比对象
+// 活得更久)就调用违例处理函数(默认打印后 abort,可用
+// set_borrow_violation_handler() 替换)。这会让每次借用多一次
+// WeakAddRef/WeakRelease,只用于调试。
+// 检查只看对象,不跟踪借用时的那个 SharedPtr:源已经析构、但别的 SharedPtr
+// 仍让对象存活时,违反约定的视图不会被报告。
+// 未定义该宏时 Borrowed 就是两个指针,没有任何额外代码。
+
+#include <cstddef>
+#include <stdint.h>
+
+#include "my_shared_ptr.h"
+
+namespace my {
+
+// 违例处理函数:control_block 是被越界借用的控制块,what 是触发检查的操作
+typedef void (*BorrowViolationHandler)(const void* control_block, const char* what);
+
+}  // namespace my
+
+#ifdef MY_SP_ENABLE_BORROW_CHECK
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+
+namespace my {
+namespace detail {
+
+inline void DefaultBorrowViolation(const void* control_block, const char* what) {
+  std::fprintf(stderr, "Borrowed 比对象活得更久: 控制块 %p, 操作 %s\n",
+               control_block, what);
+  std::abort();
+}
+
+// 零初始化,静态构造期间也可以安全读取;nullptr 表示默认处理
+inline std::atomic<BorrowViolationHandler>& BorrowViolationHandlerSlot() noexcept {
+  static std::atomic<BorrowViolationHandler> slot;
+  return slot;
+}
+
+// "对象已死"检查:持有控制块的弱引用,保证检查时控制块本身还在。
+// 只能看到对象的强引用计数,区分不了借用时的源和其他所有者
+class ObjectOutlivedCheck {
+ public:
+  ObjectOutlivedCheck() noexcept {}
+
+  explicit ObjectOutlivedCheck(const SharedCount& owner) noexcept : owner_(owner) {}
+
+  ~ObjectOutlivedCheck() { CheckObjectAlive("~Borrowed"); }
+
+  // 对象仍存活返回 true;否则报告违例(处理函数返回时结果为 false)
+  bool CheckObjectAlive(const char* what) const {
+    if (owner_.empty() || owner_.use_count() != 0) return true;
+    BorrowViolationHandler handler =
+        BorrowViolationHandlerSlot().load(std::memory_order_acquire);
+    (handler ? handler : DefaultBorrowViolation)(owner_.GetControlBlock(), what);
+    return false;
+  }
+
+ private:
+  WeakCount owner_;
+};
+
+}  // namespace detail
+
+// 替换违例处理函数(nullptr 恢复默认的打印后 abort),返回之前的处理函数
+inline BorrowViolationHandler set_borrow_violation_handler(
+    BorrowViolationHandler handler) noexcept {
+  return detail::BorrowViolationHandlerSlot().exchange(handler,
+                                                       std::memory_order_acq_rel);
+}
+
+}  // namespace my
+
+#else  // !MY_SP_ENABLE_BORROW_CHECK
+
+namespace my {
+namespace detail {
+
+// 空基类,借助空基类优化不占空间
+class ObjectOutlivedCheck {
+ public:
+  ObjectOutlivedCheck() noexcept {}
+  explicit ObjectOutlivedCheck(const SharedCount&) noexcept {}
+  bool CheckObjectAlive(const char*) const noexcept { return true; }
+};
+
+}  // namespace detail
+
+inline BorrowViolationHandler set_borrow_violation_handler(
+    BorrowViolationHandler) noexcept {
+  return nullptr;
+}
+
+}  // namespace my
+
+#endif  // MY_SP_ENABLE_BORROW_CHECK
+
+namespace my {
+
+template <typename T>
+class Borrowed : private detail::ObjectOutlivedCheck {
+ public:
+  using element_type = T;
+
+  // ------------------------------------------------------------------------
+  // 构造函数
+  // ------------------------------------------------------------------------
+
+  Borrowed() noexcept : ptr_(nullptr), control_block_(nullptr) {}
+
+  Borrowed(std::nullptr_t) noexcept : ptr_(nullptr), control_block_(nullptr) {}
+
+  // 从 SharedPtr 借用:隐式转换,只复制两个指针
+  template <typename Y>
+  Borrowed(const SharedPtr<Y>& source) noexcept
+      : detail::ObjectOutlivedCheck(detail::SpAccess::Count(source)),
+        ptr_(source.get()),
+        control_block_(detail::SpAccess::ControlBlock(source)) {}
+
+  // 向上转换(Borrowed<Derived> -> Borrowed<Base>)
+  template <typename Y>
+  Borrowed(const Borrowed<Y>& other) noexcept
+      : detail::ObjectOutlivedCheck(other),
+        ptr_(other.ptr_),
+        control_block_(other.control_block_) {}
+
+  // ------------------------------------------------------------------------
+  // 提升
+  // ------------------------------------------------------------------------
+
+  // 取得真正的所有权:一次 AddRefCopy;空视图返回空 SharedPtr
+  // 按约定源仍持有强引用,计数不会是 0,所以不需要 AddRefLock 的
+  // 死亡标志检查和复活处理
+  // (调试模式下发现对象已死,违例处理函数返回后也得到空 SharedPtr)
+  SharedPtr<T> promote() const noexcept {
+    if (!control_block_ || !CheckObjectAlive("promote")) return SharedPtr<T>();
+    control_block_->AddRefCopy();
+    return detail::SpAccess::Adopt(ptr_, control_block_);
+  }
+
+  // ------------------------------------------------------------------------
+  // 观察器
+  // ------------------------------------------------------------------------
+
+  T* get() const noexcept {
+    CheckObjectAlive("get");
+    return ptr_;
+  }
+
+  template <typename U = T>
+  typename std::enable_if<!std::is_void<U>::value, U&>::type operator*() const
+      noexcept {
+    return *get();
+  }
+
+  T* operator->() const noexcept { return get(); }
+
+  explicit operator bool() const noexcept { return ptr_ != nullptr; }
+
+  int64_t use_count() const noexcept {
+    return control_block_ ? control_block_->use_count() : 0;
+  }
+
+  // 与 SharedPtr::owner_key() 一致,可用于按所有者比较
+  const void* owner_key() const noexcept { return control_block_; }
+
+ private:
+  T* ptr_;
+  detail::SpCountedBase* control_block_;
+
+  template <typename Y>
+  friend class Borrowed;
+};
+
+}  // namespace my
+
+#endif  // MY_BORROWED_H
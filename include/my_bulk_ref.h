@@ -0,0 +1,171 @@
+// my_bulk_ref.h
+#ifndef MY_BULK_REF_H
+#define MY_BULK_REF_H
+
+// ============================================================================
+// 批量共享 / 批量释放:同一控制块上的 N 个引用只做一次原子操作
+// ============================================================================
+// 把一个消息广播给 N 个订阅者要拷贝 N 次 SharedPtr,也就是在同一缓存行上
+// 做 N 次 fetch_add;订阅者处理完再各自 fetch_sub。这里的函数把同一控制块
+// 上的增减合并成一次 SpCountedBase::AddRefCopyN / ReleaseN:
+// - share_n(sp, n, out):写出 n 个与 sp 共享所有权的 SharedPtr
+// - copy_coalesced(first, last, out):拷贝一段 SharedPtr,相邻且共享同一
+//   控制块的元素合并计数(例如大量元素指向同一对象的 vector)
+// - release_n(first, last) / release_n(container):释放一段 SharedPtr,
+//   相邻且共享同一控制块的元素合并为一次 ReleaseN
+//
+// 只合并相邻的元素:不排序、不额外分配,对互不相同的指针退化为逐个操作。
+// 写出时抛出异常(例如 back_inserter 分配失败)会归还尚未交出的引用。
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <stdint.h>
+#include <utility>
+
+#include "my_shared_ptr.h"
+
+namespace my {
+namespace detail {
+
+// 已经一次加上、尚未交出的强引用;异常退出时一次归还剩下的
+class PendingRefs {
+ public:
+  PendingRefs(SpCountedBase* control_block, size_t count) noexcept
+      : control_block_(control_block), count_(count) {
+    if (count_ > 0) control_block_->AddRefCopyN(static_cast<int64_t>(count_));
+  }
+
+  ~PendingRefs() noexcept {
+    if (count_ > 0) control_block_->ReleaseN(static_cast<int64_t>(count_));
+  }
+
+  // 交出其中一个
+  SpCountedBase* Take() noexcept {
+    --count_;
+    return control_block_;
+  }
+
+ private:
+  SpCountedBase* control_block_;
+  size_t count_;
+
+  PendingRefs(const PendingRefs&) = delete;
+  PendingRefs& operator=(const PendingRefs&) = delete;
+};
+
+// 沿序列提前 distance 个元素预取控制块,让一串缓存缺失重叠起来;
+// 元素是 SharedPtr 或 WeakPtr。distance 为 0 时什么也不做
+template <typename ForwardIt, bool kForWrite = true>
+class ControlBlockPrefetcher {
+ public:
+  ControlBlockPrefetcher(ForwardIt first, ForwardIt last, size_t distance) noexcept
+      : ahead_(first), last_(last), enabled_(distance > 0) {
+    for (size_t i = 0; i < distance && ahead_ != last_; ++i) Next();
+  }
+
+  // 每处理一个元素之前调用一次
+  void Advance() noexcept {
+    if (enabled_ && ahead_ != last_) Next();
+  }
+
+ private:
+  void Next() noexcept {
+    if (kForWrite) {
+      PrefetchControlBlock(SpAccess::ControlBlock(*ahead_));
+    } else {
+      PrefetchControlBlockForRead(SpAccess::ControlBlock(*ahead_));
+    }
+    ++ahead_;
+  }
+
+  ForwardIt ahead_;
+  ForwardIt last_;
+  bool enabled_;
+};
+
+// release_n 的实现;prefetch_distance > 0 时提前这么多个元素预取控制块
+// (release_all 用,见 my_parallel_release.h)
+template <typename ForwardIt>
+void ReleaseCoalesced(ForwardIt first, ForwardIt last, size_t prefetch_distance) noexcept {
+  ControlBlockPrefetcher<ForwardIt> prefetcher(first, last, prefetch_distance);
+  SpCountedBase* run_block = nullptr;
+  int64_t run = 0;
+  for (; first != last; ++first) {
+    prefetcher.Advance();
+    SpCountedBase* control_block = SpAccess::Detach(*first);
+    if (control_block != run_block) {
+      if (run > 0) run_block->ReleaseN(run);
+      run_block = control_block;
+      run = 0;
+    }
+    if (control_block) ++run;
+  }
+  if (run > 0) run_block->ReleaseN(run);
+}
+
+}  // namespace detail
+
+// 写出 n 个与 sp 共享所有权的 SharedPtr,一次原子操作;返回写完后的 out
+template <typename T, typename OutputIt>
+OutputIt share_n(const SharedPtr<T>& sp, size_t n, OutputIt out) {
+  detail::SpCountedBase* control_block = detail::SpAccess::ControlBlock(sp);
+  if (!control_block) {
+    for (size_t i = 0; i < n; ++i, ++out) *out = sp;  // 空指针:没有计数
+    return out;
+  }
+  detail::PendingRefs pending(control_block, n);
+  for (size_t i = 0; i < n; ++i) {
+    SharedPtr<T> handle = detail::SpAccess::Adopt(sp.get(), pending.Take());
+    *out = std::move(handle);  // 抛出时 handle 自己归还这一个
+    ++out;
+  }
+  return out;
+}
+
+// 拷贝 [first, last) 到 out,每段相邻且共享同一控制块的元素只做一次原子操作
+template <typename ForwardIt, typename OutputIt>
+OutputIt copy_coalesced(ForwardIt first, ForwardIt last, OutputIt out) {
+  typedef typename std::iterator_traits<ForwardIt>::value_type Shared;
+  while (first != last) {
+    detail::SpCountedBase* control_block = detail::SpAccess::ControlBlock(*first);
+    ForwardIt run_end = first;
+    size_t run = 0;
+    do {
+      ++run_end;
+      ++run;
+    } while (run_end != last &&
+             detail::SpAccess::ControlBlock(*run_end) == control_block);
+
+    if (!control_block) {
+      out = std::copy(first, run_end, out);
+    } else {
+      detail::PendingRefs pending(control_block, run);
+      for (; first != run_end; ++first) {
+        Shared handle = detail::SpAccess::Adopt(first->get(), pending.Take());
+        *out = std::move(handle);
+        ++out;
+      }
+    }
+    first = run_end;
+  }
+  return out;
+}
+
+// 释放 [first, last) 中的 SharedPtr 并置空;
+// 每段相邻且共享同一控制块的元素合并为一次 ReleaseN(例如 share_n 写出的一批)
+template <typename ForwardIt>
+void release_n(ForwardIt first, ForwardIt last) noexcept {
+  detail::ReleaseCoalesced(first, last, 0);
+}
+
+// 释放容器里的全部 SharedPtr 并清空容器
+template <typename Container>
+void release_n(Container& handles) noexcept {
+  release_n(std::begin(handles), std::end(handles));
+  handles.clear();
+}
+
+}  // namespace my
+
+#endif  // MY_BULK_REF_H
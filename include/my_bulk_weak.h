@@ -0,0 +1,102 @@
+// my_bulk_weak.h
+#ifndef MY_BULK_WEAK_H
+#define MY_BULK_WEAK_H
+
+// ============================================================================
+// 批量 lock / 过期扫描:对一大串 WeakPtr 预取控制块
+// ============================================================================
+// 观察者注册表每次分发都要对数组里的每个 WeakPtr 调用 lock();各个控制块
+// 散落在堆上,逐个 lock() 就是一串首尾相接的缓存缺失。这里的函数在处理
+// 当前元素时提前 prefetch_distance 个元素预取控制块(见
+// ControlBlockPrefetcher),让这些缺失重叠起来。lock() 本身用的是无条件
+// fetch_add(见 AtomicIncrementForLock),没有 CAS 重试,适合这样流水;
+// 已标记死亡的控制块先用一次只读加载跳过,不对它们做注定失败的 fetch_add。
+// - lock_all(first, last, out):把还活着的对象 lock 成 SharedPtr 写到 out
+// - count_expired(first, last):统计已过期(或为空)的 WeakPtr,只读不改计数
+// - lock_all_compact(container, out):与 lock_all 相同,同时在同一遍里
+//   把已过期的元素从容器中删掉(保持其余元素的相对顺序)
+
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
+#include "my_bulk_ref.h"
+#include "my_weak_ptr.h"
+
+namespace my {
+
+// 默认的预取距离:足够覆盖一次内存访问延迟,又不至于把预取的行挤出 L1
+const size_t kWeakScanPrefetchDistance = 16;
+
+namespace detail {
+
+// 为空,或控制块已标记死亡:lock() 必然失败,直接跳过以免弄脏缓存行
+template <typename Weak>
+bool KnownExpired(const Weak& weak) noexcept {
+  SpCountedBase* control_block = SpAccess::ControlBlock(weak);
+  return !control_block || control_block->IsMarkedDead();
+}
+
+}  // namespace detail
+
+// lock [first, last) 中的每个 WeakPtr,成功的写到 out(跳过已过期的);返回写完后的 out
+template <typename ForwardIt, typename OutputIt>
+OutputIt lock_all(ForwardIt first, ForwardIt last, OutputIt out,
+                  size_t prefetch_distance = kWeakScanPrefetchDistance) {
+  detail::ControlBlockPrefetcher<ForwardIt> prefetcher(first, last, prefetch_distance);
+  for (; first != last; ++first) {
+    prefetcher.Advance();
+    if (detail::KnownExpired(*first)) continue;
+    auto locked = first->lock();
+    if (!detail::SpAccess::ControlBlock(locked)) continue;  // 已过期或为空
+    *out = std::move(locked);
+    ++out;
+  }
+  return out;
+}
+
+// 统计 [first, last) 中已过期(或为空)的 WeakPtr
+template <typename ForwardIt>
+size_t count_expired(ForwardIt first, ForwardIt last,
+                     size_t prefetch_distance = kWeakScanPrefetchDistance) noexcept {
+  detail::ControlBlockPrefetcher<ForwardIt, false> prefetcher(first, last, prefetch_distance);
+  size_t expired = 0;
+  for (; first != last; ++first) {
+    prefetcher.Advance();
+    if (first->expired()) ++expired;
+  }
+  return expired;
+}
+
+// lock_all 并在同一遍里删掉容器中已过期的元素;返回写完后的 out
+// 写 out 时抛出异常:已处理部分中的过期元素已被删除,其余元素保持原样
+template <typename Container, typename OutputIt>
+OutputIt lock_all_compact(Container& weak_ptrs, OutputIt out,
+                          size_t prefetch_distance = kWeakScanPrefetchDistance) {
+  typedef decltype(std::begin(weak_ptrs)) Iterator;
+  Iterator it = std::begin(weak_ptrs);
+  const Iterator last = std::end(weak_ptrs);
+  Iterator keep = it;  // [begin, keep) 是保留下来的元素
+  detail::ControlBlockPrefetcher<Iterator> prefetcher(it, last, prefetch_distance);
+  try {
+    for (; it != last; ++it) {
+      prefetcher.Advance();
+      if (detail::KnownExpired(*it)) continue;
+      auto locked = it->lock();
+      if (!detail::SpAccess::ControlBlock(locked)) continue;
+      *out = std::move(locked);
+      ++out;
+      if (keep != it) *keep = std::move(*it);
+      ++keep;
+    }
+  } catch (...) {
+    weak_ptrs.erase(keep, it);
+    throw;
+  }
+  weak_ptrs.erase(keep, last);
+  return out;
+}
+
+}  // namespace my
+
+#endif  // MY_BULK_WEAK_H
@@ -0,0 +1,365 @@
+// my_cycle_collector.h
+#ifndef MY_CYCLE_COLLECTOR_H
+#define MY_CYCLE_COLLECTOR_H
+
+#include <cstddef>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "my_shared_ptr.h"
+
+// Release() 只在定义了该宏时通知回收器;整个程序要一致地定义(见 CMakeLists.txt)
+#ifndef MY_SP_ENABLE_CYCLE_COLLECTOR
+#error "my_cycle_collector.h 需要定义 MY_SP_ENABLE_CYCLE_COLLECTOR"
+#endif
+
+namespace my {
+
+// ============================================================================
+// CycleTracer: trace() 钩子的访问者
+// ============================================================================
+// 参与循环回收的类型提供:
+//   void trace(my::CycleTracer& tracer) { tracer(next_); tracer(prev_); }
+// 对每一条出边 SharedPtr 调用一次 tracer。WeakPtr 不构成所有权,无需报告。
+// 回收器可能通过 tracer 把指向垃圾环的边置空,所以 trace() 接受非 const 引用。
+
+class CycleTracer {
+ public:
+  template <typename U>
+  void operator()(SharedPtr<U>& edge) {
+    detail::SpCountedBase* child = detail::SpAccess::ControlBlock(edge);
+    if (child && child->IsCollectable() && Visit(child)) {
+      edge.Reset();
+    }
+  }
+
+ protected:
+  ~CycleTracer() = default;
+
+  // 返回 true 表示剪断这条边
+  virtual bool Visit(detail::SpCountedBase* child) = 0;
+};
+
+namespace detail {
+
+class CycleCollector;
+
+// ============================================================================
+// SpCountedCollectable: 可回收控制块的公共部分
+// ============================================================================
+// Bacon–Rajan 同步试删除需要的状态都放在这里,不使用被管理对象的强引用计数
+// 做试探性递减,而是单独的 trial_count_,避免与其他线程的计数操作混淆。
+
+class SpCountedCollectable : public SpCountedBase {
+ public:
+  enum Color : uint8_t {
+    kBlack,       // 存活(或未访问)
+    kGray,        // 试删除中
+    kWhite,       // 试删除后计数为 0:垃圾候选
+    kCollecting,  // 已确认是垃圾,正在拆环
+  };
+
+  SpCountedCollectable() : color_(kBlack), buffered_(false), trial_count_(0) {
+    MarkCollectable();
+  }
+
+  // 报告所有出边
+  virtual void Trace(CycleTracer& tracer) = 0;
+
+ protected:
+  void OnCollectableRelease() noexcept override;
+
+ private:
+  friend class CycleCollector;
+
+  Color color_;                 // 只在回收器内访问
+  std::atomic<bool> buffered_;  // 是否已在候选根缓冲区
+  int64_t trial_count_;         // 试删除用的计数副本
+};
+
+// ============================================================================
+// SpCountedImplCollectable: 可回收对象的 inplace 控制块
+// ============================================================================
+
+template <typename T>
+class SpCountedImplCollectable : public SpCountedCollectable {
+ private:
+  typename std::aligned_storage<sizeof(T), alignof(T)>::type storage_;
+
+  SpCountedImplCollectable(const SpCountedImplCollectable&) = delete;
+  SpCountedImplCollectable& operator=(const SpCountedImplCollectable&) = delete;
+
+ public:
+  template <typename... Args>
+  explicit SpCountedImplCollectable(Args&&... args) {
+    ::new (static_cast<void*>(&storage_)) T(std::forward<Args>(args)...);
+    TrackAllocation<T>();
+  }
+
+  T* GetPoint() noexcept { return reinterpret_cast<T*>(&storage_); }
+
+  void Dispose() noexcept override { GetPoint()->~T(); }
+
+  void Trace(CycleTracer& tracer) override { GetPoint()->trace(tracer); }
+};
+
+// ============================================================================
+// CycleCollector: 候选根缓冲区 + 同步试删除
+// ============================================================================
+// - 可回收对象每次 Release() 且仍有其他强引用时,登记为候选根
+//   (缓冲区持有一个弱引用,保证控制块在处理前不会被释放)
+// - Collect() 每次最多处理 max_roots 个候选根,以有界的增量运行
+//
+// 限制:Collect() 期间,被处理的对象图不能被其他线程修改
+// (包括增删边和拷贝/释放其中的 SharedPtr)。
+
+class CycleCollector {
+ public:
+  static CycleCollector& Instance() {
+    // 故意泄漏:静态析构期间仍可能有对象释放并登记候选根
+    static CycleCollector* instance = new CycleCollector();
+    return *instance;
+  }
+
+  void PossibleRoot(SpCountedCollectable* block) noexcept {
+    // 拆环时剪边释放的是正在回收的垃圾,不必登记(其他线程不会看到 true)
+    if (FreeingGarbage() && block->color_ == SpCountedCollectable::kCollecting) return;
+    if (block->buffered_.exchange(true, std::memory_order_acq_rel)) return;
+    block->WeakAddRef();
+    try {
+      std::lock_guard<std::mutex> lock(roots_mutex_);
+      roots_.push_back(block);
+    } catch (...) {
+      // 内存不足时放弃登记:只会推迟回收,不影响正确性
+      block->buffered_.store(false, std::memory_order_release);
+      block->WeakRelease();
+    }
+  }
+
+  size_t pending_roots() const {
+    std::lock_guard<std::mutex> lock(roots_mutex_);
+    return roots_.size();
+  }
+
+  // 处理至多 max_roots 个候选根,返回回收的对象数
+  size_t Collect(size_t max_roots) {
+    std::lock_guard<std::mutex> collect_lock(collect_mutex_);
+
+    std::vector<SpCountedCollectable*> roots;
+    {
+      std::lock_guard<std::mutex> lock(roots_mutex_);
+      size_t n = max_roots < roots_.size() ? max_roots : roots_.size();
+      roots.assign(roots_.begin(), roots_.begin() + n);
+      roots_.erase(roots_.begin(), roots_.begin() + n);
+    }
+    for (SpCountedCollectable* root : roots) {
+      root->buffered_.store(false, std::memory_order_release);
+    }
+
+    // 1. MarkRoots:从存活的候选根出发做试删除
+    for (SpCountedCollectable* root : roots) {
+      if (root->use_count() > 0) MarkGray(root);
+    }
+    // 2. Scan:试删除后仍有外部引用的子图恢复为黑色
+    for (SpCountedCollectable* root : roots) {
+      Scan(root);
+    }
+    // 3. CollectWhite:收集白色节点
+    std::vector<SpCountedCollectable*> garbage;
+    for (SpCountedCollectable* root : roots) {
+      CollectWhite(root, &garbage);
+    }
+
+    FreeGarbage(garbage);
+
+    for (SpCountedCollectable* root : roots) {
+      root->WeakRelease();  // 归还缓冲区持有的弱引用
+    }
+    return garbage.size();
+  }
+
+ private:
+  CycleCollector() = default;
+
+  // 当前线程是否正在 FreeGarbage() 里剪边
+  static bool& FreeingGarbage() noexcept {
+    static thread_local bool freeing = false;
+    return freeing;
+  }
+
+  class FreeingGarbageScope {
+   public:
+    FreeingGarbageScope() noexcept { FreeingGarbage() = true; }
+    ~FreeingGarbageScope() noexcept { FreeingGarbage() = false; }
+  };
+
+  template <typename F>
+  class FunctionTracer : public CycleTracer {
+   public:
+    explicit FunctionTracer(F visit) : visit_(visit) {}
+
+   protected:
+    bool Visit(SpCountedBase* child) override {
+      return visit_(static_cast<SpCountedCollectable*>(child));
+    }
+
+   private:
+    F visit_;
+  };
+
+  template <typename F>
+  static void TraceChildren(SpCountedCollectable* node, F visit) {
+    FunctionTracer<F> tracer(visit);
+    node->Trace(tracer);
+  }
+
+  // 以下遍历都用显式栈,避免长链表递归过深
+  void MarkGray(SpCountedCollectable* root) {
+    if (root->color_ == SpCountedCollectable::kGray) return;
+    root->color_ = SpCountedCollectable::kGray;
+    root->trial_count_ = root->use_count();
+
+    std::vector<SpCountedCollectable*> stack(1, root);
+    while (!stack.empty()) {
+      SpCountedCollectable* node = stack.back();
+      stack.pop_back();
+      TraceChildren(node, [&stack](SpCountedCollectable* child) {
+        if (child->color_ != SpCountedCollectable::kGray) {
+          child->color_ = SpCountedCollectable::kGray;
+          child->trial_count_ = child->use_count();
+          stack.push_back(child);
+        }
+        --child->trial_count_;  // 扣掉子图内部的这条边
+        return false;
+      });
+    }
+  }
+
+  void Scan(SpCountedCollectable* root) {
+    std::vector<SpCountedCollectable*> stack(1, root);
+    while (!stack.empty()) {
+      SpCountedCollectable* node = stack.back();
+      stack.pop_back();
+      if (node->color_ != SpCountedCollectable::kGray) continue;
+      if (node->trial_count_ > 0) {
+        ScanBlack(node);  // 有外部引用:它可达的一切都是活的
+      } else {
+        node->color_ = SpCountedCollectable::kWhite;
+        TraceChildren(node, [&stack](SpCountedCollectable* child) {
+          stack.push_back(child);
+          return false;
+        });
+      }
+    }
+  }
+
+  void ScanBlack(SpCountedCollectable* root) {
+    root->color_ = SpCountedCollectable::kBlack;
+    std::vector<SpCountedCollectable*> stack(1, root);
+    while (!stack.empty()) {
+      SpCountedCollectable* node = stack.back();
+      stack.pop_back();
+      TraceChildren(node, [&stack](SpCountedCollectable* child) {
+        ++child->trial_count_;  // 恢复 MarkGray 扣掉的边
+        if (child->color_ != SpCountedCollectable::kBlack) {
+          child->color_ = SpCountedCollectable::kBlack;
+          stack.push_back(child);
+        }
+        return false;
+      });
+    }
+  }
+
+  void CollectWhite(SpCountedCollectable* root,
+                    std::vector<SpCountedCollectable*>* garbage) {
+    if (root->color_ != SpCountedCollectable::kWhite) return;
+    root->color_ = SpCountedCollectable::kCollecting;
+    garbage->push_back(root);
+
+    std::vector<SpCountedCollectable*> stack(1, root);
+    while (!stack.empty()) {
+      SpCountedCollectable* node = stack.back();
+      stack.pop_back();
+      TraceChildren(node, [&stack, garbage](SpCountedCollectable* child) {
+        if (child->color_ == SpCountedCollectable::kWhite) {
+          child->color_ = SpCountedCollectable::kCollecting;
+          garbage->push_back(child);
+          stack.push_back(child);
+        }
+        return false;
+      });
+    }
+  }
+
+  // 拆环:先给每个垃圾对象加一个"钉住"的强引用,再剪断垃圾之间的边,
+  // 最后释放钉子,让对象按正常路径 Dispose()。
+  // 钉住保证剪边过程中不会有对象在 trace() 中途被析构。
+  // 剪边时被钉住的节点计数仍大于 1,Release() 会把它当作候选根;
+  // FreeingGarbageScope 期间 PossibleRoot() 跳过 kCollecting 的节点。
+  static void FreeGarbage(const std::vector<SpCountedCollectable*>& garbage) {
+    for (SpCountedCollectable* node : garbage) {
+      node->AddRefCopy();
+    }
+    {
+      FreeingGarbageScope freeing;
+      for (SpCountedCollectable* node : garbage) {
+        TraceChildren(node, [](SpCountedCollectable* child) {
+          return child->color_ == SpCountedCollectable::kCollecting;
+        });
+      }
+    }
+    for (SpCountedCollectable* node : garbage) {
+      node->color_ = SpCountedCollectable::kBlack;
+    }
+    for (SpCountedCollectable* node : garbage) {
+      node->Release();
+    }
+  }
+
+  mutable std::mutex roots_mutex_;
+  std::deque<SpCountedCollectable*> roots_;
+  std::mutex collect_mutex_;  // 同一时刻只允许一次 Collect()
+};
+
+inline void SpCountedCollectable::OnCollectableRelease() noexcept {
+  // 只有递减后仍有其他强引用时才可能遗留循环;计数为 1 时对象即将正常死亡
+  if (use_count() > 1) {
+    CycleCollector::Instance().PossibleRoot(this);
+  }
+}
+
+}  // namespace detail
+
+// ============================================================================
+// make_collectable / collect_cycles
+// ============================================================================
+
+// 创建参与循环回收的对象(与 make_shared 一样单次分配)
+// T 必须提供 void trace(my::CycleTracer&)
+template <typename T, typename... Args>
+SharedPtr<T> make_collectable(Args&&... args) {
+  detail::SpCountedImplCollectable<T>* block =
+      new detail::SpCountedImplCollectable<T>(std::forward<Args>(args)...);
+  return detail::SpAccess::Adopt(block->GetPoint(), block);
+}
+
+// 处理至多 max_roots 个候选根,返回回收的对象数
+// 长期运行的进程可以周期性地以小批量调用,把停顿控制在可接受范围内
+inline size_t collect_cycles(
+    size_t max_roots = std::numeric_limits<size_t>::max()) {
+  return detail::CycleCollector::Instance().Collect(max_roots);
+}
+
+// 当前缓冲的候选根数量
+inline size_t pending_cycle_roots() {
+  return detail::CycleCollector::Instance().pending_roots();
+}
+
+}  // namespace my
+
+#endif  // MY_CYCLE_COLLECTOR_H
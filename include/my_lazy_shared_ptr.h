@@ -0,0 +1,191 @@
+// my_lazy_shared_ptr.h
+#ifndef MY_LAZY_SHARED_PTR_H
+#define MY_LAZY_SHARED_PTR_H
+
+// ============================================================================
+// LazySharedPtr<T>: 第一次共享时才分配控制块
+// ============================================================================
+// SharedPtr<T>(new T) 在构造时就 new 一个 SpCountedImplPointer<T>,
+// 而大多数对象在死亡前从未被拷贝过。LazySharedPtr 在"独占"状态下只持有
+// 对象指针(控制块指针为空),析构时直接 delete 对象,一共只有一次分配;
+// 第一次拷贝、创建 WeakPtr 或转换为 SharedPtr 时才分配控制块,
+// 之后与 SharedPtr 完全相同。
+//
+// 和 SharedPtr 一样,多个线程可以同时拷贝同一个 LazySharedPtr:
+// 并发的首次共享用 CAS 决出唯一的控制块,失败方释放自己分配的那个
+// (只释放控制块,并记录 destroy 跟踪点)。
+// 控制块指针因此是原子变量,已共享之后每次拷贝多一次 acquire 读。
+//
+// 限制:只接受默认删除器;需要自定义删除器或 make_shared 时用 SharedPtr。
+
+#include <atomic>
+#include <cstddef>
+#include <stdint.h>
+#include <utility>
+
+#include "my_shared_ptr.h"
+#include "my_weak_ptr.h"
+
+namespace my {
+
+template <typename T>
+class LazySharedPtr {
+ public:
+  using element_type = T;
+
+  // ------------------------------------------------------------------------
+  // 构造函数
+  // ------------------------------------------------------------------------
+
+  LazySharedPtr() noexcept : ptr_(nullptr), control_block_(nullptr) {}
+
+  LazySharedPtr(std::nullptr_t) noexcept : ptr_(nullptr), control_block_(nullptr) {}
+
+  // 接管 ptr,不分配控制块
+  explicit LazySharedPtr(T* ptr) noexcept : ptr_(ptr), control_block_(nullptr) {}
+
+  // 拷贝:必要时先为 other 分配控制块
+  LazySharedPtr(const LazySharedPtr& other)
+      : ptr_(other.ptr_), control_block_(other.ShareBlock()) {}
+
+  LazySharedPtr(LazySharedPtr&& other) noexcept
+      : ptr_(other.ptr_),
+        control_block_(other.control_block_.load(std::memory_order_relaxed)) {
+    other.ptr_ = nullptr;
+    other.control_block_.store(nullptr, std::memory_order_relaxed);
+  }
+
+  ~LazySharedPtr() noexcept {
+    detail::SpCountedBase* control_block =
+        control_block_.load(std::memory_order_acquire);
+    if (control_block) {
+      control_block->Release();
+    } else {
+      detail::CheckedDelete(ptr_);  // 从未共享:没有控制块要释放
+    }
+  }
+
+  // ------------------------------------------------------------------------
+  // 赋值运算符
+  // ------------------------------------------------------------------------
+
+  LazySharedPtr& operator=(const LazySharedPtr& other) {
+    LazySharedPtr(other).Swap(*this);
+    return *this;
+  }
+
+  LazySharedPtr& operator=(LazySharedPtr&& other) noexcept {
+    LazySharedPtr(std::move(other)).Swap(*this);
+    return *this;
+  }
+
+  LazySharedPtr& operator=(std::nullptr_t) noexcept {
+    Reset();
+    return *this;
+  }
+
+  // ------------------------------------------------------------------------
+  // 修改器(与 SharedPtr 一样,不能与其他线程对同一对象的访问并发)
+  // ------------------------------------------------------------------------
+
+  void Reset() noexcept { LazySharedPtr().Swap(*this); }
+
+  void Reset(T* ptr) noexcept { LazySharedPtr(ptr).Swap(*this); }
+
+  void Swap(LazySharedPtr& other) noexcept {
+    std::swap(ptr_, other.ptr_);
+    detail::SpCountedBase* tmp = control_block_.load(std::memory_order_relaxed);
+    control_block_.store(other.control_block_.load(std::memory_order_relaxed),
+                         std::memory_order_relaxed);
+    other.control_block_.store(tmp, std::memory_order_relaxed);
+  }
+
+  // ------------------------------------------------------------------------
+  // 共享:转换为 SharedPtr / WeakPtr
+  // ------------------------------------------------------------------------
+
+  // 共享所有权;必要时分配控制块
+  operator SharedPtr<T>() const& {
+    detail::SpCountedBase* control_block = ShareBlock();
+    return control_block ? detail::SpAccess::Adopt(ptr_, control_block)
+                         : SharedPtr<T>();
+  }
+
+  // 右值:转移所有权,不改动计数(独占状态下在这里分配控制块)
+  operator SharedPtr<T>() && {
+    T* ptr = ptr_;
+    detail::SpCountedBase* control_block =
+        control_block_.load(std::memory_order_relaxed);
+    if (!ptr && !control_block) return SharedPtr<T>();
+    if (!control_block) control_block = new detail::SpCountedImplPointer<T>(ptr);
+    ptr_ = nullptr;
+    control_block_.store(nullptr, std::memory_order_relaxed);
+    return detail::SpAccess::Adopt(ptr, control_block);
+  }
+
+  // 创建弱引用;必要时分配控制块
+  WeakPtr<T> weak() const {
+    detail::SpCountedBase* control_block = EnsureBlock();
+    if (!control_block) return WeakPtr<T>();
+    control_block->WeakAddRef();
+    return detail::SpAccess::AdoptWeak(ptr_, control_block);
+  }
+
+  // ------------------------------------------------------------------------
+  // 观察器
+  // ------------------------------------------------------------------------
+
+  T* get() const noexcept { return ptr_; }
+
+  T& operator*() const noexcept { return *ptr_; }
+
+  T* operator->() const noexcept { return ptr_; }
+
+  explicit operator bool() const noexcept { return ptr_ != nullptr; }
+
+  int64_t use_count() const noexcept {
+    detail::SpCountedBase* control_block =
+        control_block_.load(std::memory_order_acquire);
+    if (control_block) return control_block->use_count();
+    return ptr_ ? 1 : 0;
+  }
+
+  bool unique() const noexcept { return use_count() == 1; }
+
+  // 是否已经分配了控制块(独占状态返回 false)
+  bool shared() const noexcept {
+    return control_block_.load(std::memory_order_acquire) != nullptr;
+  }
+
+ private:
+  // 返回控制块,独占状态下先分配;ptr_ 为空时返回 nullptr
+  detail::SpCountedBase* EnsureBlock() const {
+    detail::SpCountedBase* control_block =
+        control_block_.load(std::memory_order_acquire);
+    if (control_block || !ptr_) return control_block;
+
+    // 新控制块的 1 个强引用代表 *this 自己
+    detail::SpCountedBase* fresh = new detail::SpCountedImplPointer<T>(ptr_);
+    if (control_block_.compare_exchange_strong(control_block, fresh,
+                                               std::memory_order_acq_rel,
+                                               std::memory_order_acquire)) {
+      return fresh;
+    }
+    fresh->DestroyUnshared();  // 另一个线程先分配了;只释放控制块,不 Dispose 对象
+    return control_block;
+  }
+
+  // 为一个新的共享者加上强引用并返回控制块
+  detail::SpCountedBase* ShareBlock() const {
+    detail::SpCountedBase* control_block = EnsureBlock();
+    if (control_block) control_block->AddRefCopy();
+    return control_block;
+  }
+
+  T* ptr_;
+  mutable std::atomic<detail::SpCountedBase*> control_block_;  // 为空表示独占
+};
+
+}  // namespace my
+
+#endif  // MY_LAZY_SHARED_PTR_H
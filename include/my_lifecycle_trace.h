@@ -0,0 +1,370 @@
+// my_lifecycle_trace.h
+#ifndef MY_LIFECYCLE_TRACE_H
+#define MY_LIFECYCLE_TRACE_H
+
+// ============================================================================
+// 控制块生命周期跟踪
+// ============================================================================
+// 跟踪点:create / copy / release / dispose / destroy / weak_lock(及失败)。
+// 两个互相独立的后端,可以同时启用:
+//
+// 1. USDT 静态探针(-DMY_SP_ENABLE_USDT,需要 systemtap-sdt-dev 的 <sys/sdt.h>)
+//    每个跟踪点编译成一条 nop 和 ELF note,未挂载时只剩参数的计算;
+//    参数都取自计数操作本身的 RMW 结果,不额外读取计数。provider 为 my_sp,参数 arg0 = 控制块地址,
+//    arg1 = 事件值(见 TraceEvent),例如:
+//      bpftrace -e 'usdt:./app:my_sp:create { printf("%s\n", str(arg1)); }'
+//      perf probe -x ./app sdt_my_sp:release && perf record -e sdt_my_sp:release ...
+//
+// 2. 进程内环形缓冲(-DMY_SP_ENABLE_TRACE_RING)
+//    每个线程一个无锁环(只有本线程写),写满后覆盖最旧的记录。
+//    my::trace_dump(path) 把所有线程的记录按时间排序写成紧凑的二进制文件,
+//    由 tools/trace_analyze 离线重建每个对象的生命周期和所有者数量变化。
+//    线程退出后它的环留给下一个新线程继续使用,已有记录保留到下次转储。
+//
+// 文件格式(小端,与本机字节序相同):
+//   "MYSPTRC1"  uint32 版本  uint32 记录大小  uint64 记录数  记录 × N
+//   uint64 类型名数  { uint64 地址  uint32 长度  字节 } × M
+// create 记录的值是类型名(typeid 名字)的地址,由末尾的类型名表解析。
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <map>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace my {
+
+enum TraceEvent {
+  kTraceCreate = 1,      // 值:类型名地址
+  kTraceCopy,            // 值:拷贝后的强引用数
+  kTraceRelease,         // 值:释放后的强引用数
+  kTraceDispose,         // 值:0
+  kTraceDestroy,         // 值:0
+  kTraceWeakLock,        // 值:lock() 成功后的强引用数
+  kTraceWeakLockFailed,  // 值:0
+};
+
+inline const char* trace_event_name(uint16_t event) {
+  switch (event) {
+    case kTraceCreate: return "create";
+    case kTraceCopy: return "copy";
+    case kTraceRelease: return "release";
+    case kTraceDispose: return "dispose";
+    case kTraceDestroy: return "destroy";
+    case kTraceWeakLock: return "weak_lock";
+    case kTraceWeakLockFailed: return "weak_lock_failed";
+    default: return "?";
+  }
+}
+
+// 文件中的一条记录(32 字节)
+struct TraceRecord {
+  uint64_t timestamp_ns;  // steady_clock
+  uint64_t block;         // 控制块地址,即对象身份(释放后可能被复用)
+  int64_t value;
+  uint32_t thread;        // 进程内线程序号,从 1 开始
+  uint16_t event;
+  uint16_t reserved;
+};
+
+static_assert(sizeof(TraceRecord) == 32, "TraceRecord 是文件格式的一部分");
+
+struct TraceFile {
+  std::vector<TraceRecord> records;           // 按时间排序
+  std::map<uint64_t, std::string> type_names;  // create 记录的值 -> 类型名
+};
+
+namespace detail {
+
+const char kTraceMagic[8] = {'M', 'Y', 'S', 'P', 'T', 'R', 'C', '1'};
+const uint32_t kTraceVersion = 1;
+
+// 从当前位置到文件末尾的字节数;流不可定位时返回 0
+// 读取前用它检查文件里的长度字段,截断或损坏的文件不会引发巨大的分配
+inline uint64_t TraceBytesLeft(std::istream& in) {
+  std::streampos here = in.tellg();
+  if (here < 0 || !in.seekg(0, std::ios::end)) return 0;
+  std::streampos end = in.tellg();
+  in.seekg(here);
+  return end < here ? 0 : static_cast<uint64_t>(end - here);
+}
+
+}  // namespace detail
+
+// 读取 trace_dump() 写出的文件;格式不符、截断或长度字段越界时返回 false
+inline bool read_trace_file(const std::string& path, TraceFile* out) {
+  std::ifstream in(path.c_str(), std::ios::binary);
+  char magic[8];
+  uint32_t version = 0, record_size = 0;
+  uint64_t count = 0;
+  if (!in.read(magic, sizeof(magic)) ||
+      std::memcmp(magic, detail::kTraceMagic, sizeof(magic)) != 0) {
+    return false;
+  }
+  in.read(reinterpret_cast<char*>(&version), sizeof(version));
+  in.read(reinterpret_cast<char*>(&record_size), sizeof(record_size));
+  in.read(reinterpret_cast<char*>(&count), sizeof(count));
+  if (!in || version != detail::kTraceVersion ||
+      record_size != sizeof(TraceRecord) ||
+      count > detail::TraceBytesLeft(in) / sizeof(TraceRecord)) {
+    return false;
+  }
+  out->records.resize(count);
+  if (count != 0 &&
+      !in.read(reinterpret_cast<char*>(out->records.data()),
+               count * sizeof(TraceRecord))) {
+    return false;
+  }
+  uint64_t names = 0;
+  if (!in.read(reinterpret_cast<char*>(&names), sizeof(names))) return false;
+  out->type_names.clear();
+  for (uint64_t i = 0; i < names; ++i) {
+    uint64_t address = 0;
+    uint32_t length = 0;
+    in.read(reinterpret_cast<char*>(&address), sizeof(address));
+    in.read(reinterpret_cast<char*>(&length), sizeof(length));
+    if (!in || length > detail::TraceBytesLeft(in)) return false;
+    std::string name(length, '\0');
+    if (length != 0 && !in.read(&name[0], length)) return false;
+    out->type_names[address] = name;
+  }
+  return true;
+}
+
+}  // namespace my
+
+#ifdef MY_SP_ENABLE_TRACE_RING
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+// 每个线程的环能保存的记录数(2 的幂)
+#ifndef MY_SP_TRACE_RING_CAPACITY
+#define MY_SP_TRACE_RING_CAPACITY 65536
+#endif
+
+namespace my {
+namespace detail {
+
+static_assert((MY_SP_TRACE_RING_CAPACITY & (MY_SP_TRACE_RING_CAPACITY - 1)) == 0,
+              "MY_SP_TRACE_RING_CAPACITY 必须是 2 的幂");
+
+// 单写者环:只有拥有它的线程追加,转储线程并发读取。
+// 槽位用宽松原子字存储,读者复制后再检查写指针,丢弃复制期间被覆盖的记录。
+class TraceRing {
+ public:
+  static constexpr uint64_t kCapacity = MY_SP_TRACE_RING_CAPACITY;
+
+  TraceRing() : slots_(new Slot[kCapacity]), head_(0), tail_(0), in_use_(true) {}
+
+  void Append(const TraceRecord& record) noexcept {
+    uint64_t pos = head_.load(std::memory_order_relaxed);
+    Slot& slot = slots_[pos & (kCapacity - 1)];
+    slot.words[0].store(record.timestamp_ns, std::memory_order_relaxed);
+    slot.words[1].store(record.block, std::memory_order_relaxed);
+    slot.words[2].store(static_cast<uint64_t>(record.value), std::memory_order_relaxed);
+    slot.words[3].store(uint64_t(record.thread) << 32 | record.event,
+                        std::memory_order_relaxed);
+    head_.store(pos + 1, std::memory_order_release);
+  }
+
+  void CopyTo(std::vector<TraceRecord>* out) const {
+    uint64_t end = head_.load(std::memory_order_acquire);
+    uint64_t begin = FirstValid(end);
+    size_t first = out->size();
+    for (uint64_t pos = begin; pos < end; ++pos) {
+      const Slot& slot = slots_[pos & (kCapacity - 1)];
+      TraceRecord record;
+      record.timestamp_ns = slot.words[0].load(std::memory_order_relaxed);
+      record.block = slot.words[1].load(std::memory_order_relaxed);
+      record.value = static_cast<int64_t>(slot.words[2].load(std::memory_order_relaxed));
+      uint64_t packed = slot.words[3].load(std::memory_order_relaxed);
+      record.thread = static_cast<uint32_t>(packed >> 32);
+      record.event = static_cast<uint16_t>(packed);
+      record.reserved = 0;
+      out->push_back(record);
+    }
+    // 复制期间写者又绕了一圈:开头那些槽可能已是新记录,丢弃
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t still_valid = FirstValid(head_.load(std::memory_order_relaxed));
+    if (still_valid > begin) {
+      size_t overwritten = static_cast<size_t>(std::min(still_valid - begin, end - begin));
+      out->erase(out->begin() + first, out->begin() + first + overwritten);
+    }
+  }
+
+  // 丢弃已有记录(不与写者冲突:只移动读起点)
+  void Clear() noexcept {
+    tail_.store(head_.load(std::memory_order_acquire), std::memory_order_relaxed);
+  }
+
+  std::atomic<bool>& in_use() noexcept { return in_use_; }
+
+ private:
+  struct Slot {
+    std::atomic<uint64_t> words[4];
+  };
+
+  uint64_t FirstValid(uint64_t head) const noexcept {
+    uint64_t oldest = head > kCapacity ? head - kCapacity : 0;
+    return std::max(oldest, tail_.load(std::memory_order_relaxed));
+  }
+
+  std::unique_ptr<Slot[]> slots_;
+  std::atomic<uint64_t> head_;
+  std::atomic<uint64_t> tail_;
+  std::atomic<bool> in_use_;
+};
+
+class TraceRegistry {
+ public:
+  static TraceRegistry& Instance() {
+    // 故意泄漏:静态析构和线程退出期间仍可能记录
+    static TraceRegistry* instance = new TraceRegistry();
+    return *instance;
+  }
+
+  // 优先复用已退出线程留下的环
+  TraceRing* AcquireRing() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (TraceRing* ring : rings_) {
+      bool expected = false;
+      if (ring->in_use().compare_exchange_strong(expected, true)) return ring;
+    }
+    rings_.push_back(new TraceRing());
+    return rings_.back();
+  }
+
+  std::vector<TraceRecord> Snapshot() const {
+    std::vector<TraceRecord> records;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (const TraceRing* ring : rings_) ring->CopyTo(&records);
+    }
+    std::stable_sort(records.begin(), records.end(),
+                     [](const TraceRecord& a, const TraceRecord& b) {
+                       return a.timestamp_ns < b.timestamp_ns;
+                     });
+    return records;
+  }
+
+  void Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (TraceRing* ring : rings_) ring->Clear();
+  }
+
+ private:
+  TraceRegistry() = default;
+
+  mutable std::mutex mutex_;
+  std::vector<TraceRing*> rings_;
+};
+
+// 线程与它的环的绑定;线程退出时把环交还注册表
+struct TraceThreadSlot {
+  TraceThreadSlot() : ring(nullptr), thread(NextThreadId()), exited(false) {}
+
+  ~TraceThreadSlot() {
+    exited = true;
+    if (ring) ring->in_use().store(false, std::memory_order_release);
+  }
+
+  static uint32_t NextThreadId() {
+    static std::atomic<uint32_t> next(1);
+    return next.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  TraceRing* ring;
+  uint32_t thread;
+  bool exited;
+};
+
+inline void TraceAppend(TraceEvent event, const void* block, int64_t value) noexcept {
+  static thread_local TraceThreadSlot slot;
+  if (slot.exited) return;  // 本线程的 thread_local 已析构,丢弃
+  if (!slot.ring) {
+    try {
+      slot.ring = TraceRegistry::Instance().AcquireRing();
+    } catch (...) {
+      return;  // 内存不足时不记录
+    }
+  }
+  TraceRecord record;
+  record.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now().time_since_epoch())
+                            .count();
+  record.block = reinterpret_cast<uintptr_t>(block);
+  record.value = value;
+  record.thread = slot.thread;
+  record.event = static_cast<uint16_t>(event);
+  record.reserved = 0;
+  slot.ring->Append(record);
+}
+
+}  // namespace detail
+
+// 所有线程当前保存的记录,按时间排序
+inline std::vector<TraceRecord> trace_snapshot() {
+  return detail::TraceRegistry::Instance().Snapshot();
+}
+
+// 丢弃所有已保存的记录
+inline void trace_reset() { detail::TraceRegistry::Instance().Reset(); }
+
+// 把当前记录写入文件,返回写入的记录数;打不开文件时返回 -1
+inline int64_t trace_dump(const std::string& path) {
+  std::vector<TraceRecord> records = trace_snapshot();
+  std::map<uint64_t, std::string> type_names;
+  for (const TraceRecord& record : records) {
+    if (record.event == kTraceCreate && record.value != 0) {
+      type_names[static_cast<uint64_t>(record.value)] =
+          reinterpret_cast<const char*>(static_cast<uintptr_t>(record.value));
+    }
+  }
+
+  std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+  if (!out) return -1;
+  uint64_t count = records.size();
+  out.write(detail::kTraceMagic, sizeof(detail::kTraceMagic));
+  out.write(reinterpret_cast<const char*>(&detail::kTraceVersion), sizeof(uint32_t));
+  uint32_t record_size = sizeof(TraceRecord);
+  out.write(reinterpret_cast<const char*>(&record_size), sizeof(record_size));
+  out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+  if (count != 0) {
+    out.write(reinterpret_cast<const char*>(records.data()), count * sizeof(TraceRecord));
+  }
+  uint64_t names = type_names.size();
+  out.write(reinterpret_cast<const char*>(&names), sizeof(names));
+  for (const auto& entry : type_names) {
+    uint32_t length = static_cast<uint32_t>(entry.second.size());
+    out.write(reinterpret_cast<const char*>(&entry.first), sizeof(entry.first));
+    out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    out.write(entry.second.data(), length);
+  }
+  return out ? static_cast<int64_t>(count) : -1;
+}
+
+}  // namespace my
+
+#else  // !MY_SP_ENABLE_TRACE_RING
+
+namespace my {
+
+inline std::vector<TraceRecord> trace_snapshot() {
+  return std::vector<TraceRecord>();
+}
+
+inline void trace_reset() {}
+
+inline int64_t trace_dump(const std::string&) { return -1; }
+
+}  // namespace my
+
+#endif  // MY_SP_ENABLE_TRACE_RING
+
+#endif  // MY_LIFECYCLE_TRACE_H
@@ -0,0 +1,284 @@
+// my_live_registry.h
+#ifndef MY_LIVE_REGISTRY_H
+#define MY_LIVE_REGISTRY_H
+
+// ============================================================================
+// 存活控制块注册表与泄漏报告(调试/剖析模式)
+// ============================================================================
+// 以 -DMY_SP_ENABLE_LIVE_REGISTRY 编译时,每个(被采样的)控制块在构造时登记:
+// 类型名、被管理对象大小、创建时的调用栈;析构时注销。
+// - my::dump_live_objects(os) 按分配点汇总当前存活的对象
+// - 进程退出时自动打印仍然存活的对象(例如 test_cycle.cc 中的循环引用)
+// - my::set_live_registry_sample_rate(n) 只登记每 n 个控制块中的 1 个
+//
+// 未定义该宏时,控制块里没有任何额外字段和调用,本文件只提供空实现的接口。
+//
+// 调用栈依赖 glibc 的 backtrace();链接时加 -rdynamic 才能看到函数名。
+
+#include <cstddef>
+#include <iostream>
+#include <ostream>
+#include <stdint.h>
+
+#ifdef MY_SP_ENABLE_LIVE_REGISTRY
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__GLIBC__) || (defined(__has_include) && __has_include(<execinfo.h>))
+#include <execinfo.h>
+#define MY_SP_LIVE_REGISTRY_HAS_BACKTRACE 1
+#endif
+
+#include "sp_counted_base.h"
+
+// 默认采样率:每 N 个控制块登记 1 个
+#ifndef MY_SP_LIVE_REGISTRY_SAMPLE_RATE
+#define MY_SP_LIVE_REGISTRY_SAMPLE_RATE 1
+#endif
+
+// 进程退出时是否打印泄漏报告
+#ifndef MY_SP_LIVE_REGISTRY_REPORT_AT_EXIT
+#define MY_SP_LIVE_REGISTRY_REPORT_AT_EXIT 1
+#endif
+
+namespace my {
+namespace detail {
+
+// 单个存活控制块的登记信息
+struct LiveRecord {
+  static constexpr int kMaxFrames = 12;
+
+  const char* type_name;
+  size_t payload_size;
+  void* frames[kMaxFrames];
+  int depth;
+};
+
+class LiveRegistry {
+ public:
+  static LiveRegistry& Instance() {
+    // 故意泄漏:静态析构期间仍会有控制块注销
+    static LiveRegistry* instance = new LiveRegistry();
+    return *instance;
+  }
+
+  void set_sample_rate(uint32_t rate) noexcept {
+    sample_rate_.store(rate ? rate : 1, std::memory_order_relaxed);
+  }
+
+  bool Track(const SpCountedBase* block, const char* type_name,
+             size_t payload_size) noexcept {
+    if (!ShouldSample()) return false;
+
+    LiveRecord record;
+    record.type_name = type_name;
+    record.payload_size = payload_size;
+#ifdef MY_SP_LIVE_REGISTRY_HAS_BACKTRACE
+    record.depth = backtrace(record.frames, LiveRecord::kMaxFrames);
+#else
+    record.depth = 0;
+#endif
+
+    Shard& shard = ShardFor(block);
+    try {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      shard.records[block] = record;
+    } catch (...) {
+      return false;  // 登记失败不影响控制块本身
+    }
+    return true;
+  }
+
+  void Untrack(const SpCountedBase* block) noexcept {
+    Shard& shard = ShardFor(block);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.records.erase(block);
+  }
+
+  size_t live_count() const {
+    size_t total = 0;
+    for (size_t i = 0; i < kShardCount; ++i) {
+      std::lock_guard<std::mutex> lock(shards_[i].mutex);
+      total += shards_[i].records.size();
+    }
+    return total;
+  }
+
+  // 按(类型, 调用栈)汇总,字节数多的分配点排在前面
+  // 返回汇总的对象数
+  size_t Dump(std::ostream& os, const char* title) const {
+    std::map<SiteKey, SiteStats> sites;
+    size_t total_objects = 0;
+    for (size_t i = 0; i < kShardCount; ++i) {
+      std::lock_guard<std::mutex> lock(shards_[i].mutex);
+      for (const auto& item : shards_[i].records) {
+        // 持有分片锁时控制块不可能完成注销,读取计数是安全的
+        const LiveRecord& record = item.second;
+        SiteStats& stats = sites[SiteKey(record)];
+        stats.record = record;
+        stats.objects += 1;
+        stats.strong_refs += item.first->use_count();
+        stats.weak_refs += item.first->weak_count();
+        ++total_objects;
+      }
+    }
+
+    std::vector<const SiteStats*> ordered;
+    for (const auto& site : sites) {
+      ordered.push_back(&site.second);
+    }
+    std::sort(ordered.begin(), ordered.end(),
+              [](const SiteStats* a, const SiteStats* b) {
+                return a->objects * a->record.payload_size >
+                       b->objects * b->record.payload_size;
+              });
+
+    os << "==== " << title << ": " << total_objects << " 个存活控制块, "
+       << ordered.size() << " 个分配点";
+    uint32_t rate = sample_rate_.load(std::memory_order_relaxed);
+    if (rate > 1) os << " (采样 1/" << rate << ")";
+    os << " ====\n";
+
+    for (const SiteStats* stats : ordered) {
+      const LiveRecord& record = stats->record;
+      os << "  " << stats->objects << " 个 " << record.type_name
+         << " (对象 " << record.payload_size << " 字节, 合计 "
+         << stats->objects * record.payload_size << " 字节)"
+         << " strong=" << stats->strong_refs
+         << " weak=" << stats->weak_refs << "\n";
+#ifdef MY_SP_LIVE_REGISTRY_HAS_BACKTRACE
+      char** symbols = backtrace_symbols(record.frames, record.depth);
+      for (int f = 0; f < record.depth; ++f) {
+        os << "      #" << f << " "
+           << (symbols ? symbols[f] : "?") << "\n";
+      }
+      std::free(symbols);
+#endif
+    }
+    return total_objects;
+  }
+
+  void EnableExitReport() noexcept {
+#if MY_SP_LIVE_REGISTRY_REPORT_AT_EXIT
+    static std::once_flag once;
+    std::call_once(once, []() { std::atexit(&LiveRegistry::ReportAtExit); });
+#endif
+  }
+
+ private:
+  static constexpr size_t kShardCount = 64;
+
+  struct Shard {
+    mutable std::mutex mutex;
+    std::unordered_map<const SpCountedBase*, LiveRecord> records;
+  };
+
+  // 分配点:类型 + 调用栈
+  struct SiteKey {
+    explicit SiteKey(const LiveRecord& record)
+        : type_name(record.type_name),
+          frames(record.frames, record.frames + record.depth) {}
+
+    bool operator<(const SiteKey& other) const {
+      if (type_name != other.type_name) {
+        return std::strcmp(type_name, other.type_name) < 0;
+      }
+      return frames < other.frames;
+    }
+
+    const char* type_name;
+    std::vector<void*> frames;
+  };
+
+  struct SiteStats {
+    LiveRecord record;
+    size_t objects = 0;
+    int64_t strong_refs = 0;
+    int64_t weak_refs = 0;
+  };
+
+  LiveRegistry() : sample_rate_(MY_SP_LIVE_REGISTRY_SAMPLE_RATE) {}
+
+  bool ShouldSample() noexcept {
+    uint32_t rate = sample_rate_.load(std::memory_order_relaxed);
+    if (rate <= 1) return true;
+    static thread_local uint32_t countdown = 0;
+    if (countdown == 0) {
+      countdown = rate - 1;
+      return true;
+    }
+    --countdown;
+    return false;
+  }
+
+  Shard& ShardFor(const SpCountedBase* block) const noexcept {
+    return shards_[OwnerHashOf(block) % kShardCount];
+  }
+
+  static void ReportAtExit() {
+    LiveRegistry& registry = Instance();
+    if (registry.live_count() != 0) {
+      registry.Dump(std::cerr, "退出时仍存活(可能泄漏)");
+    }
+  }
+
+  std::atomic<uint32_t> sample_rate_;
+  mutable Shard shards_[kShardCount];
+};
+
+inline bool LiveRegistryTrack(const SpCountedBase* block, const char* type_name,
+                              size_t payload_size) noexcept {
+  LiveRegistry& registry = LiveRegistry::Instance();
+  registry.EnableExitReport();
+  return registry.Track(block, type_name, payload_size);
+}
+
+inline void LiveRegistryUntrack(const SpCountedBase* block) noexcept {
+  LiveRegistry::Instance().Untrack(block);
+}
+
+}  // namespace detail
+
+// 打印当前存活的控制块(按分配点汇总),返回汇总的对象数
+inline size_t dump_live_objects(std::ostream& os = std::cerr) {
+  return detail::LiveRegistry::Instance().Dump(os, "存活对象");
+}
+
+// 当前登记的存活控制块数
+inline size_t live_object_count() {
+  return detail::LiveRegistry::Instance().live_count();
+}
+
+// 每 rate 个控制块登记 1 个(1 = 全部登记)
+inline void set_live_registry_sample_rate(uint32_t rate) {
+  detail::LiveRegistry::Instance().set_sample_rate(rate);
+}
+
+}  // namespace my
+
+#else  // !MY_SP_ENABLE_LIVE_REGISTRY
+
+namespace my {
+
+inline size_t dump_live_objects(std::ostream& os = std::cerr) {
+  os << "存活对象注册表未启用(编译时定义 MY_SP_ENABLE_LIVE_REGISTRY)\n";
+  return 0;
+}
+
+inline size_t live_object_count() { return 0; }
+
+inline void set_live_registry_sample_rate(uint32_t) {}
+
+}  // namespace my
+
+#endif  // MY_SP_ENABLE_LIVE_REGISTRY
+
+#endif  // MY_LIVE_REGISTRY_H
@@ -21,7 +21,7 @@ SharedPtr<T> make_shared(Args&&... args) {
     std::forward<Args>(args)...
   );
 
-  return SharedPtr<T>(detail::sp_inplace_tag<T>{}, control_block);
+  return SharedPtr<T>(detail::sp_inplace_tag<T>{}, std::move(control_block));
 }
 
 }; // namespace my
@@ -0,0 +1,88 @@
+// my_on_expire.h
+#ifndef MY_ON_EXPIRE_H
+#define MY_ON_EXPIRE_H
+
+#include <utility>  // for move
+
+#include "my_shared_ptr.h"
+
+namespace my {
+
+// ============================================================================
+// ExpiryListenerHandle: 已注册监听器的句柄
+// ============================================================================
+// 句柄持有控制块的弱引用,因此 Cancel() 在对象死亡前后都可以安全调用。
+// 句柄析构不会取消监听器——只想"对象死时通知我"的调用方可以直接丢弃它。
+// 取消后的节点会在同一对象下次注册监听器时释放,所以句柄只能移动、不能拷贝:
+// 否则另一个副本还会去认领已释放的节点。
+
+class ExpiryListenerHandle {
+ public:
+  ExpiryListenerHandle() noexcept : owner_(), listener_(nullptr) {}
+
+  ExpiryListenerHandle(detail::WeakCount owner,
+                       detail::ExpiryListener* listener) noexcept
+      : owner_(std::move(owner)), listener_(listener) {}
+
+  // 取消监听器;返回 true 表示回调保证不会被执行,
+  // false 表示回调已经执行(或正在执行)、或句柄为空
+  bool Cancel() noexcept {
+    detail::SpCountedBase* control_block = owner_.GetControlBlock();
+    bool cancelled = listener_ != nullptr && listener_->Claim();
+    if (cancelled && control_block) control_block->NoteExpiryListenerCancelled();
+    listener_ = nullptr;
+    owner_ = detail::WeakCount();
+    return cancelled;
+  }
+
+  ExpiryListenerHandle(ExpiryListenerHandle&& other) noexcept
+      : owner_(std::move(other.owner_)), listener_(other.listener_) {
+    other.listener_ = nullptr;
+  }
+
+  ExpiryListenerHandle& operator=(ExpiryListenerHandle&& other) noexcept {
+    if (this != &other) {
+      owner_ = std::move(other.owner_);
+      listener_ = other.listener_;
+      other.listener_ = nullptr;
+    }
+    return *this;
+  }
+
+  explicit operator bool() const noexcept { return listener_ != nullptr; }
+
+ private:
+  detail::WeakCount owner_;  // 保证 listener_ 所在的控制块不被释放
+  detail::ExpiryListener* listener_;
+
+  ExpiryListenerHandle(const ExpiryListenerHandle&) = delete;
+  ExpiryListenerHandle& operator=(const ExpiryListenerHandle&) = delete;
+};
+
+// ============================================================================
+// on_expire: 在对象死亡时执行回调
+// ============================================================================
+// 回调在最后一个强引用释放的线程上执行,时机是 Dispose() 之后、
+// 控制块释放之前;此时对象已经析构,所有 WeakPtr 都已 expired()。
+// 回调不得抛出异常,也不应再访问被管理的对象。
+// 空指针不注册,返回空句柄。
+
+template <typename T, typename F>
+ExpiryListenerHandle on_expire(const SharedPtr<T>& sp, F callback) {
+  detail::SpCountedBase* control_block = detail::SpAccess::ControlBlock(sp);
+  if (!control_block) return ExpiryListenerHandle();
+
+  detail::ExpiryListener* listener =
+      new detail::ExpiryListenerImpl<F>(std::move(callback));
+  // sp 持有强引用,监听器不可能已经触发;保险起见仍检查返回值
+  if (!control_block->AddExpiryListener(listener)) {
+    delete listener;
+    return ExpiryListenerHandle();
+  }
+  return ExpiryListenerHandle(detail::WeakCount(detail::SpAccess::Count(sp)),
+                              listener);
+}
+
+}  // namespace my
+
+#endif  // MY_ON_EXPIRE_H
@@ -0,0 +1,82 @@
+// my_owner_hash.h
+#ifndef MY_OWNER_HASH_H
+#define MY_OWNER_HASH_H
+
+#include <cstddef>
+#include <functional>
+
+#include "my_shared_ptr.h"
+#include "my_weak_ptr.h"
+
+namespace my {
+
+namespace detail {
+
+// 统一取出"所有者标识"(控制块地址)
+// 原始指针形式即 owner_key() 的返回值,用于不构造智能指针的查找
+template <typename T>
+inline const void* OwnerKeyOf(const SharedPtr<T>& p) noexcept {
+  return p.owner_key();
+}
+
+template <typename T>
+inline const void* OwnerKeyOf(const WeakPtr<T>& p) noexcept {
+  return p.owner_key();
+}
+
+inline const void* OwnerKeyOf(const void* owner_key) noexcept {
+  return owner_key;
+}
+
+// 禁止把对象指针 get() 误当作所有者标识:两者语义不同,查找会静默失败
+template <typename T>
+const void* OwnerKeyOf(T* object_pointer) = delete;
+
+}  // namespace detail
+
+// ============================================================================
+// OwnerHash / OwnerEqual / OwnerLess: 基于控制块的容器函数对象
+// ============================================================================
+// 用法:
+//   std::unordered_set<my::WeakPtr<T>, my::OwnerHash, my::OwnerEqual> registry;
+//   std::set<my::WeakPtr<T>, my::OwnerLess> ordered;
+//
+// 函数对象本身接受 SharedPtr / WeakPtr / owner_key() 的任意组合。
+// 它们声明了 is_transparent,但异构查找要看标准版本:
+// - std::set / std::map 需要 C++14,std::unordered_set / unordered_map 需要 C++20
+// - 本仓库默认以 C++11 编译,此时 find() 只接受键类型,透明声明不起作用;
+//   查找 WeakPtr 键要先构造 WeakPtr(一次弱引用计数增减)
+// 满足上述版本时,用 SharedPtr 或 owner_key() 查找 WeakPtr 键不会构造
+// 临时智能指针,也就不会碰任何引用计数(见 test_owner_hash_cxx14 目标)。
+
+struct OwnerHash {
+  typedef void is_transparent;
+
+  template <typename P>
+  size_t operator()(const P& p) const noexcept {
+    return detail::OwnerHashOf(detail::OwnerKeyOf(p));
+  }
+};
+
+struct OwnerEqual {
+  typedef void is_transparent;
+
+  template <typename A, typename B>
+  bool operator()(const A& a, const B& b) const noexcept {
+    return detail::OwnerKeyOf(a) == detail::OwnerKeyOf(b);
+  }
+};
+
+struct OwnerLess {
+  typedef void is_transparent;
+
+  template <typename A, typename B>
+  bool operator()(const A& a, const B& b) const noexcept {
+    return std::less<const void*>()(detail::OwnerKeyOf(a),
+                                    detail::OwnerKeyOf(b));
+  }
+};
+
+}  // namespace my
+
+#endif  // MY_OWNER_HASH_H
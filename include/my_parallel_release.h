@@ -0,0 +1,193 @@
+// my_parallel_release.h
+#ifndef MY_PARALLEL_RELEASE_H
+#define MY_PARALLEL_RELEASE_H
+
+// ============================================================================
+// release_all(container): 并行释放大容器里的 SharedPtr
+// ============================================================================
+// 逐个析构几千万个 SharedPtr 时,时间几乎都花在两件事上:
+// - 每个元素的控制块都是一次缓存缺失,而且一个接一个串行发生
+// - 最后一个引用归还时的析构函数在单线程上依次执行
+// release_all 把容器切成连续的几段,每段交给一个线程(调用线程自己处理
+// 第一段);每段内部:
+// - 提前 prefetch_distance 个元素预取控制块,让缓存缺失重叠
+// - 相邻且共享同一控制块的元素合并为一次 ReleaseN(见 my_bulk_ref.h)
+// 谁做了最后一次递减谁就析构对象,所以析构函数随之分散到各个线程;
+// 计数本身是原子的,每个对象仍然恰好析构一次。
+//
+// 要求:
+// - 容器支持随机访问(std::vector、std::deque、数组包装等),元素是 SharedPtr
+// - 与 clear() 一样,调用期间不能有其他线程访问这个容器
+// - 对象的析构函数可能在任意一个工作线程上执行
+//
+// 线程从哪里来:
+// - options.pool 指向一个 ReleasePool 时,各段交给池里常驻的工作线程,
+//   反复调用不再创建线程;需要频繁释放大容器时应当用这种方式
+// - 否则每次调用临时创建线程并在返回前 join。只有元素足够多(每线程至少
+//   min_per_thread 个)时才并行,以摊薄创建线程的开销;
+//   创建线程失败时由调用线程处理那一段
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "my_bulk_ref.h"
+
+namespace my {
+
+// ============================================================================
+// ReleasePool: release_all 复用的常驻工作线程
+// ============================================================================
+// 一次 Run() 把 tasks 个任务分给工作线程,调用线程也参与,全部完成后返回。
+// 多个线程同时 Run() 时依次执行。析构时等工作线程退出,
+// 所以池必须比所有使用它的 release_all 调用活得更久。
+class ReleasePool {
+ public:
+  // workers 是常驻工作线程数(不含调用线程);创建线程失败时池里的线程会少一些
+  explicit ReleasePool(unsigned workers)
+      : task_(nullptr), tasks_(0), next_(0), finished_(0), generation_(0), stop_(false) {
+    threads_.reserve(workers);
+    for (unsigned i = 0; i < workers; ++i) {
+      try {
+        threads_.emplace_back([this]() { WorkerLoop(); });
+      } catch (const std::system_error&) {
+        break;
+      }
+    }
+  }
+
+  ReleasePool(const ReleasePool&) = delete;
+  ReleasePool& operator=(const ReleasePool&) = delete;
+
+  ~ReleasePool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& thread : threads_) thread.join();
+  }
+
+  unsigned workers() const noexcept { return static_cast<unsigned>(threads_.size()); }
+
+  // 执行 task(0) ... task(tasks - 1);task 不能抛出异常
+  void Run(size_t tasks, const std::function<void(size_t)>& task) {
+    std::lock_guard<std::mutex> run(run_mutex_);
+    std::unique_lock<std::mutex> lock(mutex_);
+    task_ = &task;
+    tasks_ = tasks;
+    next_ = 0;
+    finished_ = 0;
+    ++generation_;
+    wake_.notify_all();
+    RunTasks(lock);
+    done_.wait(lock, [this]() { return finished_ == tasks_; });
+    task_ = nullptr;
+  }
+
+ private:
+  void WorkerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    uint64_t seen = 0;
+    for (;;) {
+      wake_.wait(lock, [this, seen]() { return stop_ || generation_ != seen; });
+      if (stop_) return;
+      seen = generation_;
+      RunTasks(lock);
+    }
+  }
+
+  // 持锁进入;领取任务时持锁,执行任务时不持锁
+  void RunTasks(std::unique_lock<std::mutex>& lock) {
+    while (next_ < tasks_) {
+      size_t index = next_++;
+      const std::function<void(size_t)>& task = *task_;
+      lock.unlock();
+      task(index);
+      lock.lock();
+      if (++finished_ == tasks_) done_.notify_all();
+    }
+  }
+
+  std::mutex run_mutex_;  // 串行化 Run()
+  std::mutex mutex_;      // 保护以下状态
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  const std::function<void(size_t)>* task_;
+  size_t tasks_;
+  size_t next_;
+  size_t finished_;
+  uint64_t generation_;  // 每次 Run() 加一,工作线程据此发现新任务
+  bool stop_;
+  std::vector<std::thread> threads_;
+};
+
+struct ReleaseAllOptions {
+  unsigned threads;          // 最多使用的线程数(含调用线程);0 表示池的工作线程数 + 1,
+                             // 没有池时为 hardware_concurrency()
+  size_t min_per_thread;     // 每个线程至少分到的元素数,不足时少开线程
+  size_t prefetch_distance;  // 提前预取控制块的元素数;0 表示不预取
+  ReleasePool* pool;         // 复用的工作线程;nullptr 表示每次调用临时创建线程
+
+  ReleaseAllOptions()
+      : threads(0), min_per_thread(size_t(1) << 16), prefetch_distance(16), pool(nullptr) {}
+};
+
+// 释放容器里的全部 SharedPtr 并清空容器
+template <typename Container>
+void release_all(Container& handles, const ReleaseAllOptions& options = ReleaseAllOptions()) {
+  typedef decltype(std::begin(handles)) Iterator;
+  const Iterator first = std::begin(handles);
+  const size_t size = static_cast<size_t>(std::end(handles) - first);
+
+  size_t threads = options.threads;
+  if (threads == 0) {
+    threads = options.pool ? options.pool->workers() + 1 : std::thread::hardware_concurrency();
+  }
+  threads = std::min(threads, size / std::max<size_t>(options.min_per_thread, 1));
+  if (threads <= 1) {
+    detail::ReleaseCoalesced(first, first + size, options.prefetch_distance);
+    handles.clear();
+    return;
+  }
+
+  const size_t chunk = size / threads;
+  if (options.pool) {
+    const size_t prefetch_distance = options.prefetch_distance;
+    options.pool->Run(threads, [first, size, chunk, threads, prefetch_distance](size_t t) {
+      Iterator begin = first + t * chunk;
+      Iterator end = t + 1 == threads ? first + size : begin + chunk;
+      detail::ReleaseCoalesced(begin, end, prefetch_distance);
+    });
+    handles.clear();
+    return;
+  }
+
+  std::vector<std::thread> workers;
+  workers.reserve(threads - 1);
+  for (size_t t = 1; t < threads; ++t) {
+    Iterator begin = first + t * chunk;
+    Iterator end = t + 1 == threads ? first + size : begin + chunk;
+    try {
+      workers.emplace_back([begin, end, &options]() {
+        detail::ReleaseCoalesced(begin, end, options.prefetch_distance);
+      });
+    } catch (const std::system_error&) {
+      detail::ReleaseCoalesced(begin, end, options.prefetch_distance);
+    }
+  }
+  detail::ReleaseCoalesced(first, first + chunk, options.prefetch_distance);
+  for (std::thread& worker : workers) worker.join();
+  handles.clear();  // 元素都已置空,这里只剩空 SharedPtr 的析构
+}
+
+}  // namespace my
+
+#endif  // MY_PARALLEL_RELEASE_H
@@ -2,6 +2,8 @@
 #ifndef MY_POINTER_CAST_HPP
 #define MY_POINTER_CAST_HPP
 
+#include <utility>
+
 #include "my_shared_ptr.h"
 
 namespace my {
@@ -20,6 +22,13 @@ SharedPtr<T> static_pointer_cast(const SharedPtr<U>& other) noexcept {
     return SharedPtr<T>(other, p);
 }
 
+// 右值版本:接管 other 的控制块,整个转换不改动计数
+template <typename T, typename U>
+SharedPtr<T> static_pointer_cast(SharedPtr<U>&& other) noexcept {
+    T* p = static_cast<T*>(other.get());
+    return SharedPtr<T>(std::move(other), p);
+}
+
 
 // ============================================================================
 // dynamic_pointer_cast: 动态类型转换(运行期检查)
@@ -39,6 +48,16 @@ SharedPtr<T> dynamic_pointer_cast(const SharedPtr<U>& other) noexcept {
     }
 }
 
+// 右值版本:成功时接管 other 的控制块;失败时 other 保持不变
+template<typename T, typename U>
+SharedPtr<T> dynamic_pointer_cast(SharedPtr<U>&& other) noexcept {
+    T* p = dynamic_cast<T*>(other.get());
+    if (p) {
+        return SharedPtr<T>(std::move(other), p);
+    }
+    return SharedPtr<T>();
+}
+
 // ============================================================================
 // const_pointer_cast: 移除 const
 // ============================================================================
@@ -50,5 +69,12 @@ SharedPtr<T> const_pointer_cast(const SharedPtr<U>& other) noexcept {
     return SharedPtr<T>(other, p);
 }
 
+// 右值版本:接管 other 的控制块
+template<typename T, typename U>
+SharedPtr<T> const_pointer_cast(SharedPtr<U>&& other) noexcept {
+    T* p = const_cast<T*>(other.get());
+    return SharedPtr<T>(std::move(other), p);
+}
+
 } // namespace my
 #endif // MY_POINTER_CAST_HPP
\ No newline at end of file
@@ -0,0 +1,362 @@
+// my_refcount_profiler.h
+#ifndef MY_REFCOUNT_PROFILER_H
+#define MY_REFCOUNT_PROFILER_H
+
+// ============================================================================
+// 引用计数争用剖析器(剖析模式)
+// ============================================================================
+// 以 -DMY_SP_ENABLE_REFCOUNT_PROFILER 编译时:
+// - 每个线程精确统计 AddRefCopy / Release / WeakAddRef / AddRefLock 的次数
+// - 每 N 次计数操作采样 1 次,按控制块记录:各操作次数、触碰过的线程、
+//   相邻两次采样来自不同线程的次数(缓存行"交接"),以及原子 RMW 的耗时
+// - my::refcount_profile_report() 打印最热的 N 个对象
+//
+// 交接次数高、RMW 耗时长的对象,就是值得改用分段计数、永生对象或借用的地方。
+// 未定义该宏时,计数操作里没有任何额外代码,本文件只提供空实现的接口。
+
+#include <cstddef>
+#include <iostream>
+#include <ostream>
+#include <stdint.h>
+
+namespace my {
+
+// 当前线程执行过的计数操作次数(精确,不采样)
+struct RefcountOpCounts {
+  uint64_t add_ref_copy = 0;
+  uint64_t release = 0;
+  uint64_t weak_add_ref = 0;
+  uint64_t add_ref_lock = 0;
+};
+
+}  // namespace my
+
+#ifdef MY_SP_ENABLE_REFCOUNT_PROFILER
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// 默认采样率:每个线程每 N 次计数操作采样 1 次
+#ifndef MY_SP_REFCOUNT_PROFILE_SAMPLE_RATE
+#define MY_SP_REFCOUNT_PROFILE_SAMPLE_RATE 64
+#endif
+
+namespace my {
+namespace detail {
+
+class SpCountedBase;
+
+enum RefcountOp {
+  kOpAddRefCopy,
+  kOpRelease,
+  kOpWeakAddRef,
+  kOpAddRefLock,
+  kOpCount,
+};
+
+// 计时:x86 上用 TSC(周期),其他平台用 steady_clock(纳秒)
+inline uint64_t RefcountProfileTicks() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#endif
+}
+
+// 单个控制块的采样统计
+struct RefcountBlockStats {
+  static constexpr size_t kMaxThreads = 64;
+
+  const char* type_name = "?";
+  const void* block = nullptr;
+  bool retired = false;                    // 控制块已销毁
+  uint64_t ops[kOpCount] = {0, 0, 0, 0};   // 采样到的各操作次数
+  uint64_t ticks = 0;                      // 采样到的 RMW 总耗时
+  uint64_t handoffs = 0;                   // 与上一次采样来自不同线程
+  uint32_t last_thread = 0;
+  std::vector<uint32_t> threads;           // 触碰过的线程(至多 kMaxThreads 个)
+
+  uint64_t total_ops() const {
+    return ops[kOpAddRefCopy] + ops[kOpRelease] + ops[kOpWeakAddRef] +
+           ops[kOpAddRefLock];
+  }
+};
+
+class RefcountProfiler {
+ public:
+  static RefcountProfiler& Instance() {
+    // 故意泄漏:静态析构期间仍会有计数操作
+    static RefcountProfiler* instance = new RefcountProfiler();
+    return *instance;
+  }
+
+  void set_sample_rate(uint32_t rate) noexcept {
+    sample_rate_.store(rate ? rate : 1, std::memory_order_relaxed);
+  }
+
+  uint32_t sample_rate() const noexcept {
+    return sample_rate_.load(std::memory_order_relaxed);
+  }
+
+  void Record(const SpCountedBase* block, const char* type_name, int op,
+              uint64_t ticks, uint32_t thread) noexcept {
+    Shard& shard = ShardFor(block);
+    try {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      RefcountBlockStats& stats = shard.live[block];
+      if (stats.block == nullptr) {
+        stats.block = block;
+        stats.type_name = type_name;
+      }
+      ++stats.ops[op];
+      stats.ticks += ticks;
+      if (stats.last_thread != 0 && stats.last_thread != thread) {
+        ++stats.handoffs;
+      }
+      stats.last_thread = thread;
+      if (stats.threads.size() < RefcountBlockStats::kMaxThreads &&
+          std::find(stats.threads.begin(), stats.threads.end(), thread) ==
+              stats.threads.end()) {
+        stats.threads.push_back(thread);
+      }
+    } catch (...) {
+      // 内存不足时丢弃本次采样
+    }
+  }
+
+  // 控制块销毁:统计移入"已退役"列表,避免地址复用后与新对象混在一起
+  void Retire(const SpCountedBase* block) noexcept {
+    Shard& shard = ShardFor(block);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.live.find(block);
+    if (it == shard.live.end()) return;
+    try {
+      it->second.retired = true;
+      shard.retired.push_back(std::move(it->second));
+      if (shard.retired.size() > 2 * kMaxRetiredPerShard) {
+        KeepHottest(&shard.retired, kMaxRetiredPerShard);
+      }
+    } catch (...) {
+    }
+    shard.live.erase(it);
+  }
+
+  std::vector<RefcountBlockStats> Snapshot() const {
+    std::vector<RefcountBlockStats> all;
+    for (size_t i = 0; i < kShardCount; ++i) {
+      std::lock_guard<std::mutex> lock(shards_[i].mutex);
+      for (const auto& item : shards_[i].live) {
+        all.push_back(item.second);
+      }
+      all.insert(all.end(), shards_[i].retired.begin(),
+                 shards_[i].retired.end());
+    }
+    return all;
+  }
+
+  void Reset() {
+    for (size_t i = 0; i < kShardCount; ++i) {
+      std::lock_guard<std::mutex> lock(shards_[i].mutex);
+      shards_[i].live.clear();
+      shards_[i].retired.clear();
+    }
+  }
+
+  static void KeepHottest(std::vector<RefcountBlockStats>* stats, size_t n) {
+    if (stats->size() <= n) return;
+    std::partial_sort(stats->begin(), stats->begin() + n, stats->end(),
+                      [](const RefcountBlockStats& a,
+                         const RefcountBlockStats& b) {
+                        return a.total_ops() > b.total_ops();
+                      });
+    stats->resize(n);
+  }
+
+ private:
+  static constexpr size_t kShardCount = 64;
+  static constexpr size_t kMaxRetiredPerShard = 256;
+
+  struct Shard {
+    mutable std::mutex mutex;
+    std::unordered_map<const SpCountedBase*, RefcountBlockStats> live;
+    std::vector<RefcountBlockStats> retired;
+  };
+
+  RefcountProfiler() : sample_rate_(MY_SP_REFCOUNT_PROFILE_SAMPLE_RATE) {}
+
+  Shard& ShardFor(const SpCountedBase* block) noexcept {
+    return shards_[(reinterpret_cast<uintptr_t>(block) >> 4) % kShardCount];
+  }
+
+  std::atomic<uint32_t> sample_rate_;
+  mutable Shard shards_[kShardCount];
+};
+
+// 线程局部状态:精确计数 + 采样倒计时 + 小整数线程号(0 保留为"无")
+struct RefcountThreadState {
+  RefcountOpCounts counts;
+  uint32_t countdown = 0;
+  uint32_t id = 0;
+};
+
+inline RefcountThreadState& RefcountThisThread() noexcept {
+  static thread_local RefcountThreadState state;
+  return state;
+}
+
+inline uint32_t RefcountThreadId() noexcept {
+  static std::atomic<uint32_t> next_id(1);
+  RefcountThreadState& state = RefcountThisThread();
+  if (state.id == 0) state.id = next_id.fetch_add(1, std::memory_order_relaxed);
+  return state.id;
+}
+
+// 包住一次计数 RMW:构造时计数并决定是否采样,Finish() 时记录
+// Release() 递减之后控制块随时可能被其他线程销毁,所以传入 pin(弱引用计数):
+// 被采样时先加一个临时弱引用钉住控制块,Finish() 返回 true 时由调用方归还
+class RefcountProfileScope {
+ public:
+  explicit RefcountProfileScope(RefcountOp op,
+                                std::atomic<int64_t>* pin = nullptr) noexcept
+      : op_(op), sampled_(false), pinned_(false), start_(0) {
+    RefcountThreadState& state = RefcountThisThread();
+    switch (op) {
+      case kOpAddRefCopy: ++state.counts.add_ref_copy; break;
+      case kOpRelease: ++state.counts.release; break;
+      case kOpWeakAddRef: ++state.counts.weak_add_ref; break;
+      default: ++state.counts.add_ref_lock; break;
+    }
+    if (state.countdown != 0) {
+      --state.countdown;
+      return;
+    }
+    state.countdown = RefcountProfiler::Instance().sample_rate() - 1;
+    sampled_ = true;
+    if (pin) {
+      pin->fetch_add(1, std::memory_order_relaxed);
+      pinned_ = true;
+    }
+    start_ = RefcountProfileTicks();
+  }
+
+  // 在 RMW 之后调用;返回 true 表示调用方须归还钉住用的弱引用
+  bool Finish(const SpCountedBase* block, const char* type_name,
+              std::atomic<bool>* profiled) noexcept {
+    if (!sampled_) return false;
+    uint64_t elapsed = RefcountProfileTicks() - start_;
+    if (!profiled->load(std::memory_order_relaxed)) {
+      profiled->store(true, std::memory_order_relaxed);
+    }
+    RefcountProfiler::Instance().Record(block, type_name, op_, elapsed,
+                                        RefcountThreadId());
+    return pinned_;
+  }
+
+ private:
+  RefcountOp op_;
+  bool sampled_;
+  bool pinned_;
+  uint64_t start_;
+};
+
+inline void RefcountProfileRetire(const SpCountedBase* block) noexcept {
+  RefcountProfiler::Instance().Retire(block);
+}
+
+}  // namespace detail
+
+// 当前线程的计数操作次数
+inline RefcountOpCounts refcount_thread_op_counts() noexcept {
+  return detail::RefcountThisThread().counts;
+}
+
+// 每个线程每 rate 次计数操作采样 1 次(1 = 全部采样)
+inline void set_refcount_profile_sample_rate(uint32_t rate) noexcept {
+  detail::RefcountProfiler::Instance().set_sample_rate(rate);
+}
+
+// 清空已采集的按对象统计
+inline void refcount_profile_reset() {
+  detail::RefcountProfiler::Instance().Reset();
+}
+
+// 打印采样次数最多的 top_n 个对象,返回参与排名的对象数
+inline size_t refcount_profile_report(std::ostream& os = std::cerr,
+                                      size_t top_n = 10) {
+  using detail::RefcountBlockStats;
+  std::vector<RefcountBlockStats> all =
+      detail::RefcountProfiler::Instance().Snapshot();
+  size_t ranked = all.size();
+  detail::RefcountProfiler::KeepHottest(&all, top_n);
+  std::sort(all.begin(), all.end(),
+            [](const RefcountBlockStats& a, const RefcountBlockStats& b) {
+              return a.total_ops() > b.total_ops();
+            });
+
+  std::ios::fmtflags flags = os.flags();
+  std::streamsize precision = os.precision();
+  uint32_t rate = detail::RefcountProfiler::Instance().sample_rate();
+  os << "==== 引用计数热点: 前 " << all.size() << " / " << ranked
+     << " 个对象 (采样 1/" << rate << ", 次数已按采样率放大) ====\n";
+  for (const RefcountBlockStats& stats : all) {
+    uint64_t total = stats.total_ops();
+    os << "  " << stats.type_name << " @" << stats.block
+       << (stats.retired ? " (已销毁)" : "") << "\n"
+       << "      操作≈" << total * rate
+       << "  copy=" << stats.ops[detail::kOpAddRefCopy] * rate
+       << " release=" << stats.ops[detail::kOpRelease] * rate
+       << " weak=" << stats.ops[detail::kOpWeakAddRef] * rate
+       << " lock=" << stats.ops[detail::kOpAddRefLock] * rate << "\n"
+       << "      线程=" << stats.threads.size()
+       << (stats.threads.size() >= RefcountBlockStats::kMaxThreads ? "+" : "")
+       << "  跨线程交接=" << std::fixed << std::setprecision(1)
+       << stats.handoffs * 100.0 / (total ? total : 1) << "%"
+       << "  平均 RMW 耗时=" << stats.ticks / (total ? total : 1)
+#if defined(__x86_64__) || defined(__i386__)
+       << " 周期\n";
+#else
+       << " ns\n";
+#endif
+  }
+  os.flags(flags);
+  os.precision(precision);
+  return ranked;
+}
+
+}  // namespace my
+
+#else  // !MY_SP_ENABLE_REFCOUNT_PROFILER
+
+namespace my {
+
+inline RefcountOpCounts refcount_thread_op_counts() noexcept {
+  return RefcountOpCounts();
+}
+
+inline void set_refcount_profile_sample_rate(uint32_t) noexcept {}
+
+inline void refcount_profile_reset() {}
+
+inline size_t refcount_profile_report(std::ostream& os = std::cerr,
+                                      size_t top_n = 10) {
+  (void)top_n;
+  os << "引用计数剖析器未启用(编译时定义 MY_SP_ENABLE_REFCOUNT_PROFILER)\n";
+  return 0;
+}
+
+}  // namespace my
+
+#endif  // MY_SP_ENABLE_REFCOUNT_PROFILER
+
+#endif  // MY_REFCOUNT_PROFILER_H
@@ -0,0 +1,84 @@
+// my_release_latency.h
+#ifndef MY_RELEASE_LATENCY_H
+#define MY_RELEASE_LATENCY_H
+
+// ============================================================================
+// 最后一次 Release() 的耗时钩子(计时模式)
+// ============================================================================
+// 以 -DMY_SP_ENABLE_RELEASE_LATENCY_HOOK 编译时,每当最后一个强引用离开,
+// 如果安装了钩子,就分两段计时并回调:
+// - dispose_ns:析构被管理对象(含它级联释放的整棵对象图)和过期监听器
+// - destroy_ns:归还强引用组的弱引用;没有其他 WeakPtr 时包括释放控制块
+//
+// 用来在生产环境抓"偶发的多毫秒停顿":钩子里把样本写进直方图,
+// 或者只记录超过阈值的那一次。对象图的级联释放会按从内到外的顺序
+// 为每个节点各回调一次,外层的耗时包含内层。
+//
+// 钩子在释放线程上同步执行,必须很快且不得抛出异常;
+// 在钩子里释放 SharedPtr 会再次触发钩子。
+// 未安装钩子时,最后一次 Release() 只多一次原子读;
+// 未定义该宏时没有任何额外代码,set_release_latency_hook() 是空操作。
+
+#include <stdint.h>
+
+namespace my {
+
+struct ReleaseLatency {
+  const char* type_name;  // 被管理对象的类型(typeid 名字,未还原)
+  uint64_t dispose_ns;
+  uint64_t destroy_ns;
+};
+
+typedef void (*ReleaseLatencyHook)(const ReleaseLatency& sample);
+
+}  // namespace my
+
+#ifdef MY_SP_ENABLE_RELEASE_LATENCY_HOOK
+
+#include <atomic>
+#include <chrono>
+
+namespace my {
+namespace detail {
+
+// 零初始化,静态构造期间也可以安全读取
+inline std::atomic<ReleaseLatencyHook>& ReleaseLatencyHookSlot() noexcept {
+  static std::atomic<ReleaseLatencyHook> slot;
+  return slot;
+}
+
+inline ReleaseLatencyHook CurrentReleaseLatencyHook() noexcept {
+  return ReleaseLatencyHookSlot().load(std::memory_order_acquire);
+}
+
+inline uint64_t ReleaseLatencyNow() noexcept {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace detail
+
+// 安装钩子(nullptr 表示卸载),返回之前的钩子
+// 卸载后,正在其他线程上执行的回调可能仍会完成一次
+inline ReleaseLatencyHook set_release_latency_hook(
+    ReleaseLatencyHook hook) noexcept {
+  return detail::ReleaseLatencyHookSlot().exchange(hook,
+                                                   std::memory_order_acq_rel);
+}
+
+}  // namespace my
+
+#else  // !MY_SP_ENABLE_RELEASE_LATENCY_HOOK
+
+namespace my {
+
+inline ReleaseLatencyHook set_release_latency_hook(ReleaseLatencyHook) noexcept {
+  return nullptr;
+}
+
+}  // namespace my
+
+#endif  // MY_SP_ENABLE_RELEASE_LATENCY_HOOK
+
+#endif  // MY_RELEASE_LATENCY_H
@@ -2,6 +2,7 @@
 #define MY_MY_SHARED_PTR_HPP_
 
 #include <cstddef>
+#include <stdexcept>
 #include <stdint.h>
 #include <type_traits>
 #include <utility>
@@ -17,6 +18,9 @@ class WeakPtr;  //  前向声明
 namespace detail {
 //  标签类型:表示从 weak_ptr 构造时不抛异常
 struct SpNothrowTag {};
+
+// 扩展组件(on_expire 等)访问智能指针内部计数的统一入口
+struct SpAccess;
 }  // namespace detail
 
 // ============================================================================
@@ -53,6 +57,13 @@ class SharedPtr {
     // std::cout << "22" << std::endl;
   }
 
+  // 转移所有权:直接接管控制块,不改动计数
+  template <typename Y>
+  SharedPtr(SharedPtr<Y>&& other) noexcept
+      : ptr_(other.ptr_), count_(std::move(other.count_)) {
+    other.ptr_ = nullptr;
+  }
+
   //  从 weak_ptr 构造(用于 lock())
   template <typename Y>
   SharedPtr(const WeakPtr<Y>& other, detail::SpNothrowTag) noexcept
@@ -67,11 +78,12 @@ class SharedPtr {
   }
 
   // 从 inplace 控制块构造(用于 make_shared)
+  // 接管 control_block 持有的那 1 个强引用,不改动计数
   template <typename Y>
-  SharedPtr(detail::sp_inplace_tag<Y>, detail::SharedCount const& control_block) noexcept
-      : ptr_(nullptr), count_(control_block) {
+  SharedPtr(detail::sp_inplace_tag<Y>, detail::SharedCount&& control_block) noexcept
+      : ptr_(nullptr), count_(std::move(control_block)) {
         if (!count_.empty()) {
-          ptr_ = const_cast<detail::SharedCount&> (control_block).template GetInplacePointer<Y>();
+          ptr_ = count_.template GetInplacePointer<Y>();
         } 
       }
 
@@ -83,6 +95,13 @@ class SharedPtr {
         // 用于类型转换和访问成员
       };
 
+  // 别名构造(右值):接管 other 的控制块,other 变为空
+  template <typename Y>
+  SharedPtr(SharedPtr<Y>&& other, element_type* ptr) noexcept
+      : ptr_(ptr), count_(std::move(other.count_)) {
+    other.ptr_ = nullptr;
+  }
+
   SharedPtr(SharedPtr&& other) noexcept
       : ptr_(other.ptr_), count_(std::move(other.count_)) {
     other.ptr_ = nullptr;
@@ -115,6 +134,12 @@ class SharedPtr {
     return *this;
   }
 
+  template <typename Y>
+  SharedPtr& operator=(SharedPtr<Y>&& other) noexcept {
+    SharedPtr(std::move(other)).Swap(*this);
+    return *this;
+  }
+
   // nullptr 赋值
   SharedPtr& operator=(std::nullptr_t) noexcept {
     Reset();
@@ -166,6 +191,94 @@ class SharedPtr {
 
   explicit operator bool() const noexcept { return ptr_ != nullptr; }
 
+  // ------------------------------------------------------------------------
+  // 基于所有权(控制块)的比较与哈希
+  // ------------------------------------------------------------------------
+  // 别名指针与原指针共享控制块,因此视为同一所有者;
+  // 这些函数只读取控制块地址,不改动任何引用计数。
+
+  // 所有者标识:控制块地址(空指针返回 nullptr)
+  const void* owner_key() const noexcept { return count_.GetControlBlock(); }
+
+  template <typename Y>
+  bool owner_before(const SharedPtr<Y>& other) const noexcept {
+    return count_.GetControlBlock() < other.count_.GetControlBlock();
+  }
+
+  template <typename Y>
+  bool owner_before(const WeakPtr<Y>& other) const noexcept {
+    return count_.GetControlBlock() < other.count_.GetControlBlock();
+  }
+
+  template <typename Y>
+  bool owner_equal(const SharedPtr<Y>& other) const noexcept {
+    return count_.GetControlBlock() == other.count_.GetControlBlock();
+  }
+
+  template <typename Y>
+  bool owner_equal(const WeakPtr<Y>& other) const noexcept {
+    return count_.GetControlBlock() == other.count_.GetControlBlock();
+  }
+
+  size_t owner_hash() const noexcept {
+    return detail::OwnerHashOf(count_.GetControlBlock());
+  }
+
+  // ------------------------------------------------------------------------
+  // 裸指针往返(epoll data.ptr、io_uring user_data、C 回调的 void* 上下文)
+  // ------------------------------------------------------------------------
+  // into_raw() 交出 1 个强引用并把 *this 置空,from_raw() 把它收回;
+  // 每个 into_raw() 的结果必须恰好交给一次 from_raw(),否则对象泄漏。
+  // 两者都不分配、不改动计数。
+  //
+  // 只有一个指针宽度时:只适用于 make_shared 创建的对象,控制块地址由
+  // 对象地址反推。ptr_ 不在 inplace 位置(new 出来的对象、指向成员的别名)
+  // 时抛出 std::invalid_argument,*this 不变;空指针返回 nullptr。
+  // from_raw 的 T 必须与 into_raw 时相同。
+  //
+  // 其他对象用 into_raw_parts() / from_raw_parts():指针与控制块分开保存
+  // (例如放进每次操作本来就有的上下文结构里)。
+
+  T* into_raw() {
+    detail::SpCountedBase* control_block = count_.GetControlBlock();
+    if (!ptr_ && !control_block) return nullptr;
+    if (!ptr_ || detail::InplaceBlockOf(ptr_) != control_block) {
+      throw std::invalid_argument("into_raw 只适用于 make_shared 创建的对象");
+    }
+    T* ptr = ptr_;
+    ptr_ = nullptr;
+    count_.Detach();
+    return ptr;
+  }
+
+  static SharedPtr from_raw(T* ptr) noexcept {
+    SharedPtr result;
+    if (ptr) {
+      result.ptr_ = ptr;
+      result.count_ = detail::SharedCount(detail::sp_adopt_tag{}, detail::InplaceBlockOf(ptr));
+    }
+    return result;
+  }
+
+  struct RawParts {
+    T* ptr;
+    void* owner;  // 控制块,对调用方不透明
+  };
+
+  RawParts into_raw_parts() noexcept {
+    RawParts parts = {ptr_, count_.Detach()};
+    ptr_ = nullptr;
+    return parts;
+  }
+
+  static SharedPtr from_raw_parts(RawParts parts) noexcept {
+    SharedPtr result;
+    result.ptr_ = parts.ptr;
+    result.count_ = detail::SharedCount(
+        detail::sp_adopt_tag{}, static_cast<detail::SpCountedBase*>(parts.owner));
+    return result;
+  }
+
  private:
   T* ptr_;
   detail::SharedCount count_;
@@ -174,6 +287,7 @@ class SharedPtr {
   friend class SharedPtr;
   template <typename Y>
   friend class WeakPtr;  //  友元
+  friend struct detail::SpAccess;
 
   // 类型转换需要访问私有成员
   template <typename T1, typename U1>
@@ -185,8 +299,68 @@ class SharedPtr {
   template <typename T1, typename U1>
   friend SharedPtr<T1> const_pointer_cast(const SharedPtr<U1>&) noexcept;
 
+  template <typename T1, typename U1>
+  friend SharedPtr<T1> static_pointer_cast(SharedPtr<U1>&&) noexcept;
+
+  template <typename T1, typename U1>
+  friend SharedPtr<T1> dynamic_pointer_cast(SharedPtr<U1>&&) noexcept;
+
+  template <typename T1, typename U1>
+  friend SharedPtr<T1> const_pointer_cast(SharedPtr<U1>&&) noexcept;
+
+};
+
+namespace detail {
+
+struct SpAccess {
+  template <typename T>
+  static const SharedCount& Count(const SharedPtr<T>& p) noexcept {
+    return p.count_;
+  }
+
+  template <typename T>
+  static const WeakCount& Count(const WeakPtr<T>& p) noexcept {
+    return p.count_;
+  }
+
+  template <typename T>
+  static SpCountedBase* ControlBlock(const SharedPtr<T>& p) noexcept {
+    return p.count_.GetControlBlock();
+  }
+
+  template <typename T>
+  static SpCountedBase* ControlBlock(const WeakPtr<T>& p) noexcept {
+    return p.count_.GetControlBlock();
+  }
+
+  // 用 ptr 和一个已持有的强引用组装 SharedPtr,不改动计数
+  template <typename T>
+  static SharedPtr<T> Adopt(T* ptr, SpCountedBase* control_block) noexcept {
+    SharedPtr<T> result;
+    result.ptr_ = ptr;
+    result.count_ = SharedCount(sp_adopt_tag{}, control_block);
+    return result;
+  }
+
+  // 用 ptr 和一个已持有的弱引用组装 WeakPtr,不改动计数
+  template <typename T>
+  static WeakPtr<T> AdoptWeak(T* ptr, SpCountedBase* control_block) noexcept {
+    WeakPtr<T> result;
+    result.ptr_ = ptr;
+    result.count_ = WeakCount(sp_adopt_tag{}, control_block);
+    return result;
+  }
+
+  // 交出 p 持有的强引用并把 p 置空,不改动计数;返回控制块(空指针返回 nullptr)
+  template <typename T>
+  static SpCountedBase* Detach(SharedPtr<T>& p) noexcept {
+    p.ptr_ = nullptr;
+    return p.count_.Detach();
+  }
 };
 
+}  // namespace detail
+
 // ============================================================================
 // 比较运算符
 // ============================================================================
@@ -265,6 +439,15 @@ namespace std {
   void swap(my::SharedPtr<T>& a, my::SharedPtr<T>& b) noexcept {
     a.Swap(b);
   }
+
+  // 与 operator== 一致:按 get() 哈希
+  // 需要按所有权哈希时使用 my::OwnerHash
+  template <typename T>
+  struct hash<my::SharedPtr<T>> {
+    size_t operator()(const my::SharedPtr<T>& p) const noexcept {
+      return hash<T*>()(p.get());
+    }
+  };
 }
 
 #endif  // MY_MY_SHARED_PTR_HPP_
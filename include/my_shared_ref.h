@@ -0,0 +1,201 @@
+// my_shared_ref.h
+#ifndef MY_SHARED_REF_H
+#define MY_SHARED_REF_H
+
+// ============================================================================
+// SharedRef<T>: 永不为空的共享引用
+// ============================================================================
+// SharedCount 的拷贝、析构和赋值都要先判断 control_block_ 是否为空,
+// SharedPtr::operator-> 也不能假设非空。数据模型里很多字段从不为空,
+// SharedRef 在构造时就保证非空,之后拷贝无条件 AddRefCopy、析构无条件
+// Release,不再有任何空指针判断。
+//
+// 构造途径只有两条:
+// - make_shared_ref<T>(args...)
+// - 从 SharedPtr 显式构造,为空时抛出 std::invalid_argument
+// SharedRef 可以隐式转换为 SharedPtr<T>(或其基类),一次 AddRefCopy。
+//
+// SharedRef 没有"被移走"的空状态:移动构造等同拷贝(源不变,一次
+// AddRefCopy),移动赋值等同 Swap()(源得到目标原来的值,不改动计数)。
+// 两种情况下源都仍然非空、可以继续使用。
+
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <stdint.h>
+#include <utility>
+
+#include "my_make_shared.h"
+#include "my_shared_ptr.h"
+
+namespace my {
+
+template <typename T>
+class SharedRef {
+ public:
+  using element_type = T;
+
+  // ------------------------------------------------------------------------
+  // 构造函数
+  // ------------------------------------------------------------------------
+
+  // 从 SharedPtr 构造:共享所有权;空指针抛出 std::invalid_argument
+  template <typename Y>
+  explicit SharedRef(const SharedPtr<Y>& source)
+      : ptr_(source.get()), control_block_(detail::SpAccess::ControlBlock(source)) {
+    if (!ptr_ || !control_block_) ThrowNull();
+    control_block_->AddRefCopy();
+  }
+
+  // 右值版本:接管 source 的强引用,不改动计数;为空时抛出且 source 不变
+  template <typename Y>
+  explicit SharedRef(SharedPtr<Y>&& source)
+      : ptr_(source.get()), control_block_(detail::SpAccess::ControlBlock(source)) {
+    if (!ptr_ || !control_block_) ThrowNull();
+    detail::SpAccess::Detach(source);
+  }
+
+  SharedRef(const SharedRef& other) noexcept
+      : ptr_(other.ptr_), control_block_(other.control_block_) {
+    control_block_->AddRefCopy();
+  }
+
+  // 移动构造:源不能留空,所以与拷贝相同,源保持不变
+  SharedRef(SharedRef&& other) noexcept
+      : ptr_(other.ptr_), control_block_(other.control_block_) {
+    control_block_->AddRefCopy();
+  }
+
+  // 向上转换(SharedRef<Derived> -> SharedRef<Base>)
+  template <typename Y>
+  SharedRef(const SharedRef<Y>& other) noexcept
+      : ptr_(other.ptr_), control_block_(other.control_block_) {
+    control_block_->AddRefCopy();
+  }
+
+  ~SharedRef() noexcept { control_block_->Release(); }
+
+  // ------------------------------------------------------------------------
+  // 赋值运算符
+  // ------------------------------------------------------------------------
+
+  // 先加后减,自赋值也安全
+  SharedRef& operator=(const SharedRef& other) noexcept {
+    other.control_block_->AddRefCopy();
+    control_block_->Release();
+    ptr_ = other.ptr_;
+    control_block_ = other.control_block_;
+    return *this;
+  }
+
+  // 移动赋值:交换,源得到本对象原来的值,不改动计数
+  SharedRef& operator=(SharedRef&& other) noexcept {
+    Swap(other);
+    return *this;
+  }
+
+  template <typename Y>
+  SharedRef& operator=(const SharedRef<Y>& other) noexcept {
+    other.control_block_->AddRefCopy();
+    control_block_->Release();
+    ptr_ = other.ptr_;
+    control_block_ = other.control_block_;
+    return *this;
+  }
+
+  void Swap(SharedRef& other) noexcept {
+    std::swap(ptr_, other.ptr_);
+    std::swap(control_block_, other.control_block_);
+  }
+
+  // ------------------------------------------------------------------------
+  // 转换为 SharedPtr
+  // ------------------------------------------------------------------------
+
+  template <typename Y>
+  operator SharedPtr<Y>() const noexcept {
+    Y* ptr = ptr_;  // 只允许隐式的指针转换(Derived* -> Base*)
+    control_block_->AddRefCopy();
+    return detail::SpAccess::Adopt(ptr, control_block_);
+  }
+
+  // ------------------------------------------------------------------------
+  // 观察器(没有 operator bool:永远非空)
+  // ------------------------------------------------------------------------
+
+  T* get() const noexcept { return ptr_; }
+
+  T& operator*() const noexcept { return *ptr_; }
+
+  T* operator->() const noexcept { return ptr_; }
+
+  int64_t use_count() const noexcept { return control_block_->use_count(); }
+
+  const void* owner_key() const noexcept { return control_block_; }
+
+  size_t owner_hash() const noexcept { return detail::OwnerHashOf(control_block_); }
+
+ private:
+  // 已持有 1 个强引用的控制块
+  SharedRef(detail::sp_adopt_tag, T* ptr, detail::SpCountedBase* control_block) noexcept
+      : ptr_(ptr), control_block_(control_block) {}
+
+  // noreturn 让编译器知道空指针路径到不了析构函数
+  [[noreturn]] static void ThrowNull() {
+    throw std::invalid_argument("SharedRef 不能从空 SharedPtr 构造");
+  }
+
+  T* ptr_;
+  detail::SpCountedBase* control_block_;
+
+  template <typename Y>
+  friend class SharedRef;
+
+  template <typename Y, typename... Args>
+  friend SharedRef<Y> make_shared_ref(Args&&... args);
+};
+
+// 与 make_shared 相同的单次分配,结果保证非空
+template <typename T, typename... Args>
+SharedRef<T> make_shared_ref(Args&&... args) {
+  SharedPtr<T> sp = make_shared<T>(std::forward<Args>(args)...);
+  T* ptr = sp.get();
+  return SharedRef<T>(detail::sp_adopt_tag{}, ptr, detail::SpAccess::Detach(sp));
+}
+
+// ============================================================================
+// 比较运算符
+// ============================================================================
+
+template <typename T, typename U>
+bool operator==(const SharedRef<T>& a, const SharedRef<U>& b) noexcept {
+  return a.get() == b.get();
+}
+
+template <typename T, typename U>
+bool operator!=(const SharedRef<T>& a, const SharedRef<U>& b) noexcept {
+  return !(a == b);
+}
+
+template <typename T>
+void swap(SharedRef<T>& a, SharedRef<T>& b) noexcept {
+  a.Swap(b);
+}
+
+}  // namespace my
+
+namespace std {
+  template <typename T>
+  void swap(my::SharedRef<T>& a, my::SharedRef<T>& b) noexcept {
+    a.Swap(b);
+  }
+
+  template <typename T>
+  struct hash<my::SharedRef<T>> {
+    size_t operator()(const my::SharedRef<T>& p) const noexcept {
+      return hash<T*>()(p.get());
+    }
+  };
+}
+
+#endif  // MY_SHARED_REF_H
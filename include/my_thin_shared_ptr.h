@@ -0,0 +1,299 @@
+// my_thin_shared_ptr.h
+#ifndef MY_THIN_SHARED_PTR_H
+#define MY_THIN_SHARED_PTR_H
+
+// ============================================================================
+// ThinSharedPtr<T> / ThinWeakPtr<T>: 单字(8 字节)的智能指针
+// ============================================================================
+// SharedPtr 是两个字:对象指针 + 控制块指针。make_shared 创建的对象就放在
+// SpCountedImplPdi<T> 里的固定偏移处,所以只存控制块指针、get() 按偏移算出
+// 对象地址就够了。容器里存上亿个指针时,内存减半,扫描时缓存里能多放一倍。
+//
+// 代价与限制:
+// - 只能指向 make_shared<T> / make_thin_shared<T> 创建的、类型恰好为 T 的对象;
+//   别名指针、new 出来的对象、指向基类的 SharedPtr 都不能转换(to_thin 返回空)
+// - 没有 Thin<Derived> -> Thin<Base> 的转换(偏移随类型而变),
+//   需要时先转成 SharedPtr<T> 再转换
+// - get() 多一次空指针判断和加法
+//
+// 计数操作与 SharedPtr / WeakPtr 完全相同,两者可以混合持有同一个对象。
+
+#include <cstddef>
+#include <functional>
+#include <stdint.h>
+#include <utility>
+
+#include "my_shared_ptr.h"
+#include "my_weak_ptr.h"
+
+namespace my {
+
+template <typename T>
+class ThinWeakPtr;
+
+// ============================================================================
+// ThinSharedPtr
+// ============================================================================
+
+template <typename T>
+class ThinSharedPtr {
+ public:
+  using element_type = T;
+  typedef detail::SpCountedImplPdi<T> BlockType;
+
+  // ------------------------------------------------------------------------
+  // 构造函数
+  // ------------------------------------------------------------------------
+
+  ThinSharedPtr() noexcept : block_(nullptr) {}
+
+  ThinSharedPtr(std::nullptr_t) noexcept : block_(nullptr) {}
+
+  // 接管 block 已持有的 1 个强引用,不改动计数
+  ThinSharedPtr(detail::sp_adopt_tag, BlockType* block) noexcept : block_(block) {}
+
+  ThinSharedPtr(const ThinSharedPtr& other) noexcept : block_(other.block_) {
+    if (block_) block_->AddRefCopy();
+  }
+
+  ThinSharedPtr(ThinSharedPtr&& other) noexcept : block_(other.block_) {
+    other.block_ = nullptr;
+  }
+
+  ~ThinSharedPtr() noexcept {
+    if (block_) block_->Release();
+  }
+
+  // ------------------------------------------------------------------------
+  // 赋值运算符
+  // ------------------------------------------------------------------------
+
+  ThinSharedPtr& operator=(const ThinSharedPtr& other) noexcept {
+    ThinSharedPtr(other).Swap(*this);
+    return *this;
+  }
+
+  ThinSharedPtr& operator=(ThinSharedPtr&& other) noexcept {
+    ThinSharedPtr(std::move(other)).Swap(*this);
+    return *this;
+  }
+
+  ThinSharedPtr& operator=(std::nullptr_t) noexcept {
+    Reset();
+    return *this;
+  }
+
+  // ------------------------------------------------------------------------
+  // 修改器
+  // ------------------------------------------------------------------------
+
+  void Reset() noexcept { ThinSharedPtr().Swap(*this); }
+
+  void Swap(ThinSharedPtr& other) noexcept {
+    BlockType* tmp = block_;
+    block_ = other.block_;
+    other.block_ = tmp;
+  }
+
+  // ------------------------------------------------------------------------
+  // 转换为 SharedPtr
+  // ------------------------------------------------------------------------
+
+  // 左值:共享所有权,一次 AddRefCopy
+  operator SharedPtr<T>() const& noexcept {
+    if (!block_) return SharedPtr<T>();
+    block_->AddRefCopy();
+    return detail::SpAccess::Adopt(block_->GetPoint(), block_);
+  }
+
+  // 右值:转移所有权,不改动计数
+  operator SharedPtr<T>() && noexcept {
+    if (!block_) return SharedPtr<T>();
+    BlockType* block = block_;
+    block_ = nullptr;
+    return detail::SpAccess::Adopt(block->GetPoint(), block);
+  }
+
+  // ------------------------------------------------------------------------
+  // 观察器
+  // ------------------------------------------------------------------------
+
+  T* get() const noexcept { return block_ ? block_->GetPoint() : nullptr; }
+
+  T& operator*() const noexcept { return *block_->GetPoint(); }
+
+  T* operator->() const noexcept { return block_->GetPoint(); }
+
+  int64_t use_count() const noexcept { return block_ ? block_->use_count() : 0; }
+
+  bool unique() const noexcept { return use_count() == 1; }
+
+  explicit operator bool() const noexcept { return block_ != nullptr; }
+
+  // 与 SharedPtr::owner_key() 相同:控制块地址
+  const void* owner_key() const noexcept {
+    return static_cast<const detail::SpCountedBase*>(block_);
+  }
+
+  size_t owner_hash() const noexcept {
+    return detail::OwnerHashOf(static_cast<detail::SpCountedBase*>(block_));
+  }
+
+ private:
+  BlockType* block_;
+
+  friend class ThinWeakPtr<T>;
+};
+
+// ============================================================================
+// ThinWeakPtr
+// ============================================================================
+
+template <typename T>
+class ThinWeakPtr {
+ public:
+  using element_type = T;
+  typedef detail::SpCountedImplPdi<T> BlockType;
+
+  ThinWeakPtr() noexcept : block_(nullptr) {}
+
+  ThinWeakPtr(const ThinSharedPtr<T>& other) noexcept : block_(other.block_) {
+    if (block_) block_->WeakAddRef();
+  }
+
+  ThinWeakPtr(const ThinWeakPtr& other) noexcept : block_(other.block_) {
+    if (block_) block_->WeakAddRef();
+  }
+
+  ThinWeakPtr(ThinWeakPtr&& other) noexcept : block_(other.block_) {
+    other.block_ = nullptr;
+  }
+
+  ~ThinWeakPtr() noexcept {
+    if (block_) block_->WeakRelease();
+  }
+
+  ThinWeakPtr& operator=(const ThinWeakPtr& other) noexcept {
+    ThinWeakPtr(other).Swap(*this);
+    return *this;
+  }
+
+  ThinWeakPtr& operator=(ThinWeakPtr&& other) noexcept {
+    ThinWeakPtr(std::move(other)).Swap(*this);
+    return *this;
+  }
+
+  ThinWeakPtr& operator=(const ThinSharedPtr<T>& other) noexcept {
+    ThinWeakPtr(other).Swap(*this);
+    return *this;
+  }
+
+  // 提升为强引用;对象已死返回空
+  ThinSharedPtr<T> lock() const noexcept {
+    if (block_ && block_->AddRefLock()) {
+      return ThinSharedPtr<T>(detail::sp_adopt_tag{}, block_);
+    }
+    return ThinSharedPtr<T>();
+  }
+
+  bool expired() const noexcept { return use_count() == 0; }
+
+  int64_t use_count() const noexcept { return block_ ? block_->use_count() : 0; }
+
+  void Reset() noexcept { ThinWeakPtr().Swap(*this); }
+
+  void Swap(ThinWeakPtr& other) noexcept {
+    BlockType* tmp = block_;
+    block_ = other.block_;
+    other.block_ = tmp;
+  }
+
+  const void* owner_key() const noexcept {
+    return static_cast<const detail::SpCountedBase*>(block_);
+  }
+
+ private:
+  BlockType* block_;
+};
+
+// ============================================================================
+// 工厂函数与转换
+// ============================================================================
+
+// 与 make_shared 相同的单次分配,直接得到单字指针
+template <typename T, typename... Args>
+ThinSharedPtr<T> make_thin_shared(Args&&... args) {
+  return ThinSharedPtr<T>(
+      detail::sp_adopt_tag{},
+      new detail::SpCountedImplPdi<T>(std::forward<Args>(args)...));
+}
+
+namespace detail {
+
+// sp 是否指向它自己控制块里内联的 T(即由 make_shared<T> 创建且未被别名)
+// 用 dynamic_cast 确认控制块类型,只在转换时付一次,不影响 get()
+template <typename T>
+SpCountedImplPdi<T>* ThinBlockOf(const SharedPtr<T>& sp) noexcept {
+  SpCountedImplPdi<T>* inplace =
+      dynamic_cast<SpCountedImplPdi<T>*>(SpAccess::ControlBlock(sp));
+  return inplace && inplace->GetPoint() == sp.get() ? inplace : nullptr;
+}
+
+}  // namespace detail
+
+// 从 SharedPtr 转换:共享所有权,一次 AddRefCopy
+// sp 不是 make_shared<T> 创建的对象时返回空
+template <typename T>
+ThinSharedPtr<T> to_thin(const SharedPtr<T>& sp) noexcept {
+  detail::SpCountedImplPdi<T>* block = detail::ThinBlockOf(sp);
+  if (!block) return ThinSharedPtr<T>();
+  block->AddRefCopy();
+  return ThinSharedPtr<T>(detail::sp_adopt_tag{}, block);
+}
+
+// 右值版本:转移所有权,不改动计数;不能转换时 sp 保持不变
+template <typename T>
+ThinSharedPtr<T> to_thin(SharedPtr<T>&& sp) noexcept {
+  detail::SpCountedImplPdi<T>* block = detail::ThinBlockOf(sp);
+  if (!block) return ThinSharedPtr<T>();
+  detail::SpAccess::Detach(sp);
+  return ThinSharedPtr<T>(detail::sp_adopt_tag{}, block);
+}
+
+// ============================================================================
+// 比较运算符
+// ============================================================================
+
+template <typename T>
+bool operator==(const ThinSharedPtr<T>& a, const ThinSharedPtr<T>& b) noexcept {
+  return a.owner_key() == b.owner_key();
+}
+
+template <typename T>
+bool operator!=(const ThinSharedPtr<T>& a, const ThinSharedPtr<T>& b) noexcept {
+  return !(a == b);
+}
+
+template <typename T>
+bool operator==(const ThinSharedPtr<T>& a, std::nullptr_t) noexcept {
+  return !a;
+}
+
+template <typename T>
+bool operator!=(const ThinSharedPtr<T>& a, std::nullptr_t) noexcept {
+  return static_cast<bool>(a);
+}
+
+}  // namespace my
+
+namespace std {
+  // 与 operator== 一致:同一控制块即同一对象
+  template <typename T>
+  struct hash<my::ThinSharedPtr<T>> {
+    size_t operator()(const my::ThinSharedPtr<T>& p) const noexcept {
+      return hash<const void*>()(p.owner_key());
+    }
+  };
+}
+
+#endif  // MY_THIN_SHARED_PTR_H
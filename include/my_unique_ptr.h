@@ -0,0 +1,296 @@
+// my_unique_ptr.h
+#ifndef MY_UNIQUE_PTR_H
+#define MY_UNIQUE_PTR_H
+
+// ============================================================================
+// UniquePtr<T, D>: 独占所有权,可以原地提升为 SharedPtr
+// ============================================================================
+// std::unique_ptr 转成 SharedPtr 时总要另外分配一个控制块。
+// UniquePtr 有两种来源:
+// - 普通的 UniquePtr<T, D>(new T, d) / make_unique<T>():转换为 SharedPtr 时
+//   复用 sp_counted_impl.h 的控制块(默认删除器用 SpCountedImplPointer,
+//   自定义删除器用 SpCountedImplPointerDeleter),分配一次控制块
+// - make_unique_promotable<T>():对象直接构造在预留的 SpCountedImplPdi<T>
+//   里(与 make_shared 相同的布局),SharedPtr<T>(std::move(unique)) 原地接管
+//   这个控制块,不分配、不改动计数
+//
+// 先独占、偶尔变成共享的对象用 make_unique_promotable,一共只分配一次;
+// 代价是独占期间也占着控制块的空间(sizeof(SpCountedBase)),
+// 析构时走控制块的 Release()。
+//
+// 为可提升对象交出裸指针没有意义(对象不在独立的 new 出来的内存里),
+// 所以 UniquePtr 不提供 release()。不支持数组。
+
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#include "my_shared_ptr.h"
+#include "sp_counted_impl.h"
+
+namespace my {
+
+// 默认删除器
+template <typename T>
+struct DefaultDelete {
+  DefaultDelete() noexcept {}
+
+  template <typename Y>
+  DefaultDelete(const DefaultDelete<Y>&) noexcept {}
+
+  void operator()(T* ptr) const noexcept { detail::CheckedDelete(ptr); }
+};
+
+namespace detail {
+
+// 为独立分配的对象创建控制块:默认删除器不必存储
+template <typename T>
+SpCountedBase* NewUniqueBlock(T* ptr, DefaultDelete<T>&) {
+  return new SpCountedImplPointer<T>(ptr);
+}
+
+// 传拷贝而不是移动:C++17 之前按值形参的初始化与分配函数之间没有先后,
+// 移动可能发生在 new 抛出 bad_alloc 之前,让调用方的删除器变成移走后的状态
+template <typename T, typename D>
+SpCountedBase* NewUniqueBlock(T* ptr, D& deleter) {
+  return new SpCountedImplPointerDeleter<T*, D>(ptr, deleter);
+}
+
+// 删除器的存储:空类(如 DefaultDelete)作为基类,空基类优化后不占空间,
+// UniquePtr<T> 只有指针和预留控制块两个字;final 类不能继承,只能作成员
+template <typename D, bool = std::is_empty<D>::value && !__is_final(D)>
+class UniqueDeleterStorage : private D {
+ public:
+  UniqueDeleterStorage() : D() {}
+  explicit UniqueDeleterStorage(D&& deleter) : D(std::move(deleter)) {}
+
+  D& deleter() noexcept { return *this; }
+  const D& deleter() const noexcept { return *this; }
+};
+
+template <typename D>
+class UniqueDeleterStorage<D, false> {
+ public:
+  UniqueDeleterStorage() : deleter_() {}
+  explicit UniqueDeleterStorage(D&& deleter) : deleter_(std::move(deleter)) {}
+
+  D& deleter() noexcept { return deleter_; }
+  const D& deleter() const noexcept { return deleter_; }
+
+ private:
+  D deleter_;
+};
+
+}  // namespace detail
+
+template <typename T, typename D = DefaultDelete<T>>
+class UniquePtr : private detail::UniqueDeleterStorage<D> {
+  typedef detail::UniqueDeleterStorage<D> DeleterStorage;
+
+ public:
+  using element_type = T;
+  using deleter_type = D;
+
+  // ------------------------------------------------------------------------
+  // 构造函数
+  // ------------------------------------------------------------------------
+
+  UniquePtr() noexcept : DeleterStorage(), ptr_(nullptr), reserved_(nullptr) {}
+
+  UniquePtr(std::nullptr_t) noexcept
+      : DeleterStorage(), ptr_(nullptr), reserved_(nullptr) {}
+
+  explicit UniquePtr(T* ptr) noexcept : DeleterStorage(), ptr_(ptr), reserved_(nullptr) {}
+
+  UniquePtr(T* ptr, D deleter) noexcept
+      : DeleterStorage(std::move(deleter)), ptr_(ptr), reserved_(nullptr) {}
+
+  UniquePtr(UniquePtr&& other) noexcept
+      : DeleterStorage(std::move(other.get_deleter())),
+        ptr_(other.ptr_),
+        reserved_(other.reserved_) {
+    other.ptr_ = nullptr;
+    other.reserved_ = nullptr;
+  }
+
+  // 向上转换(UniquePtr<Derived> -> UniquePtr<Base>)
+  template <typename Y, typename E>
+  UniquePtr(UniquePtr<Y, E>&& other) noexcept
+      : DeleterStorage(D(std::move(other.get_deleter()))),
+        ptr_(other.ptr_),
+        reserved_(other.reserved_) {
+    other.ptr_ = nullptr;
+    other.reserved_ = nullptr;
+  }
+
+  UniquePtr(const UniquePtr&) = delete;
+  UniquePtr& operator=(const UniquePtr&) = delete;
+
+  ~UniquePtr() noexcept { Destroy(); }
+
+  // ------------------------------------------------------------------------
+  // 赋值运算符
+  // ------------------------------------------------------------------------
+
+  UniquePtr& operator=(UniquePtr&& other) noexcept {
+    UniquePtr(std::move(other)).Swap(*this);
+    return *this;
+  }
+
+  template <typename Y, typename E>
+  UniquePtr& operator=(UniquePtr<Y, E>&& other) noexcept {
+    UniquePtr(std::move(other)).Swap(*this);
+    return *this;
+  }
+
+  UniquePtr& operator=(std::nullptr_t) noexcept {
+    Reset();
+    return *this;
+  }
+
+  // ------------------------------------------------------------------------
+  // 修改器
+  // ------------------------------------------------------------------------
+
+  void Reset() noexcept {
+    Destroy();
+    ptr_ = nullptr;
+    reserved_ = nullptr;
+  }
+
+  void Reset(T* ptr) noexcept {
+    Destroy();
+    ptr_ = ptr;
+    reserved_ = nullptr;
+  }
+
+  void Swap(UniquePtr& other) noexcept {
+    std::swap(ptr_, other.ptr_);
+    std::swap(get_deleter(), other.get_deleter());
+    std::swap(reserved_, other.reserved_);
+  }
+
+  // ------------------------------------------------------------------------
+  // 提升为 SharedPtr
+  // ------------------------------------------------------------------------
+
+  // 可提升对象:原地接管预留控制块,不分配、不改动计数
+  // 普通对象:分配一个控制块;分配失败时抛出,*this 保持不变
+  template <typename Y>
+  operator SharedPtr<Y>() && {
+    if (!ptr_) return SharedPtr<Y>();
+    Y* ptr = ptr_;  // 只允许隐式的指针转换(Derived* -> Base*)
+    detail::SpCountedBase* control_block =
+        reserved_ ? reserved_ : detail::NewUniqueBlock(ptr_, get_deleter());
+    ptr_ = nullptr;
+    reserved_ = nullptr;
+    return detail::SpAccess::Adopt(ptr, control_block);
+  }
+
+  // ------------------------------------------------------------------------
+  // 观察器
+  // ------------------------------------------------------------------------
+
+  T* get() const noexcept { return ptr_; }
+
+  typename std::add_lvalue_reference<T>::type operator*() const noexcept {
+    return *ptr_;
+  }
+
+  T* operator->() const noexcept { return ptr_; }
+
+  explicit operator bool() const noexcept { return ptr_ != nullptr; }
+
+  D& get_deleter() noexcept { return DeleterStorage::deleter(); }
+  const D& get_deleter() const noexcept { return DeleterStorage::deleter(); }
+
+  // 是否由 make_unique_promotable 创建(提升时不分配)
+  bool promotable() const noexcept { return reserved_ != nullptr; }
+
+ private:
+  // 接管预留控制块里的对象,控制块持有 1 个强引用
+  UniquePtr(detail::sp_adopt_tag, T* ptr, detail::SpCountedBase* reserved) noexcept
+      : DeleterStorage(), ptr_(ptr), reserved_(reserved) {}
+
+  void Destroy() noexcept {
+    if (reserved_) {
+      reserved_->Release();  // 控制块里只有这 1 个强引用:析构对象并释放整块
+    } else if (ptr_) {
+      get_deleter()(ptr_);
+    }
+  }
+
+  T* ptr_;
+  detail::SpCountedBase* reserved_;  // 预留的控制块;普通对象为空
+
+  template <typename Y, typename E>
+  friend class UniquePtr;
+
+  template <typename Y, typename... Args>
+  friend UniquePtr<Y> make_unique_promotable(Args&&... args);
+};
+
+// ============================================================================
+// 工厂函数
+// ============================================================================
+
+template <typename T, typename... Args>
+UniquePtr<T> make_unique(Args&&... args) {
+  return UniquePtr<T>(new T(std::forward<Args>(args)...));
+}
+
+// 对象构造在预留的控制块里,以后提升为 SharedPtr 不再分配
+template <typename T, typename... Args>
+UniquePtr<T> make_unique_promotable(Args&&... args) {
+  detail::SpCountedImplPdi<T>* block =
+      new detail::SpCountedImplPdi<T>(std::forward<Args>(args)...);
+  return UniquePtr<T>(detail::sp_adopt_tag{}, block->GetPoint(), block);
+}
+
+// ============================================================================
+// 比较运算符
+// ============================================================================
+
+template <typename T, typename D, typename U, typename E>
+bool operator==(const UniquePtr<T, D>& a, const UniquePtr<U, E>& b) noexcept {
+  return a.get() == b.get();
+}
+
+template <typename T, typename D, typename U, typename E>
+bool operator!=(const UniquePtr<T, D>& a, const UniquePtr<U, E>& b) noexcept {
+  return !(a == b);
+}
+
+template <typename T, typename D>
+bool operator==(const UniquePtr<T, D>& a, std::nullptr_t) noexcept {
+  return !a;
+}
+
+template <typename T, typename D>
+bool operator!=(const UniquePtr<T, D>& a, std::nullptr_t) noexcept {
+  return static_cast<bool>(a);
+}
+
+template <typename T, typename D>
+void swap(UniquePtr<T, D>& a, UniquePtr<T, D>& b) noexcept {
+  a.Swap(b);
+}
+
+}  // namespace my
+
+namespace std {
+  template <typename T, typename D>
+  void swap(my::UniquePtr<T, D>& a, my::UniquePtr<T, D>& b) noexcept {
+    a.Swap(b);
+  }
+
+  template <typename T, typename D>
+  struct hash<my::UniquePtr<T, D>> {
+    size_t operator()(const my::UniquePtr<T, D>& p) const noexcept {
+      return hash<T*>()(p.get());
+    }
+  };
+}
+
+#endif  // MY_UNIQUE_PTR_H
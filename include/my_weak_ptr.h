@@ -3,6 +3,7 @@
 #define MY_MY_WEAK_PTR_HPP_
 
 #include <cstddef>
+#include <stdexcept>
 #include <stdint.h>
 #include <utility>
 
@@ -16,6 +17,7 @@ class SharedPtr;  // 前向声明
 namespace detail {
 //  标签类型:表示从 weak_ptr 构造时不抛异常
 struct SpNothrowTag;
+struct SpAccess;
 }  // namespace detail
 
 // ============================================================================
@@ -121,6 +123,37 @@ class WeakPtr {
   // use_count():返回强引用计数
   int64_t use_count() const noexcept { return count_.use_count(); }
 
+  // ------------------------------------------------------------------------
+  // 基于所有权(控制块)的比较与哈希
+  // ------------------------------------------------------------------------
+  // 对象过期后控制块仍然存在,因此过期的 WeakPtr 依然能稳定地比较和哈希。
+
+  const void* owner_key() const noexcept { return count_.GetControlBlock(); }
+
+  template <typename Y>
+  bool owner_before(const WeakPtr<Y>& other) const noexcept {
+    return count_.GetControlBlock() < other.count_.GetControlBlock();
+  }
+
+  template <typename Y>
+  bool owner_before(const SharedPtr<Y>& other) const noexcept {
+    return count_.GetControlBlock() < other.count_.GetControlBlock();
+  }
+
+  template <typename Y>
+  bool owner_equal(const WeakPtr<Y>& other) const noexcept {
+    return count_.GetControlBlock() == other.count_.GetControlBlock();
+  }
+
+  template <typename Y>
+  bool owner_equal(const SharedPtr<Y>& other) const noexcept {
+    return count_.GetControlBlock() == other.count_.GetControlBlock();
+  }
+
+  size_t owner_hash() const noexcept {
+    return detail::OwnerHashOf(count_.GetControlBlock());
+  }
+
   // ------------------------------------------------------------------------
   // 修改器
   // ------------------------------------------------------------------------
@@ -140,6 +173,52 @@ class WeakPtr {
 
   void swap(WeakPtr& other) noexcept { Swap(other); }
 
+  // ------------------------------------------------------------------------
+  // 裸指针往返:交出 / 收回 1 个弱引用,规则与 SharedPtr::into_raw 相同
+  // ------------------------------------------------------------------------
+  // 对象过期后控制块仍被这个弱引用保住,所以往返期间过期也没关系:
+  // 反推控制块只用到对象地址,不访问对象本身。
+
+  T* into_raw() {
+    detail::SpCountedBase* control_block = count_.GetControlBlock();
+    if (!ptr_ && !control_block) return nullptr;
+    if (!ptr_ || detail::InplaceBlockOf(ptr_) != control_block) {
+      throw std::invalid_argument("into_raw 只适用于 make_shared 创建的对象");
+    }
+    T* ptr = ptr_;
+    ptr_ = nullptr;
+    count_.Detach();
+    return ptr;
+  }
+
+  static WeakPtr from_raw(T* ptr) noexcept {
+    WeakPtr result;
+    if (ptr) {
+      result.ptr_ = ptr;
+      result.count_ = detail::WeakCount(detail::sp_adopt_tag{}, detail::InplaceBlockOf(ptr));
+    }
+    return result;
+  }
+
+  struct RawParts {
+    T* ptr;
+    void* owner;  // 控制块,对调用方不透明
+  };
+
+  RawParts into_raw_parts() noexcept {
+    RawParts parts = {ptr_, count_.Detach()};
+    ptr_ = nullptr;
+    return parts;
+  }
+
+  static WeakPtr from_raw_parts(RawParts parts) noexcept {
+    WeakPtr result;
+    result.ptr_ = parts.ptr;
+    result.count_ = detail::WeakCount(
+        detail::sp_adopt_tag{}, static_cast<detail::SpCountedBase*>(parts.owner));
+    return result;
+  }
+
  private:
   T* ptr_;                 // 对象指针(可能已失效)
   detail::WeakCount count_;  // 弱引用计数
@@ -148,6 +227,7 @@ class WeakPtr {
   friend class WeakPtr;
   template <typename Y>
   friend class SharedPtr;
+  friend struct detail::SpAccess;
 };
 
 // ============================================================================
@@ -156,7 +236,7 @@ class WeakPtr {
 
 template <typename T, typename U>
 bool operator<(const WeakPtr<T>& a, const WeakPtr<U>& b) noexcept {
-  return a.count_.OwnerBefore(b.count_);  // 比较控制块地址
+  return a.owner_before(b);  // 比较控制块地址
 }
 
 }  // namespace my
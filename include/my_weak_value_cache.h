@@ -0,0 +1,299 @@
+// my_weak_value_cache.h
+#ifndef MY_WEAK_VALUE_CACHE_H
+#define MY_WEAK_VALUE_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>  // for unique_ptr
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "my_make_shared.h"
+#include "my_weak_ptr.h"
+
+namespace my {
+
+template <typename K, typename V, typename Hash>
+class WeakValueCache;
+
+namespace detail {
+
+// ============================================================================
+// SpCountedImplCacheEntry: 带过期钩子的 inplace 控制块
+// ============================================================================
+// 值与控制块一次分配(同 make_shared),Dispose() 析构值之后把控制块自己
+// 压入所在分片的待清理栈(无锁、不分配),再不阻塞地尝试删除条目
+// (见 Core::DrainStale)。Dispose() 可能发生在任何线程、任何锁之下,
+// 所以这里只用 try_lock,从不等待分片锁。
+// 缓存本身可能先于值被销毁,所以只持有它的 WeakPtr。
+
+template <typename K, typename V, typename Core>
+class SpCountedImplCacheEntry : public SpCountedImplPdi<V> {
+ private:
+  WeakPtr<Core> core_;
+  K key_;
+  size_t shard_index_;
+
+ public:
+  template <typename... Args>
+  SpCountedImplCacheEntry(const WeakPtr<Core>& core, const K& key,
+                          size_t shard_index, Args&&... args)
+      : SpCountedImplPdi<V>(std::forward<Args>(args)...),
+        core_(core),
+        key_(key),
+        shard_index_(shard_index),
+        next_stale(nullptr) {}
+
+  void Dispose() noexcept override {
+    SpCountedImplPdi<V>::Dispose();
+    if (SharedPtr<Core> core = core_.lock()) {
+      core->DeferPurge(this);
+      core->DrainStale(shard_index_);
+    }
+  }
+
+  const K& key() const noexcept { return key_; }
+  size_t shard_index() const noexcept { return shard_index_; }
+
+  // 待清理栈的链接(由 Core 维护)
+  SpCountedImplCacheEntry* next_stale;
+};
+
+}  // namespace detail
+
+// ============================================================================
+// WeakValueCache: 分片并发的弱值缓存
+// ============================================================================
+// - GetOrCreate() 返回 SharedPtr<V>;同一个键并发未命中时只构建一次
+// - 值的最后一个强引用释放时,控制块钩子登记该条目,并用 try_lock 在
+//   释放线程里立即删除;分片锁正被占用时,由持锁线程解锁后接手删除。
+//   仍有的延迟:try_lock 伪失败(标准允许,glibc 不会发生)时,条目和它
+//   钉住的控制块(含值的原地存储)留到同一分片下次加锁访问。无需周期性扫描
+// - 每个分片一把锁,不存在全局锁;构建值时只持有该键条目的锁
+//
+// 注意:不要在持有某个值的 SharedPtr 时从该值的析构函数里回调同一个缓存。
+
+template <typename K, typename V, typename Hash = std::hash<K>>
+class WeakValueCache {
+ public:
+  static constexpr size_t kDefaultShardCount = 16;
+
+  explicit WeakValueCache(size_t shard_count = kDefaultShardCount)
+      : core_(my::make_shared<Core>(shard_count ? shard_count : 1)) {}
+
+  WeakValueCache(const WeakValueCache&) = delete;
+  WeakValueCache& operator=(const WeakValueCache&) = delete;
+
+  // 命中则返回已有值,否则调用 factory(key) 构建
+  // factory 的返回值用于原地构造 V(与控制块同一次分配)
+  template <typename Factory>
+  SharedPtr<V> GetOrCreate(const K& key, Factory&& factory) {
+    return core_->GetOrCreate(core_, key, std::forward<Factory>(factory));
+  }
+
+  // 只查找,不构建;未命中或已过期返回空
+  SharedPtr<V> Get(const K& key) const { return core_->Get(key); }
+
+  // 移除条目(已发出的 SharedPtr 不受影响)
+  bool Erase(const K& key) { return core_->Erase(key); }
+
+  // 当前条目数(含正在构建的条目)
+  size_t size() const { return core_->size(); }
+
+ private:
+  struct Entry {
+    std::mutex build_mutex;  // 保证同一个键只构建一次
+    WeakPtr<V> value;
+    // 当前值的控制块;为空表示正在(重新)构建,此时旧值的钩子不得删除条目
+    const detail::SpCountedBase* block = nullptr;
+  };
+
+  class Core;
+  typedef detail::SpCountedImplCacheEntry<K, V, Core> BlockType;
+
+  struct Shard {
+    std::mutex mutex;
+    std::unordered_map<K, SharedPtr<Entry>, Hash> map;
+    // 值已析构、条目尚未删除的控制块(各持有一个弱引用保活)
+    std::atomic<BlockType*> stale{nullptr};
+  };
+
+  class Core {
+   public:
+    explicit Core(size_t shard_count)
+        : shard_count_(shard_count), shards_(new Shard[shard_count]) {}
+
+    ~Core() {
+      for (size_t i = 0; i < shard_count_; ++i) {
+        ReleaseStale(shards_[i].stale.exchange(nullptr, std::memory_order_acquire));
+      }
+    }
+
+    template <typename Factory>
+    SharedPtr<V> GetOrCreate(const SharedPtr<Core>& self, const K& key,
+                             Factory&& factory) {
+      const size_t shard_index = ShardIndexFor(key);
+      Shard& shard = shards_[shard_index];
+      SharedPtr<Entry> entry;
+      {
+        ShardLock lock(&shard);
+        auto it = shard.map.find(key);
+        if (it != shard.map.end()) {
+          SharedPtr<V> value = it->second->value.lock();
+          if (value) return value;
+          entry = it->second;
+          entry->block = nullptr;
+        } else {
+          entry = my::make_shared<Entry>();
+          shard.map.emplace(key, entry);
+        }
+      }
+
+      std::lock_guard<std::mutex> build_lock(entry->build_mutex);
+      {
+        // 等锁期间可能已由其他线程构建完成
+        ShardLock lock(&shard);
+        SharedPtr<V> value = entry->value.lock();
+        if (value) return value;
+      }
+
+      SharedPtr<V> value;
+      try {
+        BlockType* block =
+            new BlockType(WeakPtr<Core>(self), key, shard_index, factory(key));
+        detail::SharedCount count(detail::sp_adopt_tag{}, block);
+        value = SharedPtr<V>(detail::sp_inplace_tag<V>{}, std::move(count));
+      } catch (...) {
+        ShardLock lock(&shard);
+        auto it = shard.map.find(key);
+        if (it != shard.map.end() && it->second == entry && !entry->block) {
+          shard.map.erase(it);
+        }
+        throw;
+      }
+
+      ShardLock lock(&shard);
+      entry->value = value;
+      entry->block = static_cast<const detail::SpCountedBase*>(
+          value.owner_key());
+      auto it = shard.map.find(key);
+      if (it == shard.map.end()) {
+        shard.map.emplace(key, entry);  // 构建期间被 Erase(),重新登记
+      }
+      return value;
+    }
+
+    SharedPtr<V> Get(const K& key) {
+      Shard& shard = shards_[ShardIndexFor(key)];
+      ShardLock lock(&shard);
+      auto it = shard.map.find(key);
+      if (it == shard.map.end()) return SharedPtr<V>();
+      return it->second->value.lock();
+    }
+
+    bool Erase(const K& key) {
+      Shard& shard = shards_[ShardIndexFor(key)];
+      ShardLock lock(&shard);
+      return shard.map.erase(key) != 0;
+    }
+
+    size_t size() {
+      size_t total = 0;
+      for (size_t i = 0; i < shard_count_; ++i) {
+        ShardLock lock(&shards_[i]);
+        total += shards_[i].map.size();
+      }
+      return total;
+    }
+
+    // 由控制块钩子调用:值已析构,登记待清理(不加锁,可在任何上下文调用)
+    void DeferPurge(BlockType* block) noexcept {
+      block->WeakAddRef();  // 保活到 SweepLocked() 处理完
+      std::atomic<BlockType*>& stale = shards_[block->shard_index()].stale;
+      BlockType* head = stale.load(std::memory_order_relaxed);
+      do {
+        block->next_stale = head;
+      } while (!stale.compare_exchange_weak(head, block, std::memory_order_release,
+                                            std::memory_order_relaxed));
+    }
+
+    // 不阻塞地删除已登记的条目:抢不到锁说明有人持锁,它解锁后会再检查
+    // (见 ShardLock),所以登记过的条目总会有线程处理。
+    // 调用方不能持有该分片锁;Dispose() 满足这一点:分片里只存 WeakPtr<V>,
+    // 持锁期间不会释放任何值的最后一个强引用。
+    void DrainStale(size_t shard_index) noexcept { DrainStale(&shards_[shard_index]); }
+
+   private:
+    // 分片锁:加锁后先删除已登记的条目,解锁后再 DrainStale() 一次,
+    // 接手持锁期间其他线程登记、却因抢不到锁而没能删除的条目
+    class ShardLock {
+     public:
+      explicit ShardLock(Shard* shard) : shard_(shard) {
+        shard_->mutex.lock();
+        SweepLocked(shard_);
+      }
+
+      ~ShardLock() {
+        shard_->mutex.unlock();
+        DrainStale(shard_);
+      }
+
+      ShardLock(const ShardLock&) = delete;
+      ShardLock& operator=(const ShardLock&) = delete;
+
+     private:
+      Shard* shard_;
+    };
+
+    size_t ShardIndexFor(const K& key) const {
+      size_t h = Hash()(key);
+      return (h ^ (h >> 16)) % shard_count_;
+    }
+
+    // 登记方是"写栈、再 try_lock",持锁方是"解锁、再读栈":两边各一个
+    // seq_cst 栅栏,保证至少一方看到对方的写入,条目不会两边都漏掉
+    static void DrainStale(Shard* shard) noexcept {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      while (shard->stale.load(std::memory_order_relaxed)) {
+        if (!shard->mutex.try_lock()) return;
+        SweepLocked(shard);
+        shard->mutex.unlock();
+      }
+    }
+
+    // 持有分片锁时调用:删除仍指向已析构值的条目
+    // 条目已被重新构建(block 不同)或已被 Erase() 时什么也不做
+    static void SweepLocked(Shard* shard) noexcept {
+      if (!shard->stale.load(std::memory_order_relaxed)) return;
+      BlockType* block = shard->stale.exchange(nullptr, std::memory_order_acquire);
+      while (block) {
+        BlockType* next = block->next_stale;
+        auto it = shard->map.find(block->key());
+        if (it != shard->map.end() && it->second->block == block) {
+          shard->map.erase(it);
+        }
+        block->WeakRelease();
+        block = next;
+      }
+    }
+
+    static void ReleaseStale(BlockType* block) noexcept {
+      while (block) {
+        BlockType* next = block->next_stale;
+        block->WeakRelease();
+        block = next;
+      }
+    }
+
+    size_t shard_count_;
+    std::unique_ptr<Shard[]> shards_;
+  };
+
+  SharedPtr<Core> core_;
+};
+
+}  // namespace my
+
+#endif  // MY_WEAK_VALUE_CACHE_H
@@ -24,6 +24,9 @@ struct sp_inplace_tag {};
 // 用于区分构造函数类型的内部标签
 struct sp_deleter_tag {};
 
+// 接管一个已构造好的控制块(它自带的那 1 个强引用归 SharedCount 所有)
+struct sp_adopt_tag {};
+
 
 class SharedCount;
 
@@ -53,6 +56,10 @@ class WeakCount {
     other.control_block_ = nullptr;
   }
 
+  // 接管调用方已经加上的 1 个弱引用,不改动计数
+  WeakCount(sp_adopt_tag, SpCountedBase* control_block) noexcept
+      : control_block_(control_block) {}
+
   ////////// 析构函数 //////////
   ~WeakCount() noexcept {
     if (control_block_) {
@@ -102,6 +109,16 @@ class WeakCount {
     return control_block_ < other.control_block_;
   }
 
+  // 控制块地址即"所有者"身份,用于基于所有权的比较与哈希
+  SpCountedBase* GetControlBlock() const noexcept { return control_block_; }
+
+  // 交出持有的那 1 个弱引用,不改动计数(sp_adopt_tag 的逆操作)
+  SpCountedBase* Detach() noexcept {
+    SpCountedBase* control_block = control_block_;
+    control_block_ = nullptr;
+    return control_block;
+  }
+
   //  友元声明
   friend class SharedCount;
   template <typename T>
@@ -146,6 +163,10 @@ class SharedCount {
     }
 
 
+  // 接管已有控制块,不改动计数(用于自定义控制块,如 WeakValueCache)
+  SharedCount(sp_adopt_tag, SpCountedBase* control_block) noexcept
+      : control_block_(control_block) {}
+
   SharedCount(const SharedCount& other) noexcept
       : control_block_(other.control_block_) {
     if (control_block_) {
@@ -220,6 +241,15 @@ class SharedCount {
     return control_block_ < other.control_block_;
   }
 
+  SpCountedBase* GetControlBlock() const noexcept { return control_block_; }
+
+  // 交出持有的那 1 个强引用,不改动计数(sp_adopt_tag 的逆操作)
+  SpCountedBase* Detach() noexcept {
+    SpCountedBase* control_block = control_block_;
+    control_block_ = nullptr;
+    return control_block;
+  }
+
   //  友元声明
   friend class WeakCount;
   template <typename T>
@@ -2,18 +2,115 @@
 #define MY_SP_COUNTED_BASE_HPP_
 
 #include <atomic>
+#include <cstddef>
+#include <functional>
 #include <stdint.h>
+#include <type_traits>
+#include <utility>
+
+#if defined(MY_SP_ENABLE_LIVE_REGISTRY) || \
+    defined(MY_SP_ENABLE_REFCOUNT_PROFILER) || \
+    defined(MY_SP_ENABLE_RELEASE_LATENCY_HOOK) || \
+    defined(MY_SP_ENABLE_USDT) || defined(MY_SP_ENABLE_TRACE_RING)
+#include <typeinfo>
+#endif
+
+#if defined(MY_SP_ENABLE_REFCOUNT_PROFILER) || \
+    defined(MY_SP_ENABLE_RELEASE_LATENCY_HOOK)
+#define MY_SP_RECORD_TYPE_NAME 1  // 剖析器和计时钩子报告类型名
+#endif
+
+#ifdef MY_SP_ENABLE_RELEASE_LATENCY_HOOK
+#include "my_release_latency.h"
+#endif
+
+#ifdef MY_SP_ENABLE_REFCOUNT_PROFILER
+#include "my_refcount_profiler.h"
+// 包住一次计数 RMW(见 RefcountProfileScope)
+// RELEASE 版本用于递减强引用:采样时临时钉住控制块,记录完再归还
+#define MY_SP_PROFILE_BEGIN(op) \
+  ::my::detail::RefcountProfileScope sp_profile_scope_(::my::detail::op)
+#define MY_SP_PROFILE_END() \
+  sp_profile_scope_.Finish(this, type_name_, &profiled_)
+#define MY_SP_PROFILE_BEGIN_RELEASE() \
+  ::my::detail::RefcountProfileScope sp_profile_scope_( \
+      ::my::detail::kOpRelease, &weak_count_)
+#define MY_SP_PROFILE_END_RELEASE() \
+  if (MY_SP_PROFILE_END()) WeakRelease()
+#else
+#define MY_SP_PROFILE_BEGIN(op) ((void)0)
+#define MY_SP_PROFILE_END() ((void)0)
+#define MY_SP_PROFILE_BEGIN_RELEASE() ((void)0)
+#define MY_SP_PROFILE_END_RELEASE() ((void)0)
+#endif
+
+// 循环回收器(见 my_cycle_collector.h)的释放钩子:可回收控制块在递减前
+// 登记"可能的循环根"。未定义 MY_SP_ENABLE_CYCLE_COLLECTOR 时不产生代码,
+// Release() 不为回收器多读一次 listeners_
+#ifdef MY_SP_ENABLE_CYCLE_COLLECTOR
+#define MY_SP_COLLECTABLE_RELEASE_HOOK()                               \
+  do {                                                                 \
+    if (listeners_.load(std::memory_order_relaxed) & kCollectableFlag) \
+      OnCollectableRelease();                                          \
+  } while (0)
+#else
+#define MY_SP_COLLECTABLE_RELEASE_HOOK() ((void)0)
+#endif
+
+// 生命周期跟踪点(见 my_lifecycle_trace.h):probe 是 USDT 探针名,
+// event 是环形缓冲的事件类型,value 是事件值;都未启用时不产生代码
+#if defined(MY_SP_ENABLE_USDT) || defined(MY_SP_ENABLE_TRACE_RING)
+#include "my_lifecycle_trace.h"
+#endif
+
+#ifdef MY_SP_ENABLE_USDT
+#include <sys/sdt.h>
+#define MY_SP_USDT(probe, value) \
+  DTRACE_PROBE2(my_sp, probe, static_cast<const void*>(this), value)
+#else
+#define MY_SP_USDT(probe, value) ((void)0)
+#endif
+
+#ifdef MY_SP_ENABLE_TRACE_RING
+#define MY_SP_TRACE_RING(event, value) \
+  ::my::detail::TraceAppend(::my::event, this, value)
+#else
+#define MY_SP_TRACE_RING(event, value) ((void)0)
+#endif
+
+#define MY_SP_TRACE(probe, event, value) \
+  do {                                   \
+    MY_SP_USDT(probe, value);            \
+    MY_SP_TRACE_RING(event, value);      \
+  } while (0)
 
 namespace my {
 namespace detail {
 
+class SpCountedBase;
+
+#ifdef MY_SP_ENABLE_LIVE_REGISTRY
+// 定义见 my_live_registry.h(本文件末尾包含)
+bool LiveRegistryTrack(const SpCountedBase* block, const char* type_name,
+                       size_t payload_size) noexcept;
+void LiveRegistryUntrack(const SpCountedBase* block) noexcept;
+#endif
+
+// 被管理对象的大小;void 和不完整类型(如自定义删除器管理的句柄)记为 0
+template <typename T, typename = void>
+struct SpPayloadSize : std::integral_constant<size_t, 0> {};
+
+template <typename T>
+struct SpPayloadSize<T, decltype(void(sizeof(T)))>
+    : std::integral_constant<size_t, sizeof(T)> {};
+
 // ============================================================================
 // 辅助函数:原子操作的封装(参考 Boost 实现)
 // ============================================================================
 
-// 原子递增
-inline void AtomicIncrement(std::atomic<int64_t>* counter) noexcept {
-  counter->fetch_add(1, std::memory_order_relaxed);
+// 原子递增 返回变化前的值
+inline int64_t AtomicIncrement(std::atomic<int64_t>* counter) noexcept {
+  return counter->fetch_add(1, std::memory_order_relaxed);
   // relaxed:只需保证原子性,不需要内存同步
 }
 
@@ -26,28 +123,134 @@ inline int64_t AtomicDecrement(std::atomic<int64_t>* counter) noexcept {
   // 这样才能安全删除对象!
 }
 
-// 条件递增:如果当前值非 0,则 +1
-// 返回递增前的值(如果是 0 则返回 0)
-inline int64_t AtomicConditionalIncrement(
-    std::atomic<int64_t>* counter) noexcept {
-  // 等价于:
-  // long r = *pw;
-  // if (r != 0) ++*pw;
-  // return r;
+// 强引用计数的"死亡"标记位(sticky-zero)
+// 计数归零的线程通过 CAS(0 -> kDeadFlag) 宣告对象死亡,此后该位永不清除。
+// 这样 lock() 可以用无条件的 fetch_add 代替 CAS 重试循环:
+// 只要看到标记位就说明对象已死,多加的那一点计数落在标记位之下,不影响判断。
+constexpr int64_t kDeadFlag = int64_t(1) << 62;
+
+// 读者代为宣告死亡的标记
+// Release() 递减到 0 之后、CAS 之前有一个窗口期。窗口期内看到 0 的读者
+// (use_count() / expired())不能直接报告"已死",否则随后的 lock() 仍可能
+// 复活对象,expired() == true 就不再是永久的。读者改为自己尝试
+// CAS(0 -> kDeadFlag | kHelpedFlag):成功则对象从此刻起确实已死;
+// 递减线程的 CAS 随之失败,看到 kHelpedFlag 后用 exchange 取走它,
+// 取到的线程负责 Dispose()。
+constexpr int64_t kHelpedFlag = int64_t(1) << 61;
 
-  int64_t expected_count = counter->load(std::memory_order_relaxed);
-  for (;;) {
-    if (expected_count == 0) return expected_count; // 已经是0则无法增加
+// lock() 用的递增:无条件 +1,返回递增前的值(不再需要 compare_exchange 循环)
+// 是否成功由调用方根据旧值判断:
+// - 含 kDeadFlag:对象已死,本次失败;多加的 1 落在标记位之下,无需撤销
+// - 等于 0:Release() 已递减到 0 但尚未写入死亡标记,本线程复活了对象
+// - 其他:普通的成功
+inline int64_t AtomicIncrementForLock(
+    std::atomic<int64_t>* counter) noexcept {
+  return counter->fetch_add(1, std::memory_order_acq_rel);
+  // acq_rel:复活时要看到递减线程此前对对象的全部写入
+}
 
-    if (counter->compare_exchange_weak(expected_count, expected_count + 1,
-                                       std::memory_order_relaxed,
+// 递减后计数为 0 时调用:尝试宣告对象死亡,返回本线程是否负责 Dispose()
+// - CAS 成功:本线程宣告了死亡
+// - 读者已代为宣告(kHelpedFlag):exchange 取走标记的线程负责
+// - 其他失败:窗口期内有 lock() 复活了对象,释放责任转移给复活后的强引用组
+inline bool AtomicMarkDead(std::atomic<int64_t>* counter) noexcept {
+  int64_t expected_count = 0;
+  if (counter->compare_exchange_strong(expected_count, kDeadFlag,
+                                       std::memory_order_acq_rel,
                                        std::memory_order_relaxed)) {
-      return expected_count; // 返回旧值
-    }
+    return true;
   }
+  // 复活后又归零的对象可能有两个线程走到这里,exchange 保证只有一个取到标记
+  return (expected_count & kHelpedFlag) != 0 &&
+         (counter->exchange(kDeadFlag, std::memory_order_acq_rel) & kHelpedFlag) != 0;
+}
+
+// 读取强引用计数,已死亡时返回 0
+// 看到 0(窗口期)时代为宣告死亡,保证返回 0 之后 lock() 不会再成功
+inline int64_t AtomicLoadHelpingDeath(std::atomic<int64_t>* counter) noexcept {
+  int64_t count = counter->load(std::memory_order_acquire);
+  if (count == 0 &&
+      counter->compare_exchange_strong(count, kDeadFlag | kHelpedFlag,
+                                       std::memory_order_acq_rel,
+                                       std::memory_order_acquire)) {
+    return 0;
+  }
+  // CAS 失败时 count 是最新值:被复活(> 0)或已死亡
+  return (count & kDeadFlag) ? 0 : count;  // 死亡后失败的 lock() 会留下残余计数
+}
+
+// 所有者(控制块地址)哈希
+// 控制块至少按 16 字节对齐,先移掉恒为 0 的低位,避免 2 的幂桶数的表聚集
+inline size_t OwnerHashOf(const void* owner) noexcept {
+  return std::hash<uintptr_t>()(reinterpret_cast<uintptr_t>(owner) >> 4);
+}
+
+// 预取控制块(计数就在开头的缓存行里),准备写入
+// 批量操作(见 my_bulk_ref.h)在处理当前元素时预取后面元素的控制块,
+// 让一串互不相关的缓存缺失重叠起来;空指针和不支持的编译器上什么也不做
+inline void PrefetchControlBlock(const SpCountedBase* control_block) noexcept {
+#if defined(__GNUC__)
+  if (control_block) __builtin_prefetch(control_block, 1, 3);
+#else
+  (void)control_block;
+#endif
+}
+
+// 只读的版本(例如只检查是否过期):不必取得缓存行的独占权
+inline void PrefetchControlBlockForRead(const SpCountedBase* control_block) noexcept {
+#if defined(__GNUC__)
+  if (control_block) __builtin_prefetch(control_block, 0, 3);
+#else
+  (void)control_block;
+#endif
 }
 
+// ============================================================================
+// ExpiryListener: 过期监听器节点
+// ============================================================================
+// 挂在控制块上的单链表节点,在 Dispose() 之后被调用。
+// 未被取消的节点随控制块一起释放(见 ~SpCountedBase),因此持有弱引用的一方
+// 可以随时安全地 Cancel();被取消的节点在下次注册监听器时摘除并释放。
+// 按 16 字节对齐:链表头的低 4 位用作状态位。
+
+class alignas(16) ExpiryListener {
+ public:
+  ExpiryListener() noexcept : next_(nullptr), claimed_(false) {}
+
+  virtual ~ExpiryListener() noexcept = default;
+
+  // 执行回调(不得抛出异常)
+  virtual void Invoke() noexcept = 0;
+
+  // 认领节点:返回 true 表示本次调用者获得了"决定权"
+  // Cancel() 与触发都走这里,二者恰好只有一个成功
+  bool Claim() noexcept {
+    return !claimed_.exchange(true, std::memory_order_acq_rel);
+  }
+
+  bool IsClaimed() const noexcept {
+    return claimed_.load(std::memory_order_acquire);
+  }
+
+  ExpiryListener* next_;
+
+ private:
+  std::atomic<bool> claimed_;
+
+  ExpiryListener(const ExpiryListener&) = delete;
+  ExpiryListener& operator=(const ExpiryListener&) = delete;
+};
 
+template <typename F>
+class ExpiryListenerImpl : public ExpiryListener {
+ private:
+  F callback_;
+
+ public:
+  explicit ExpiryListenerImpl(F callback) : callback_(std::move(callback)) {}
+
+  void Invoke() noexcept override { callback_(); }
+};
 
 // ============================================================================
 // SpCountedBase: 引用计数控制块的抽象基类
@@ -57,9 +260,23 @@ inline int64_t AtomicConditionalIncrement(
 
 class SpCountedBase {
  public:
-  SpCountedBase() : use_count_(1), weak_count_(1) {}
+  SpCountedBase() : use_count_(1), weak_count_(1), listeners_(0) {}
 
-  virtual ~SpCountedBase() noexcept = default;
+  virtual ~SpCountedBase() noexcept {
+#ifdef MY_SP_ENABLE_LIVE_REGISTRY
+    if (tracked_) LiveRegistryUntrack(this);
+#endif
+#ifdef MY_SP_ENABLE_REFCOUNT_PROFILER
+    if (profiled_.load(std::memory_order_relaxed)) RefcountProfileRetire(this);
+#endif
+    uintptr_t head = listeners_.load(std::memory_order_acquire);
+    ExpiryListener* node = reinterpret_cast<ExpiryListener*>(head & ~kFlagMask);
+    while (node) {
+      ExpiryListener* next = node->next_;
+      delete node;
+      node = next;
+    }
+  }
 
   // 释放被管理对象 (use_count_ 变为 0 时调用)
   virtual void Dispose() noexcept = 0;
@@ -69,43 +286,274 @@ class SpCountedBase {
 
   // 强引用计数操作
   void AddRefCopy() noexcept {
-    AtomicIncrement(&use_count_);
+    MY_SP_PROFILE_BEGIN(kOpAddRefCopy);
+    int64_t old_count = AtomicIncrement(&use_count_);
+    MY_SP_PROFILE_END();
+    (void)old_count;
+    MY_SP_TRACE(copy, kTraceCopy, old_count + 1);
   }
   
-  // 条件增加引用计数(用于 weak_ptr::lock)
+  // 对象未死亡时增加引用计数(用于 weak_ptr::lock),返回是否成功
+  // 调用方必须持有弱引用,保证控制块内存在调用期间有效
   bool AddRefLock() noexcept {
-    return AtomicConditionalIncrement(&use_count_) != 0;
+    MY_SP_PROFILE_BEGIN(kOpAddRefLock);
+    int64_t old_count = AtomicIncrementForLock(&use_count_);
+    MY_SP_PROFILE_END();
+    if (old_count & kDeadFlag) {
+      MY_SP_TRACE(weak_lock_failed, kTraceWeakLockFailed, 0);
+      return false;
+    }
+    MY_SP_TRACE(weak_lock, kTraceWeakLock, old_count + 1);
+    if (old_count == 0) {
+      // 复活:为新的强引用组补上它隐含持有的那个弱引用。
+      // 递减到 0 的线程仍持有旧组的弱引用,要等它的 CAS 结束才会归还,
+      // 所以即使复活后的对象很快再次死亡,控制块也不会在它 CAS 之前被释放
+      WeakAddRef();
+    }
+    return true;
   }
 
   void Release() noexcept {
-    if (AtomicDecrement(&use_count_) == 1) {
-      Dispose();
-      WeakRelease();
+    MY_SP_COLLECTABLE_RELEASE_HOOK();
+    MY_SP_PROFILE_BEGIN_RELEASE();
+    int64_t old_count = AtomicDecrement(&use_count_);
+    MY_SP_PROFILE_END_RELEASE();
+    MY_SP_TRACE(release, kTraceRelease, old_count - 1);
+    if (old_count == 1) {
+      ReleaseLast();
+    }
+  }
+
+  // 批量版本(见 my_bulk_ref.h):一次原子操作加上 / 归还 n 个强引用,n >= 1
+  // AddRefCopyN 的调用方必须已持有一个强引用;两者在剖析器里都只算一次操作。
+  // 跟踪工具按事件重建所有者数,所以启用跟踪时仍然逐个记录。
+  void AddRefCopyN(int64_t n) noexcept {
+    MY_SP_PROFILE_BEGIN(kOpAddRefCopy);
+    int64_t old_count = use_count_.fetch_add(n, std::memory_order_relaxed);
+    MY_SP_PROFILE_END();
+    (void)old_count;
+#if defined(MY_SP_ENABLE_USDT) || defined(MY_SP_ENABLE_TRACE_RING)
+    for (int64_t i = 1; i <= n; ++i) MY_SP_TRACE(copy, kTraceCopy, old_count + i);
+#endif
+  }
+
+  void ReleaseN(int64_t n) noexcept {
+    MY_SP_COLLECTABLE_RELEASE_HOOK();
+    MY_SP_PROFILE_BEGIN_RELEASE();
+    int64_t old_count = use_count_.fetch_sub(n, std::memory_order_acq_rel);
+    MY_SP_PROFILE_END_RELEASE();
+#if defined(MY_SP_ENABLE_USDT) || defined(MY_SP_ENABLE_TRACE_RING)
+    for (int64_t i = 1; i <= n; ++i) MY_SP_TRACE(release, kTraceRelease, old_count - i);
+#endif
+    if (old_count == n) {
+      ReleaseLast();
     }
   }
 
   // 弱引用计数操作
   void WeakAddRef() noexcept {
+    MY_SP_PROFILE_BEGIN(kOpWeakAddRef);
     AtomicIncrement(&weak_count_);
+    MY_SP_PROFILE_END();
   }
 
   void WeakRelease() noexcept {
     if (AtomicDecrement(&weak_count_) == 1) {
+      MY_SP_TRACE(destroy, kTraceDestroy, 0);
       Destroy();
     }
   }
 
+  // 丢弃一个从未交出过引用的控制块:不 Dispose 对象(对象另有归属),
+  // 只释放控制块本身。与 WeakRelease() 一样记录 destroy,
+  // 跟踪工具才能看到构造时那条 create 的结局
+  void DestroyUnshared() noexcept {
+    MY_SP_TRACE(destroy, kTraceDestroy, 0);
+    Destroy();
+  }
+
+  // 过期监听器(无锁压栈)
+  // 返回 false 表示监听器已经触发过,节点未被接管,由调用方处理
+  // 调用方必须持有强引用(监听器不会在此期间触发);
+  // 此前有监听器被取消时,顺带摘除并释放这些节点
+  bool AddExpiryListener(ExpiryListener* node) noexcept {
+    uintptr_t head = listeners_.load(std::memory_order_acquire);
+    do {
+      if (head & kListenersFired) return false;
+      node->next_ = reinterpret_cast<ExpiryListener*>(head & ~kFlagMask);
+    } while (!listeners_.compare_exchange_weak(
+        head, reinterpret_cast<uintptr_t>(node) | (head & kFlagMask),
+        std::memory_order_acq_rel, std::memory_order_acquire));
+    if (head & kListenersCancelled) {
+      SweepCancelledListeners();
+    }
+    return true;
+  }
+
+  // 某个监听器被 Cancel() 认领后调用:下次注册时清理
+  void NoteExpiryListenerCancelled() noexcept {
+    listeners_.fetch_or(kListenersCancelled, std::memory_order_release);
+  }
+
+  // 是否参与循环回收(见 my_cycle_collector.h)
+  bool IsCollectable() const noexcept {
+    return (listeners_.load(std::memory_order_relaxed) & kCollectableFlag) != 0;
+  }
+
+  // 只读地查看死亡标记:不写计数,也不代为宣告死亡
+  // 返回 false 时对象仍可能刚刚归零,以 AddRefLock() 的结果为准
+  bool IsMarkedDead() const noexcept {
+    return (use_count_.load(std::memory_order_relaxed) & kDeadFlag) != 0;
+  }
+
   // 观察器
+  // 返回 0 即对象已永久死亡(窗口期内由本次调用代为宣告,见 kHelpedFlag)
   int64_t use_count() const noexcept { 
-    return use_count_.load(std::memory_order_acquire);
-    // acquire:确保看到最新的值
+    return AtomicLoadHelpingDeath(&use_count_);
+  }
+
+  int64_t weak_count() const noexcept {
+    return weak_count_.load(std::memory_order_acquire);
   }
 
  protected:
-  std::atomic<int64_t> use_count_;   // 强引用计数 (shared_ptr)
+  // 派生控制块构造完成后调用,登记到调试注册表(MY_SP_ENABLE_LIVE_REGISTRY),
+  // 记下类型名供剖析器和计时钩子使用,并发出 create 跟踪点
+  // 都未启用时是空函数,不产生任何代码
+  template <typename T>
+  void TrackAllocation() noexcept {
+#ifdef MY_SP_RECORD_TYPE_NAME
+    type_name_ = typeid(T).name();
+#endif
+    MY_SP_TRACE(create, kTraceCreate,
+                reinterpret_cast<intptr_t>(typeid(T).name()));
+#ifdef MY_SP_ENABLE_LIVE_REGISTRY
+    tracked_ = LiveRegistryTrack(this, typeid(T).name(), SpPayloadSize<T>::value);
+#endif
+  }
+
+  mutable std::atomic<int64_t> use_count_;  // 强引用计数 (shared_ptr);读者可能代为宣告死亡
   std::atomic<int64_t> weak_count_;  // 弱引用计数 (weak_ptr + “强引用存在”)
 
+  // 可回收控制块在构造时调用,此后每次 Release() 先回调 OnCollectableRelease()
+  // (见 MY_SP_COLLECTABLE_RELEASE_HOOK)
+  void MarkCollectable() noexcept {
+    listeners_.fetch_or(kCollectableFlag, std::memory_order_relaxed);
+  }
+
+  // 仅可回收控制块会被调用:递减之前登记"可能的循环根"
+  virtual void OnCollectableRelease() noexcept {}
+
  private:
+  // listeners_ 低四位是状态位(节点按 16 字节对齐,不会冲突):
+  // - kListenersFired:监听器已触发,此后不再接受注册
+  // - kCollectableFlag:参与循环回收
+  // - kListenersCancelled:有被取消、尚未释放的节点
+  // - kListenersSweeping:某个线程正在清理,其他线程不再进入
+  static constexpr uintptr_t kListenersFired = 1;
+  static constexpr uintptr_t kCollectableFlag = 2;
+  static constexpr uintptr_t kListenersCancelled = 4;
+  static constexpr uintptr_t kListenersSweeping = 8;
+  static constexpr uintptr_t kFlagMask = 15;
+
+  // 强引用计数已递减到 0
+  void ReleaseLast() noexcept {
+#ifdef MY_SP_ENABLE_RELEASE_LATENCY_HOOK
+    if (ReleaseLatencyHook hook = CurrentReleaseLatencyHook()) {
+      TimedReleaseLast(hook);
+      return;
+    }
+#endif
+    DisposeIfDead();
+    WeakRelease();  // 无论是否被复活,都归还本组强引用隐含持有的弱引用
+  }
+
+  // 计数已递减到 0:宣告死亡并析构对象,返回是否由本线程析构
+  // 宣告失败说明对象在窗口期内被 lock() 复活了
+  bool DisposeIfDead() noexcept {
+    if (!AtomicMarkDead(&use_count_)) return false;
+    MY_SP_TRACE(dispose, kTraceDispose, 0);
+    Dispose();
+    // 没有监听器的控制块只多这一次判空
+    if ((listeners_.load(std::memory_order_acquire) & ~kFlagMask) != 0) {
+      FireExpiryListeners();
+    }
+    return true;
+  }
+
+#ifdef MY_SP_ENABLE_RELEASE_LATENCY_HOOK
+  // 与 Release() 的最后一步相同,另外分段计时并回调钩子
+  void TimedReleaseLast(ReleaseLatencyHook hook) noexcept {
+    ReleaseLatency sample;
+    sample.type_name = type_name_;  // WeakRelease() 之后 this 可能已释放
+    uint64_t start = ReleaseLatencyNow();
+    bool disposed = DisposeIfDead();
+    uint64_t disposed_at = ReleaseLatencyNow();
+    WeakRelease();
+    if (!disposed) return;  // 被复活:什么都没有释放
+    sample.dispose_ns = disposed_at - start;
+    sample.destroy_ns = ReleaseLatencyNow() - disposed_at;
+    hook(sample);
+  }
+#endif
+
+  // 摘除并释放被 Cancel() 认领的节点(由 AddExpiryListener 调用,持有强引用)
+  // - kListenersSweeping 保证同一时刻只有一个线程改动 next_
+  // - 并发注册只改写链表头,所以保留当前的头节点,只摘除它后面的节点;
+  //   留下的那个已取消节点在之后的清理中释放
+  void SweepCancelledListeners() noexcept {
+    uintptr_t head = listeners_.load(std::memory_order_acquire);
+    do {
+      if (!(head & kListenersCancelled) || (head & kListenersSweeping)) return;
+    } while (!listeners_.compare_exchange_weak(
+        head, (head & ~kListenersCancelled) | kListenersSweeping,
+        std::memory_order_acq_rel, std::memory_order_acquire));
+
+    ExpiryListener* first = reinterpret_cast<ExpiryListener*>(head & ~kFlagMask);
+    ExpiryListener* prev = first;
+    ExpiryListener* node = first ? first->next_ : nullptr;
+    while (node) {
+      ExpiryListener* next = node->next_;
+      if (node->IsClaimed()) {
+        prev->next_ = next;
+        delete node;
+      } else {
+        prev = node;
+      }
+      node = next;
+    }
+    if (first && first->IsClaimed()) {
+      NoteExpiryListenerCancelled();  // 留下的头节点交给之后的清理
+    }
+    listeners_.fetch_and(~kListenersSweeping, std::memory_order_release);
+  }
+
+  // 后注册的先执行(同 atexit);已被 Cancel() 的节点跳过
+  void FireExpiryListeners() noexcept {
+    uintptr_t head = listeners_.fetch_or(kListenersFired, std::memory_order_acq_rel);
+    for (ExpiryListener* node = reinterpret_cast<ExpiryListener*>(head & ~kFlagMask);
+         node != nullptr; node = node->next_) {
+      if (node->Claim()) {
+        node->Invoke();
+      }
+    }
+  }
+
+  // 过期监听器链表头(兼状态位),首次注册前为 0(不额外分配任何存储)
+  std::atomic<uintptr_t> listeners_;
+
+#ifdef MY_SP_ENABLE_LIVE_REGISTRY
+  bool tracked_ = false;  // 被采样登记过
+#endif
+
+#ifdef MY_SP_RECORD_TYPE_NAME
+  const char* type_name_ = "?";
+#endif
+
+#ifdef MY_SP_ENABLE_REFCOUNT_PROFILER
+  std::atomic<bool> profiled_{false};  // 剖析器里有它的统计
+#endif
+
   SpCountedBase(const SpCountedBase&) = delete;
   SpCountedBase& operator=(const SpCountedBase&) = delete;
 };
@@ -113,4 +561,8 @@ class SpCountedBase {
 }  // namespace detail
 }  // namespace my
 
+#ifdef MY_SP_ENABLE_LIVE_REGISTRY
+#include "my_live_registry.h"
+#endif
+
 #endif  // MY_SP_COUNTED_BASE_HPP_
@@ -1,6 +1,7 @@
 #ifndef MY_SP_COUNTED_IMPL_HPP_
 #define MY_SP_COUNTED_IMPL_HPP_
 
+#include <cstddef>      // for offsetof
 #include <new>         // for placement new
 #include <type_traits>  //  for aligned_storage
 #include <utility>      //  for forward
@@ -41,7 +42,9 @@ class SpCountedImplPointer : public SpCountedBase {
   SpCountedImplPointer& operator=(const SpCountedImplPointer&) = delete;
 
  public:
-  explicit SpCountedImplPointer(T* ptr) noexcept : SpCountedBase(), ptr_(ptr) {}
+  explicit SpCountedImplPointer(T* ptr) noexcept : SpCountedBase(), ptr_(ptr) {
+    TrackAllocation<T>();
+  }
 
   void Dispose() noexcept override { delete ptr_; }
 };
@@ -65,9 +68,13 @@ class SpCountedImplPointerDeleter : public SpCountedBase {
 
  public:
   SpCountedImplPointerDeleter(P ptr, D deleter)
-      : ptr_(ptr), deleter_(deleter) {}
+      : ptr_(ptr), deleter_(deleter) {
+    TrackAllocation<typename std::remove_pointer<P>::type>();
+  }
 
-  explicit SpCountedImplPointerDeleter(P ptr) : ptr_(ptr), deleter_() {}
+  explicit SpCountedImplPointerDeleter(P ptr) : ptr_(ptr), deleter_() {
+    TrackAllocation<typename std::remove_pointer<P>::type>();
+  }
 
   void Dispose() noexcept override { deleter_(ptr_); }
 };
@@ -100,6 +107,7 @@ class SpCountedImplPdi : public SpCountedBase {
     // 1. ::new 是 placement new
     // 2. static_cast<void*> 确保正确的地址
     // 3. Args&& + std::forward 完美转发参数
+    TrackAllocation<T>();
   }
   
   // 获取对象指针
@@ -111,6 +119,19 @@ class SpCountedImplPdi : public SpCountedBase {
   // 兼容 SharedCount::GetInplacePointer() 的命名
   T* get_pointer() noexcept { return GetPoint(); }
 
+  // storage_ 相对控制块起始地址的偏移,只取决于 T 的大小和对齐
+  // (含虚函数的类型用 offsetof 是"有条件支持",GCC/Clang 都支持,只会警告)
+  static size_t PayloadOffset() noexcept {
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winvalid-offsetof"
+#endif
+    return offsetof(SpCountedImplPdi, storage_);
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+  }
+
   // ------------------------------------------------------------------------
   // 实现虚函数
   // ------------------------------------------------------------------------
@@ -126,6 +147,16 @@ class SpCountedImplPdi : public SpCountedBase {
 
 };
 
+// 由 inplace 对象的地址反推控制块地址(into_raw / from_raw 用)
+// 只做地址运算,不解引用:ptr 不是 make_shared 的对象时结果无意义,
+// 调用方要么已经核对过,要么拿到的就是 into_raw() 交出的指针。
+// SpCountedBase 是 SpCountedImplPdi 唯一的非虚基类,位于偏移 0。
+template <typename T>
+SpCountedBase* InplaceBlockOf(T* ptr) noexcept {
+  typedef typename std::remove_cv<T>::type U;
+  char* payload = reinterpret_cast<char*>(const_cast<U*>(ptr));
+  return reinterpret_cast<SpCountedBase*>(payload - SpCountedImplPdi<U>::PayloadOffset());
+}
 
 }  // namespace detail
 }  // namespace my
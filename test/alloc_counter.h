@@ -0,0 +1,153 @@
+// alloc_counter.h
+#ifndef MY_ALLOC_COUNTER_H
+#define MY_ALLOC_COUNTER_H
+
+// ============================================================================
+// 堆分配计数:替换全局 operator new / delete
+// ============================================================================
+// 用于断言"某个操作分配了几次",例如 make_shared 必须恰好 1 次、
+// 拷贝/移动/转换必须 0 次:
+//
+//   alloc_counter::Scope scope;
+//   auto sp = my::make_shared<int>(1);
+//   assert(scope.allocations() == 1);
+//
+// 注意:替换的 operator new/delete 不能是 inline 的,
+// 本头文件只能被程序中的【一个】翻译单元包含(测试和基准程序都是单文件)。
+//
+// 计数是进程级的(宽松原子),多线程时统计所有线程之和;
+// Scope 只在被测代码和观察者之间没有其他线程分配时才精确。
+// 字节数按请求大小统计,不含 malloc 自身的对齐和头部开销。
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// Allocate/Deallocate 不能内联进替换的 operator new/delete:否则 GCC 在调用方
+// 看到 operator new 返回的指针被 free(),报 -Wmismatched-new-delete
+#if defined(__GNUC__)
+#define ALLOC_COUNTER_NOINLINE __attribute__((noinline))
+#else
+#define ALLOC_COUNTER_NOINLINE
+#endif
+
+namespace alloc_counter {
+
+struct Counts {
+    uint64_t allocations;
+    uint64_t deallocations;
+    uint64_t bytes;  // 累计请求的字节数
+};
+
+namespace detail {
+
+struct Totals {
+    std::atomic<uint64_t> allocations;
+    std::atomic<uint64_t> deallocations;
+    std::atomic<uint64_t> bytes;
+};
+
+// 常量初始化(零初始化),在任何静态构造函数调用 new 之前就可用
+inline Totals& GlobalTotals() {
+    static Totals totals;
+    return totals;
+}
+
+ALLOC_COUNTER_NOINLINE inline void* Allocate(std::size_t size) {
+    Totals& totals = GlobalTotals();
+    totals.allocations.fetch_add(1, std::memory_order_relaxed);
+    totals.bytes.fetch_add(size, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+ALLOC_COUNTER_NOINLINE inline void Deallocate(void* p) {
+    if (!p) return;
+    GlobalTotals().deallocations.fetch_add(1, std::memory_order_relaxed);
+    std::free(p);
+}
+
+}  // namespace detail
+
+inline Counts Current() {
+    detail::Totals& totals = detail::GlobalTotals();
+    Counts counts;
+    counts.allocations = totals.allocations.load(std::memory_order_relaxed);
+    counts.deallocations = totals.deallocations.load(std::memory_order_relaxed);
+    counts.bytes = totals.bytes.load(std::memory_order_relaxed);
+    return counts;
+}
+
+// 从构造开始计算增量
+class Scope {
+public:
+    Scope() : start_(Current()) {}
+
+    Counts Delta() const {
+        Counts now = Current();
+        Counts delta;
+        delta.allocations = now.allocations - start_.allocations;
+        delta.deallocations = now.deallocations - start_.deallocations;
+        delta.bytes = now.bytes - start_.bytes;
+        return delta;
+    }
+
+    uint64_t allocations() const { return Delta().allocations; }
+    uint64_t deallocations() const { return Delta().deallocations; }
+    uint64_t bytes() const { return Delta().bytes; }
+
+    void Reset() { start_ = Current(); }
+
+private:
+    Counts start_;
+};
+
+}  // namespace alloc_counter
+
+// ============================================================================
+// 替换的全局分配函数
+// ============================================================================
+
+void* operator new(std::size_t size) {
+    void* p = alloc_counter::detail::Allocate(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](std::size_t size) {
+    void* p = alloc_counter::detail::Allocate(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return alloc_counter::detail::Allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return alloc_counter::detail::Allocate(size);
+}
+
+void operator delete(void* p) noexcept { alloc_counter::detail::Deallocate(p); }
+
+void operator delete[](void* p) noexcept { alloc_counter::detail::Deallocate(p); }
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    alloc_counter::detail::Deallocate(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    alloc_counter::detail::Deallocate(p);
+}
+
+#if defined(__cpp_sized_deallocation)
+void operator delete(void* p, std::size_t) noexcept {
+    alloc_counter::detail::Deallocate(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    alloc_counter::detail::Deallocate(p);
+}
+#endif
+
+#endif  // MY_ALLOC_COUNTER_H
@@ -0,0 +1,45 @@
+// bench_alloc_counter.h
+#ifndef MY_BENCH_ALLOC_COUNTER_H
+#define MY_BENCH_ALLOC_COUNTER_H
+
+// ============================================================================
+// 堆分配采集器
+// ============================================================================
+// 给每个用例附加 allocs/op 和 bytes/op,默认启用。
+// 会替换全局 operator new/delete(见 alloc_counter.h),
+// 只能被基准程序的一个翻译单元包含。
+//
+// 计数包括多线程用例里创建工作线程本身的少量分配,
+// 按总操作数平摊后可忽略。
+
+#include "alloc_counter.h"
+#include "bench_harness.h"
+
+namespace bench {
+
+class AllocCollector : public Collector {
+public:
+    void Start() override { scope_.Reset(); }
+
+    void Stop(uint64_t ops, std::map<std::string, double>* counters) override {
+        alloc_counter::Counts delta = scope_.Delta();
+        double n = static_cast<double>(ops ? ops : 1);
+        (*counters)["allocs/op"] = delta.allocations / n;
+        (*counters)["bytes/op"] = delta.bytes / n;
+    }
+
+private:
+    alloc_counter::Scope scope_;
+};
+
+inline std::unique_ptr<Collector> MakeAllocCollector(const std::string&) {
+    return std::unique_ptr<Collector>(new AllocCollector());
+}
+
+inline void RegisterAllocCounter() {
+    RegisterCollector("allocs", MakeAllocCollector, true);
+}
+
+}  // namespace bench
+
+#endif  // MY_BENCH_ALLOC_COUNTER_H
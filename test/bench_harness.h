@@ -0,0 +1,536 @@
+// bench_harness.h
+#ifndef MY_BENCH_HARNESS_H
+#define MY_BENCH_HARNESS_H
+
+// ============================================================================
+// 基准测试框架
+// ============================================================================
+// 每个用例注册为 void(bench::State&),由框架负责:
+// - 校准迭代次数,使单次重复至少运行 --min-time-ms 毫秒
+// - 预热 --warmup 次(不计入结果),再重复 --reps 次
+// - 统计每次操作耗时的中位数、MAD(中位数绝对偏差)、最小值、均值
+// - 多线程用例:N 个线程在同一起跑线上同时执行用例体,计墙钟时间
+// - 输出人类可读的表格,以及 --json= / --csv= 指定的机器可读结果
+// - 采集器(默认启用的,或 --collect= 指定的)给每个用例附加"每次操作"的指标
+//
+// 用例体内用 bench::DoNotOptimize() 防止编译器把被测代码当作死代码删除。
+// 两次运行的 JSON 结果可以用 tools/bench_compare 做显著性比较。
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+// ============================================================================
+// 防止优化
+// ============================================================================
+
+// 让编译器认为 value 被读取(且可能被修改),从而保留产生它的计算
+template <typename T>
+inline void DoNotOptimize(T const& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+// 强制此前所有写内存操作"生效"
+inline void ClobberMemory() {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : : "memory");
+#else
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+// ============================================================================
+// State: 用例体看到的运行参数
+// ============================================================================
+
+class State {
+public:
+    State(uint64_t iterations, int threads, int thread_index)
+        : iterations_(iterations), threads_(threads), thread_index_(thread_index) {}
+
+    // 本次重复中每个线程要执行的操作次数
+    uint64_t iterations() const { return iterations_; }
+    int threads() const { return threads_; }
+    int thread_index() const { return thread_index_; }
+
+private:
+    uint64_t iterations_;
+    int threads_;
+    int thread_index_;
+};
+
+typedef std::function<void(State&)> CaseFunction;
+
+// ============================================================================
+// Case: 注册的用例
+// ============================================================================
+
+class Case {
+public:
+    Case(const std::string& name, CaseFunction fn)
+        : base_name_(name), fn_(std::move(fn)), threads_(1) {}
+
+    // 参数化:写入名字和结果文件,如 ptr=my、obj=Small
+    Case& Arg(const std::string& key, const std::string& value) {
+        args_.push_back(std::make_pair(key, value));
+        return *this;
+    }
+
+    // 同时运行用例体的线程数
+    Case& Threads(int n) {
+        threads_ = n < 1 ? 1 : n;
+        return *this;
+    }
+
+    std::string name() const {
+        std::string result = base_name_;
+        for (const auto& arg : args_) {
+            result += "/" + arg.first + "=" + arg.second;
+        }
+        if (threads_ > 1) result += "/threads=" + std::to_string(threads_);
+        return result;
+    }
+
+    const std::string& base_name() const { return base_name_; }
+    const std::vector<std::pair<std::string, std::string>>& args() const { return args_; }
+    int threads() const { return threads_; }
+
+    // 执行一次重复,返回墙钟纳秒数
+    double Run(uint64_t iterations) const {
+        typedef std::chrono::steady_clock Clock;
+        if (threads_ == 1) {
+            State state(iterations, 1, 0);
+            Clock::time_point start = Clock::now();
+            fn_(state);
+            Clock::time_point end = Clock::now();
+            return std::chrono::duration<double, std::nano>(end - start).count();
+        }
+
+        // 先创建好线程,再同时放行,线程创建不计时
+        std::atomic<int> ready(0);
+        std::atomic<bool> go(false);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads_; ++t) {
+            workers.emplace_back([this, t, iterations, &ready, &go]() {
+                State state(iterations, threads_, t);
+                ready.fetch_add(1);
+                while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+                fn_(state);
+            });
+        }
+        while (ready.load() != threads_) std::this_thread::yield();
+        Clock::time_point start = Clock::now();
+        go.store(true, std::memory_order_release);
+        for (auto& worker : workers) worker.join();
+        Clock::time_point end = Clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count();
+    }
+
+private:
+    std::string base_name_;
+    CaseFunction fn_;
+    std::vector<std::pair<std::string, std::string>> args_;
+    int threads_;
+};
+
+inline std::vector<Case>& Registry() {
+    static std::vector<Case> cases;
+    return cases;
+}
+
+inline Case& Register(const std::string& name, CaseFunction fn) {
+    Registry().push_back(Case(name, std::move(fn)));
+    return Registry().back();
+}
+
+// ============================================================================
+// Collector: 在每次计时重复前后采集附加指标(如硬件性能计数器)
+// ============================================================================
+// 通过 --collect=名字[:选项] 启用;只包住计时重复,不包括校准和预热。
+
+class Collector {
+public:
+    virtual ~Collector() {}
+
+    virtual void Start() = 0;
+
+    // ops: 本次重复的总操作数(迭代次数 × 线程数)
+    // 把"每次操作"的指标写入 counters
+    virtual void Stop(uint64_t ops, std::map<std::string, double>* counters) = 0;
+};
+
+// 工厂:参数是 --collect=名字:选项 中冒号之后的部分;返回空表示不可用
+typedef std::function<std::unique_ptr<Collector>(const std::string& options)>
+    CollectorFactory;
+
+inline std::map<std::string, CollectorFactory>& CollectorRegistry() {
+    static std::map<std::string, CollectorFactory> factories;
+    return factories;
+}
+
+// 默认启用的采集器:不需要 --collect= 也会运行
+inline std::vector<std::string>& DefaultCollectors() {
+    static std::vector<std::string> names;
+    return names;
+}
+
+inline void RegisterCollector(const std::string& name, CollectorFactory factory,
+                              bool enabled_by_default = false) {
+    CollectorRegistry()[name] = std::move(factory);
+    if (enabled_by_default) DefaultCollectors().push_back(name);
+}
+
+// ============================================================================
+// 统计
+// ============================================================================
+
+inline double Median(std::vector<double> values) {
+    if (values.empty()) return 0;
+    std::sort(values.begin(), values.end());
+    size_t n = values.size();
+    return n % 2 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+}
+
+// 中位数绝对偏差:对离群值(如被调度打断的一次重复)不敏感
+inline double MedianAbsoluteDeviation(const std::vector<double>& values) {
+    double median = Median(values);
+    std::vector<double> deviations;
+    for (double v : values) deviations.push_back(std::fabs(v - median));
+    return Median(deviations);
+}
+
+struct Result {
+    std::string name;
+    const Case* source;
+    uint64_t iterations;
+    std::vector<double> samples_ns;  // 每次重复的 ns/op
+    double median_ns;
+    double mad_ns;
+    double min_ns;
+    double mean_ns;
+    std::map<std::string, double> counters;  // 附加指标(同样取各次重复的中位数)
+};
+
+// ============================================================================
+// 运行配置
+// ============================================================================
+
+struct Config {
+    int warmup = 1;
+    int repetitions = 10;
+    double min_time_ms = 20;
+    std::string filter;     // 名字包含该子串的用例才运行
+    std::string json_path;
+    std::string csv_path;
+    std::vector<std::string> collectors;  // --collect=,可重复
+    bool list_only = false;
+};
+
+inline bool ParseFlag(const std::string& arg, const char* flag, std::string* value) {
+    std::string prefix = std::string("--") + flag + "=";
+    if (arg.compare(0, prefix.size(), prefix) != 0) return false;
+    *value = arg.substr(prefix.size());
+    return true;
+}
+
+inline bool ParseConfig(int argc, char** argv, Config* config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        std::string value;
+        if (ParseFlag(arg, "reps", &value)) {
+            config->repetitions = std::max(1, std::atoi(value.c_str()));
+        } else if (ParseFlag(arg, "warmup", &value)) {
+            config->warmup = std::max(0, std::atoi(value.c_str()));
+        } else if (ParseFlag(arg, "min-time-ms", &value)) {
+            config->min_time_ms = std::atof(value.c_str());
+        } else if (ParseFlag(arg, "filter", &value)) {
+            config->filter = value;
+        } else if (ParseFlag(arg, "json", &value)) {
+            config->json_path = value;
+        } else if (ParseFlag(arg, "csv", &value)) {
+            config->csv_path = value;
+        } else if (ParseFlag(arg, "collect", &value)) {
+            config->collectors.push_back(value);
+        } else if (arg == "--list") {
+            config->list_only = true;
+        } else {
+            std::cerr << "未知参数: " << arg << "\n"
+                      << "用法: " << argv[0]
+                      << " [--filter=子串] [--reps=10] [--warmup=1] [--min-time-ms=20]"
+                         " [--json=结果.json] [--csv=结果.csv] [--collect=perf] [--list]\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// 执行
+// ============================================================================
+
+// 倍增迭代次数直到单次重复足够长,计时器精度和循环开销才可以忽略
+inline uint64_t Calibrate(const Case& c, double min_time_ns) {
+    uint64_t iterations = 1;
+    for (;;) {
+        double elapsed = c.Run(iterations);
+        if (elapsed >= min_time_ns || iterations >= (uint64_t(1) << 32)) {
+            return iterations;
+        }
+        double scale = elapsed > 0 ? 1.4 * min_time_ns / elapsed : 10;
+        scale = std::min(10.0, std::max(2.0, scale));
+        iterations = static_cast<uint64_t>(iterations * scale);
+    }
+}
+
+inline Result RunCase(const Case& c, const Config& config,
+                      const std::vector<std::unique_ptr<Collector>>& collectors) {
+    Result result;
+    result.name = c.name();
+    result.source = &c;
+    result.iterations = Calibrate(c, config.min_time_ms * 1e6);
+
+    for (int i = 0; i < config.warmup; ++i) c.Run(result.iterations);
+    std::map<std::string, std::vector<double>> counter_samples;
+    for (int i = 0; i < config.repetitions; ++i) {
+        for (const auto& collector : collectors) collector->Start();
+        double elapsed = c.Run(result.iterations);
+        std::map<std::string, double> counters;
+        for (const auto& collector : collectors) {
+            collector->Stop(result.iterations * c.threads(), &counters);
+        }
+        result.samples_ns.push_back(elapsed / result.iterations);
+        for (const auto& counter : counters) {
+            counter_samples[counter.first].push_back(counter.second);
+        }
+    }
+    for (const auto& counter : counter_samples) {
+        result.counters[counter.first] = Median(counter.second);
+    }
+
+    result.median_ns = Median(result.samples_ns);
+    result.mad_ns = MedianAbsoluteDeviation(result.samples_ns);
+    result.min_ns = *std::min_element(result.samples_ns.begin(), result.samples_ns.end());
+    double sum = 0;
+    for (double s : result.samples_ns) sum += s;
+    result.mean_ns = sum / result.samples_ns.size();
+    return result;
+}
+
+// ============================================================================
+// 输出
+// ============================================================================
+
+inline std::string JsonEscape(const std::string& s) {
+    std::string out;
+    for (char ch : s) {
+        if (ch == '"' || ch == '\\') {
+            out += '\\';
+            out += ch;
+        } else if (static_cast<unsigned char>(ch) < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", ch);
+            out += buf;
+        } else {
+            out += ch;
+        }
+    }
+    return out;
+}
+
+inline std::string CompilerName() {
+    std::ostringstream os;
+#if defined(__clang__)
+    os << "Clang " << __clang_major__ << "." << __clang_minor__;
+#elif defined(__GNUC__)
+    os << "GCC " << __GNUC__ << "." << __GNUC_MINOR__;
+#elif defined(_MSC_VER)
+    os << "MSVC " << _MSC_VER;
+#else
+    os << "Unknown";
+#endif
+    return os.str();
+}
+
+inline bool OptimizedBuild() {
+#ifdef NDEBUG
+    return true;
+#else
+    return false;
+#endif
+}
+
+inline void WriteJson(std::ostream& os, const std::vector<Result>& results,
+                      const Config& config) {
+    std::time_t now = std::time(nullptr);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    os << std::setprecision(6);
+    os << "{\n  \"context\": {\n"
+       << "    \"date\": \"" << date << "\",\n"
+       << "    \"compiler\": \"" << JsonEscape(CompilerName()) << "\",\n"
+       << "    \"optimized\": " << (OptimizedBuild() ? "true" : "false") << ",\n"
+       << "    \"hardware_concurrency\": " << std::thread::hardware_concurrency() << ",\n"
+       << "    \"warmup\": " << config.warmup << ",\n"
+       << "    \"repetitions\": " << config.repetitions << "\n"
+       << "  },\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        os << (i ? "," : "") << "\n    {\n"
+           << "      \"name\": \"" << JsonEscape(r.name) << "\",\n"
+           << "      \"base_name\": \"" << JsonEscape(r.source->base_name()) << "\",\n"
+           << "      \"params\": {";
+        for (size_t a = 0; a < r.source->args().size(); ++a) {
+            const auto& arg = r.source->args()[a];
+            os << (a ? ", " : "") << "\"" << JsonEscape(arg.first) << "\": \""
+               << JsonEscape(arg.second) << "\"";
+        }
+        os << "},\n"
+           << "      \"threads\": " << r.source->threads() << ",\n"
+           << "      \"iterations\": " << r.iterations << ",\n"
+           << "      \"median_ns\": " << r.median_ns << ",\n"
+           << "      \"mad_ns\": " << r.mad_ns << ",\n"
+           << "      \"min_ns\": " << r.min_ns << ",\n"
+           << "      \"mean_ns\": " << r.mean_ns << ",\n"
+           << "      \"samples_ns\": [";
+        for (size_t s = 0; s < r.samples_ns.size(); ++s) {
+            os << (s ? ", " : "") << r.samples_ns[s];
+        }
+        os << "],\n      \"counters\": {";
+        size_t k = 0;
+        for (const auto& counter : r.counters) {
+            os << (k++ ? ", " : "") << "\"" << JsonEscape(counter.first)
+               << "\": " << counter.second;
+        }
+        os << "}\n    }";
+    }
+    os << "\n  ]\n}\n";
+}
+
+inline void WriteCsv(std::ostream& os, const std::vector<Result>& results) {
+    os << std::setprecision(6);
+    os << "name,threads,iterations,median_ns,mad_ns,min_ns,mean_ns,counters\n";
+    for (const Result& r : results) {
+        os << "\"" << r.name << "\"," << r.source->threads() << "," << r.iterations << ","
+           << r.median_ns << "," << r.mad_ns << "," << r.min_ns << "," << r.mean_ns << ",\"";
+        size_t k = 0;
+        for (const auto& counter : r.counters) {
+            os << (k++ ? ";" : "") << counter.first << "=" << counter.second;
+        }
+        os << "\"\n";
+    }
+}
+
+inline void PrintRow(const Result& r) {
+    double mad_pct = r.median_ns > 0 ? 100 * r.mad_ns / r.median_ns : 0;
+    std::cout << std::left << std::setw(52) << r.name << std::right
+              << std::fixed << std::setprecision(2)
+              << std::setw(12) << r.median_ns
+              << std::setw(9) << std::setprecision(1) << mad_pct << "%"
+              << std::setw(12) << std::setprecision(2) << r.min_ns
+              << std::setw(12) << r.iterations;
+    for (const auto& counter : r.counters) {
+        std::cout << "  " << counter.first << "=" << std::setprecision(2) << counter.second;
+    }
+    std::cout << "\n";
+}
+
+// 解析参数、运行匹配的用例并输出结果;返回进程退出码
+inline int RunAll(int argc, char** argv) {
+    Config config;
+    if (!ParseConfig(argc, argv, &config)) return 2;
+
+    std::vector<const Case*> selected;
+    for (const Case& c : Registry()) {
+        if (c.name().find(config.filter) != std::string::npos) selected.push_back(&c);
+    }
+    if (config.list_only) {
+        for (const Case* c : selected) std::cout << c->name() << "\n";
+        return 0;
+    }
+
+    // 默认采集器排在前面;命令行里同名的 --collect= 会带选项替换它
+    std::vector<std::string> specs;
+    for (const std::string& name : DefaultCollectors()) {
+        bool overridden = false;
+        for (const std::string& spec : config.collectors) {
+            if (spec.substr(0, spec.find(':')) == name) overridden = true;
+        }
+        if (!overridden) specs.push_back(name);
+    }
+    specs.insert(specs.end(), config.collectors.begin(), config.collectors.end());
+
+    std::vector<std::unique_ptr<Collector>> collectors;
+    for (const std::string& spec : specs) {
+        size_t colon = spec.find(':');
+        std::string name = spec.substr(0, colon);
+        std::string options = colon == std::string::npos ? "" : spec.substr(colon + 1);
+        auto it = CollectorRegistry().find(name);
+        if (it == CollectorRegistry().end()) {
+            std::cerr << "未知的采集器: " << name << "\n";
+            return 2;
+        }
+        std::unique_ptr<Collector> collector = it->second(options);
+        if (collector) collectors.push_back(std::move(collector));  // 不可用时只报告时间
+    }
+
+    std::cout << "编译器: " << CompilerName()
+              << "  优化: " << (OptimizedBuild() ? "Release" : "Debug (警告: 未启用优化!)")
+              << "  CPU: " << std::thread::hardware_concurrency()
+              << "  预热: " << config.warmup << "  重复: " << config.repetitions << "\n\n";
+    std::cout << std::left << std::setw(52) << "用例" << std::right
+              << std::setw(12) << "中位数ns/op" << std::setw(10) << "MAD"
+              << std::setw(12) << "最小ns/op" << std::setw(12) << "迭代" << "\n";
+    std::cout << std::string(98, '-') << "\n";
+
+    std::vector<Result> results;
+    for (const Case* c : selected) {
+        results.push_back(RunCase(*c, config, collectors));
+        PrintRow(results.back());
+    }
+
+    if (!config.json_path.empty()) {
+        std::ofstream out(config.json_path.c_str());
+        if (!out) {
+            std::cerr << "无法写入 " << config.json_path << "\n";
+            return 1;
+        }
+        WriteJson(out, results, config);
+    }
+    if (!config.csv_path.empty()) {
+        std::ofstream out(config.csv_path.c_str());
+        if (!out) {
+            std::cerr << "无法写入 " << config.csv_path << "\n";
+            return 1;
+        }
+        WriteCsv(out, results);
+    }
+    return 0;
+}
+
+}  // namespace bench
+
+#endif  // MY_BENCH_HARNESS_H
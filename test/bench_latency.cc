@@ -0,0 +1,314 @@
+#include "bench_harness.h"
+#include "bench_ptr_types.h"
+#include "latency_histogram.h"
+#include "my_make_shared.h"
+#include "my_weak_ptr.h"
+#include <memory>  // for std::shared_ptr
+
+// ============================================================================
+// 单次操作的延迟分布
+// ============================================================================
+// benchmark 报告的是"总时间 / 次数",一次几毫秒的停顿会被上百万次快操作摊平。
+// 这里逐次计时每个操作,记录进直方图,报告 p50 / p99 / p99.9 / max:
+//   construct   make_shared 一个小对象
+//   copy        拷贝构造
+//   release     释放最后一个强引用(析构对象 + 释放控制块)
+//   weak_lock   对存活对象 lock()
+//   teardown_*  释放一整张对象图的根:完全二叉树、长链表、宽扇出
+//
+// 单次计时用 steady_clock,开销(几十 ns)已按空区间的最小耗时扣除;
+// 纳秒级操作的 p50 因此只有参考意义,长尾和 max 才是这里要看的。
+// 生产环境抓同样的停顿见 my_release_latency.h(MY_SP_ENABLE_RELEASE_LATENCY_HOOK)。
+//
+// 用法: ./bench_latency [--samples=200000] [--teardown-reps=200] [--nodes=10000]
+//                       [--filter=子串] [--csv=latency.csv]
+
+namespace {
+
+using bench::MyPtrs;
+using bench::StdPtrs;
+
+// ============================================================================
+// 计时
+// ============================================================================
+
+typedef std::chrono::steady_clock Clock;
+
+inline uint64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               Clock::now().time_since_epoch())
+        .count();
+}
+
+// 两次相邻读时钟的最小间隔,从每个样本中扣除
+uint64_t TimerOverhead() {
+    uint64_t best = UINT64_MAX;
+    for (int i = 0; i < 10000; ++i) {
+        uint64_t start = NowNs();
+        uint64_t end = NowNs();
+        best = std::min(best, end - start);
+    }
+    return best;
+}
+
+uint64_t g_timer_overhead = 0;
+
+inline void RecordSince(uint64_t start, uint64_t end, bench::LatencyHistogram* histogram) {
+    uint64_t elapsed = end - start;
+    histogram->Record(elapsed > g_timer_overhead ? elapsed - g_timer_overhead : 0);
+}
+
+struct Options {
+    int samples = 200000;
+    int teardown_reps = 200;
+    int nodes = 10000;
+};
+
+// 每批保留的对象数:让 construct/copy 的结果活过计时区间,批满再集中释放
+const size_t kBatch = 1000;
+
+// ============================================================================
+// 单个操作
+// ============================================================================
+
+template <typename P>
+void OpConstruct(const Options& options, bench::LatencyHistogram* histogram) {
+    std::vector<typename P::template Shared<int>> batch;
+    batch.reserve(kBatch);
+    for (int i = 0; i < options.samples; ++i) {
+        uint64_t start = NowNs();
+        typename P::template Shared<int> sp = P::template Make<int>(i);
+        bench::DoNotOptimize(sp);
+        uint64_t end = NowNs();
+        RecordSince(start, end, histogram);
+        batch.push_back(std::move(sp));
+        if (batch.size() == kBatch) batch.clear();
+    }
+}
+
+template <typename P>
+void OpCopy(const Options& options, bench::LatencyHistogram* histogram) {
+    typename P::template Shared<int> source = P::template Make<int>(42);
+    std::vector<typename P::template Shared<int>> batch;
+    batch.reserve(kBatch);
+    for (int i = 0; i < options.samples; ++i) {
+        uint64_t start = NowNs();
+        typename P::template Shared<int> copy(source);
+        bench::DoNotOptimize(copy);
+        uint64_t end = NowNs();
+        RecordSince(start, end, histogram);
+        batch.push_back(std::move(copy));
+        if (batch.size() == kBatch) batch.clear();
+    }
+}
+
+template <typename P>
+void OpRelease(const Options& options, bench::LatencyHistogram* histogram) {
+    std::vector<typename P::template Shared<int>> batch(kBatch);
+    for (int done = 0; done < options.samples; done += static_cast<int>(kBatch)) {
+        for (auto& sp : batch) sp = P::template Make<int>(done);
+        for (auto& sp : batch) {
+            uint64_t start = NowNs();
+            sp = typename P::template Shared<int>();
+            uint64_t end = NowNs();
+            RecordSince(start, end, histogram);
+        }
+    }
+}
+
+template <typename P>
+void OpWeakLock(const Options& options, bench::LatencyHistogram* histogram) {
+    typename P::template Shared<int> source = P::template Make<int>(42);
+    typename P::template Weak<int> weak = source;
+    for (int i = 0; i < options.samples; ++i) {
+        uint64_t start = NowNs();
+        uint64_t end;
+        {
+            typename P::template Shared<int> locked = weak.lock();
+            bench::DoNotOptimize(locked);
+            end = NowNs();  // 不含 locked 的析构
+        }
+        RecordSince(start, end, histogram);
+    }
+}
+
+// ============================================================================
+// 对象图的整体释放
+// ============================================================================
+
+template <typename P>
+struct TreeNode {
+    typename P::template Shared<TreeNode> left;
+    typename P::template Shared<TreeNode> right;
+    int value = 0;
+};
+
+template <typename P>
+typename P::template Shared<TreeNode<P>> BuildTree(int nodes) {
+    // 按层序编号建完全二叉树
+    std::vector<typename P::template Shared<TreeNode<P>>> all;
+    all.reserve(nodes);
+    for (int i = 0; i < nodes; ++i) {
+        all.push_back(P::template Make<TreeNode<P>>());
+        all.back()->value = i;
+        if (i > 0) {
+            TreeNode<P>& parent = *all[(i - 1) / 2];
+            (i % 2 ? parent.left : parent.right) = all.back();
+        }
+    }
+    return all.empty() ? typename P::template Shared<TreeNode<P>>() : all.front();
+}
+
+template <typename P>
+struct ListNode {
+    typename P::template Shared<ListNode> next;
+    int value = 0;
+};
+
+// 注意:链表析构是递归的,nodes 太大会栈溢出(两种指针都一样)
+template <typename P>
+typename P::template Shared<ListNode<P>> BuildList(int nodes) {
+    typename P::template Shared<ListNode<P>> head;
+    for (int i = 0; i < nodes; ++i) {
+        typename P::template Shared<ListNode<P>> node = P::template Make<ListNode<P>>();
+        node->value = i;
+        node->next = std::move(head);
+        head = std::move(node);
+    }
+    return head;
+}
+
+template <typename P>
+struct FanOutNode {
+    std::vector<typename P::template Shared<int>> children;
+};
+
+template <typename P>
+typename P::template Shared<FanOutNode<P>> BuildFanOut(int nodes) {
+    typename P::template Shared<FanOutNode<P>> root = P::template Make<FanOutNode<P>>();
+    root->children.reserve(nodes);
+    for (int i = 0; i < nodes; ++i) root->children.push_back(P::template Make<int>(i));
+    return root;
+}
+
+// 构建不计时,只计根的最后一次释放
+template <typename Root, typename Build>
+void TimeTeardown(const Options& options, Build build, bench::LatencyHistogram* histogram) {
+    for (int r = 0; r < options.teardown_reps; ++r) {
+        Root root = build(options.nodes);
+        uint64_t start = NowNs();
+        root = Root();
+        uint64_t end = NowNs();
+        RecordSince(start, end, histogram);
+    }
+}
+
+template <typename P>
+void TeardownTree(const Options& options, bench::LatencyHistogram* histogram) {
+    TimeTeardown<typename P::template Shared<TreeNode<P>>>(options, BuildTree<P>, histogram);
+}
+
+template <typename P>
+void TeardownList(const Options& options, bench::LatencyHistogram* histogram) {
+    TimeTeardown<typename P::template Shared<ListNode<P>>>(options, BuildList<P>, histogram);
+}
+
+template <typename P>
+void TeardownFanOut(const Options& options, bench::LatencyHistogram* histogram) {
+    TimeTeardown<typename P::template Shared<FanOutNode<P>>>(options, BuildFanOut<P>, histogram);
+}
+
+// ============================================================================
+// 用例表
+// ============================================================================
+
+typedef void (*CaseFunction)(const Options&, bench::LatencyHistogram*);
+
+struct LatencyCase {
+    const char* name;
+    CaseFunction my_version;
+    CaseFunction std_version;
+};
+
+const LatencyCase kCases[] = {
+    {"construct", OpConstruct<MyPtrs>, OpConstruct<StdPtrs>},
+    {"copy", OpCopy<MyPtrs>, OpCopy<StdPtrs>},
+    {"release", OpRelease<MyPtrs>, OpRelease<StdPtrs>},
+    {"weak_lock", OpWeakLock<MyPtrs>, OpWeakLock<StdPtrs>},
+    {"teardown_tree", TeardownTree<MyPtrs>, TeardownTree<StdPtrs>},
+    {"teardown_list", TeardownList<MyPtrs>, TeardownList<StdPtrs>},
+    {"teardown_fanout", TeardownFanOut<MyPtrs>, TeardownFanOut<StdPtrs>},
+};
+
+}  // namespace
+
+// ============================================================================
+// 主函数
+// ============================================================================
+
+int main(int argc, char** argv) {
+    Options options;
+    std::string filter;
+    std::string csv_path;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        std::string value;
+        if (bench::ParseFlag(arg, "samples", &value)) {
+            options.samples = std::max(1, std::atoi(value.c_str()));
+        } else if (bench::ParseFlag(arg, "teardown-reps", &value)) {
+            options.teardown_reps = std::max(1, std::atoi(value.c_str()));
+        } else if (bench::ParseFlag(arg, "nodes", &value)) {
+            options.nodes = std::max(1, std::atoi(value.c_str()));
+        } else if (bench::ParseFlag(arg, "filter", &value)) {
+            filter = value;
+        } else if (bench::ParseFlag(arg, "csv", &value)) {
+            csv_path = value;
+        } else {
+            std::cerr << "用法: " << argv[0]
+                      << " [--samples=200000] [--teardown-reps=200] [--nodes=10000]"
+                         " [--filter=子串] [--csv=latency.csv]\n";
+            return 2;
+        }
+    }
+
+    std::ofstream csv;
+    if (!csv_path.empty()) {
+        csv.open(csv_path.c_str());
+        if (!csv) {
+            std::cerr << "无法写入 " << csv_path << "\n";
+            return 1;
+        }
+        csv << "case,ptr,count,p50_ns,p99_ns,p999_ns,max_ns,mean_ns\n";
+    }
+
+    g_timer_overhead = TimerOverhead();
+    std::cout << "编译器: " << bench::CompilerName()
+              << "  优化: " << (bench::OptimizedBuild() ? "Release" : "Debug (警告: 未启用优化!)")
+              << "  计时开销: " << g_timer_overhead << " ns(已扣除)"
+              << "  对象图节点: " << options.nodes << "\n\n";
+    std::cout << std::left << std::setw(20) << "用例" << std::setw(6) << "ptr" << std::right
+              << std::setw(10) << "次数" << std::setw(10) << "p50" << std::setw(10) << "p99"
+              << std::setw(10) << "p99.9" << std::setw(12) << "max(ns)" << "\n";
+    std::cout << std::string(78, '-') << "\n";
+
+    for (const LatencyCase& c : kCases) {
+        if (std::string(c.name).find(filter) == std::string::npos) continue;
+        for (int variant = 0; variant < 2; ++variant) {
+            const char* ptr = variant == 0 ? "std" : "my";
+            bench::LatencyHistogram histogram;
+            (variant == 0 ? c.std_version : c.my_version)(options, &histogram);
+
+            std::cout << std::left << std::setw(20) << c.name << std::setw(6) << ptr
+                      << std::right << std::setw(10) << histogram.count();
+            histogram.PrintSummary(std::cout);
+            std::cout << "\n";
+            if (csv) {
+                csv << c.name << "," << ptr << "," << histogram.count() << ","
+                    << histogram.Percentile(50) << "," << histogram.Percentile(99) << ","
+                    << histogram.Percentile(99.9) << "," << histogram.max() << ","
+                    << histogram.mean() << "\n";
+            }
+        }
+    }
+    return 0;
+}
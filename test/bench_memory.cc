@@ -0,0 +1,343 @@
+#include "bench_harness.h"
+#include "my_cycle_collector.h"
+#include "my_make_shared.h"
+#include "my_thin_shared_ptr.h"
+#include "my_weak_ptr.h"
+#include "my_weak_value_cache.h"
+#include <memory>  // for std::shared_ptr
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#include <unistd.h>
+#endif
+
+// ============================================================================
+// 内存占用报告
+// ============================================================================
+// 1. 静态 sizeof:sp_counted_impl.h 中每个控制块类(及其他控制块),
+//    与 libstdc++ 对应的控制块并列
+// 2. 每种构造方式创建 N 个对象,测量每个对象真实占用的堆字节
+//    (含分配器开销)、RSS 增量,以及 malloc_usable_size 看到的每块大小
+//
+// 用法: ./bench_memory [--count=100000] [--csv=memory.csv]
+
+namespace {
+
+struct SmallObject {
+    int value = 0;
+};
+
+struct MediumObject {
+    int data[16] = {0};  // 64 bytes
+};
+
+struct LargeObject {
+    char data[1024] = {0};  // 1KB
+};
+
+struct CollectableObject {
+    void trace(my::CycleTracer&) {}
+    int value = 0;
+};
+
+template <typename T> struct ObjectName;
+template <> struct ObjectName<SmallObject> { static const char* get() { return "Small"; } };
+template <> struct ObjectName<MediumObject> { static const char* get() { return "Medium"; } };
+template <> struct ObjectName<LargeObject> { static const char* get() { return "Large"; } };
+
+// 无状态删除器(与 lambda 一样不占空间,但可以写出类型名)
+template <typename T>
+struct FunctorDeleter {
+    void operator()(T* p) const { delete p; }
+};
+
+// ============================================================================
+// 堆与 RSS 度量
+// ============================================================================
+
+size_t HeapInUse() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    return mallinfo2().uordblks;
+#elif defined(__GLIBC__)
+    return static_cast<unsigned int>(mallinfo().uordblks);
+#else
+    return 0;
+#endif
+}
+
+size_t ResidentBytes() {
+#if defined(__linux__)
+    std::ifstream statm("/proc/self/statm");
+    size_t total_pages = 0, resident_pages = 0;
+    statm >> total_pages >> resident_pages;
+    return resident_pages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#else
+    return 0;
+#endif
+}
+
+size_t UsableSize(const void* p) {
+#if defined(__GLIBC__)
+    return p ? malloc_usable_size(const_cast<void*>(p)) : 0;
+#else
+    (void)p;
+    return 0;
+#endif
+}
+
+// ============================================================================
+// 1. 静态 sizeof
+// ============================================================================
+
+struct SizeRow {
+    std::string name;
+    size_t my_size;
+    size_t std_size;  // 0 表示无对应或不可得
+};
+
+template <typename T>
+void AddControlBlockSizes(std::vector<SizeRow>* rows) {
+    using namespace my::detail;
+    const std::string obj = ObjectName<T>::get();
+#if defined(__GLIBCXX__)
+    const __gnu_cxx::_Lock_policy kPolicy = __gnu_cxx::__default_lock_policy;
+    rows->push_back(SizeRow{"Pointer<" + obj + ">", sizeof(SpCountedImplPointer<T>),
+                            sizeof(std::_Sp_counted_ptr<T*, kPolicy>)});
+    rows->push_back(SizeRow{"PointerDeleter<" + obj + ", 无状态>",
+                            sizeof(SpCountedImplPointerDeleter<T*, FunctorDeleter<T>>),
+                            sizeof(std::_Sp_counted_deleter<T*, FunctorDeleter<T>,
+                                                            std::allocator<void>, kPolicy>)});
+    rows->push_back(SizeRow{"PointerDeleter<" + obj + ", 函数指针>",
+                            sizeof(SpCountedImplPointerDeleter<T*, void (*)(T*)>),
+                            sizeof(std::_Sp_counted_deleter<T*, void (*)(T*),
+                                                            std::allocator<void>, kPolicy>)});
+    rows->push_back(SizeRow{"Pdi<" + obj + "> (make_shared)", sizeof(SpCountedImplPdi<T>),
+                            sizeof(std::_Sp_counted_ptr_inplace<T, std::allocator<T>, kPolicy>)});
+#else
+    rows->push_back(SizeRow{"Pointer<" + obj + ">", sizeof(SpCountedImplPointer<T>), 0});
+    rows->push_back(SizeRow{"PointerDeleter<" + obj + ", 无状态>",
+                            sizeof(SpCountedImplPointerDeleter<T*, FunctorDeleter<T>>), 0});
+    rows->push_back(SizeRow{"PointerDeleter<" + obj + ", 函数指针>",
+                            sizeof(SpCountedImplPointerDeleter<T*, void (*)(T*)>), 0});
+    rows->push_back(SizeRow{"Pdi<" + obj + "> (make_shared)", sizeof(SpCountedImplPdi<T>), 0});
+#endif
+}
+
+void PrintStaticSizes() {
+    using namespace my::detail;
+    std::vector<SizeRow> rows;
+    rows.push_back(SizeRow{"SharedPtr<T>", sizeof(my::SharedPtr<int>), sizeof(std::shared_ptr<int>)});
+    rows.push_back(SizeRow{"WeakPtr<T>", sizeof(my::WeakPtr<int>), sizeof(std::weak_ptr<int>)});
+    rows.push_back(SizeRow{"ThinSharedPtr<T>", sizeof(my::ThinSharedPtr<int>), 0});
+    rows.push_back(SizeRow{"ThinWeakPtr<T>", sizeof(my::ThinWeakPtr<int>), 0});
+#if defined(__GLIBCXX__)
+    rows.push_back(SizeRow{"SpCountedBase", sizeof(SpCountedBase),
+                           sizeof(std::_Sp_counted_base<__gnu_cxx::__default_lock_policy>)});
+#else
+    rows.push_back(SizeRow{"SpCountedBase", sizeof(SpCountedBase), 0});
+#endif
+    AddControlBlockSizes<SmallObject>(&rows);
+    AddControlBlockSizes<MediumObject>(&rows);
+    AddControlBlockSizes<LargeObject>(&rows);
+    rows.push_back(SizeRow{"ImplCollectable<Small> (make_collectable)",
+                           sizeof(SpCountedImplCollectable<CollectableObject>), 0});
+    rows.push_back(SizeRow{"ExpiryListener (on_expire 节点, 不含回调)",
+                           sizeof(ExpiryListenerImpl<void (*)()>), 0});
+
+    std::cout << "==== 静态 sizeof (字节) ====\n";
+    std::cout << std::left << std::setw(48) << "类型" << std::right << std::setw(8) << "my"
+              << std::setw(8) << "std" << "\n";
+    for (const SizeRow& row : rows) {
+        std::cout << std::left << std::setw(48) << row.name << std::right << std::setw(8)
+                  << row.my_size << std::setw(8);
+        if (row.std_size) {
+            std::cout << row.std_size;
+        } else {
+            std::cout << "-";
+        }
+        std::cout << "\n";
+    }
+    std::cout << "\n";
+}
+
+// ============================================================================
+// 2. 实测占用
+// ============================================================================
+
+struct Measurement {
+    std::string path;
+    std::string ptr;
+    std::string obj;
+    double heap_per_object;   // 堆增量 / N(含分配器头部与对齐)
+    double rss_per_object;    // RSS 增量 / N(含页粒度与分配器缓存,仅供参考)
+    size_t block_usable;      // 控制块所在分配的 malloc_usable_size
+    size_t payload_usable;    // 独立分配的对象的 malloc_usable_size(0 = 与控制块同一块)
+};
+
+// 用 make() 创建 count 个持有者(SharedPtr 或只剩 WeakPtr),测量堆和 RSS 增量
+template <typename Holder, typename Make>
+Measurement Measure(size_t count, Make make) {
+    std::vector<Holder> holders;
+    holders.reserve(count);
+    size_t heap_before = HeapInUse();
+    size_t rss_before = ResidentBytes();
+    for (size_t i = 0; i < count; ++i) holders.push_back(make());
+    size_t heap_after = HeapInUse();
+    size_t rss_after = ResidentBytes();
+
+    Measurement m;
+    m.heap_per_object = (double(heap_after) - double(heap_before)) / count;
+    m.rss_per_object = (double(rss_after) - double(rss_before)) / count;
+    m.block_usable = 0;
+    m.payload_usable = 0;
+    bench::DoNotOptimize(holders.data());
+    return m;
+}
+
+template <typename T>
+void MeasureObject(size_t count, std::vector<Measurement>* out) {
+    const char* obj = ObjectName<T>::get();
+    typedef FunctorDeleter<T> Deleter;
+
+    // ---------------- my:: ----------------
+    {
+        Measurement m = Measure<my::SharedPtr<T>>(count, [] { return my::SharedPtr<T>(new T()); });
+        my::SharedPtr<T> probe(new T());
+        m.block_usable = UsableSize(my::detail::SpAccess::ControlBlock(probe));
+        m.payload_usable = UsableSize(probe.get());
+        m.path = "new"; m.ptr = "my"; m.obj = obj;
+        out->push_back(m);
+    }
+    {
+        Measurement m = Measure<my::SharedPtr<T>>(count, [] { return my::SharedPtr<T>(new T(), Deleter()); });
+        my::SharedPtr<T> probe(new T(), Deleter());
+        m.block_usable = UsableSize(my::detail::SpAccess::ControlBlock(probe));
+        m.payload_usable = UsableSize(probe.get());
+        m.path = "new+deleter"; m.ptr = "my"; m.obj = obj;
+        out->push_back(m);
+    }
+    {
+        Measurement m = Measure<my::SharedPtr<T>>(count, [] { return my::make_shared<T>(); });
+        my::SharedPtr<T> probe = my::make_shared<T>();
+        m.block_usable = UsableSize(my::detail::SpAccess::ControlBlock(probe));
+        m.path = "make_shared"; m.ptr = "my"; m.obj = obj;
+        out->push_back(m);
+    }
+    {
+        // 只剩 WeakPtr:new 路径只留下控制块,make_shared 路径整块都留着
+        Measurement m = Measure<my::WeakPtr<T>>(count, [] { return my::WeakPtr<T>(my::SharedPtr<T>(new T())); });
+        my::SharedPtr<T> probe(new T());
+        m.block_usable = UsableSize(my::detail::SpAccess::ControlBlock(probe));
+        m.path = "weak_only(new)"; m.ptr = "my"; m.obj = obj;
+        out->push_back(m);
+    }
+    {
+        Measurement m = Measure<my::WeakPtr<T>>(count, [] { return my::WeakPtr<T>(my::make_shared<T>()); });
+        my::SharedPtr<T> probe = my::make_shared<T>();
+        m.block_usable = UsableSize(my::detail::SpAccess::ControlBlock(probe));
+        m.path = "weak_only(make_shared)"; m.ptr = "my"; m.obj = obj;
+        out->push_back(m);
+    }
+
+    // ---------------- std:: ----------------
+    // 控制块地址不可得,只报告独立分配的对象大小
+    {
+        Measurement m = Measure<std::shared_ptr<T>>(count, [] { return std::shared_ptr<T>(new T()); });
+        std::shared_ptr<T> probe(new T());
+        m.payload_usable = UsableSize(probe.get());
+        m.path = "new"; m.ptr = "std"; m.obj = obj;
+        out->push_back(m);
+    }
+    {
+        Measurement m = Measure<std::shared_ptr<T>>(count, [] { return std::shared_ptr<T>(new T(), Deleter()); });
+        std::shared_ptr<T> probe(new T(), Deleter());
+        m.payload_usable = UsableSize(probe.get());
+        m.path = "new+deleter"; m.ptr = "std"; m.obj = obj;
+        out->push_back(m);
+    }
+    {
+        Measurement m = Measure<std::shared_ptr<T>>(count, [] { return std::make_shared<T>(); });
+        m.path = "make_shared"; m.ptr = "std"; m.obj = obj;
+        out->push_back(m);
+    }
+    {
+        Measurement m = Measure<std::weak_ptr<T>>(count, [] { return std::weak_ptr<T>(std::shared_ptr<T>(new T())); });
+        m.path = "weak_only(new)"; m.ptr = "std"; m.obj = obj;
+        out->push_back(m);
+    }
+    {
+        Measurement m = Measure<std::weak_ptr<T>>(count, [] { return std::weak_ptr<T>(std::make_shared<T>()); });
+        m.path = "weak_only(make_shared)"; m.ptr = "std"; m.obj = obj;
+        out->push_back(m);
+    }
+}
+
+}  // namespace
+
+// ============================================================================
+// 主函数
+// ============================================================================
+
+int main(int argc, char** argv) {
+    size_t count = 100000;
+    std::string csv_path;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        std::string value;
+        if (bench::ParseFlag(arg, "count", &value)) {
+            count = std::max<size_t>(1, std::strtoull(value.c_str(), nullptr, 10));
+        } else if (bench::ParseFlag(arg, "csv", &value)) {
+            csv_path = value;
+        } else {
+            std::cerr << "用法: " << argv[0] << " [--count=100000] [--csv=memory.csv]\n";
+            return 2;
+        }
+    }
+
+    PrintStaticSizes();
+
+    std::vector<Measurement> rows;
+    MeasureObject<SmallObject>(count, &rows);
+    MeasureObject<MediumObject>(count, &rows);
+    MeasureObject<LargeObject>(count, &rows);
+
+    std::cout << "==== 每个对象的实测占用 (N=" << count << ", 字节) ====\n";
+    std::cout << std::left << std::setw(26) << "构造方式" << std::setw(6) << "ptr"
+              << std::setw(8) << "对象" << std::right << std::setw(10) << "堆/个"
+              << std::setw(10) << "RSS/个" << std::setw(12) << "控制块块"
+              << std::setw(10) << "对象块" << "\n";
+    std::cout << std::string(82, '-') << "\n";
+    std::cout << std::fixed << std::setprecision(1);
+    for (const Measurement& m : rows) {
+        std::cout << std::left << std::setw(26) << m.path << std::setw(6) << m.ptr
+                  << std::setw(8) << m.obj << std::right << std::setw(10) << m.heap_per_object
+                  << std::setw(10) << m.rss_per_object;
+        if (m.block_usable) {
+            std::cout << std::setw(12) << m.block_usable;
+        } else {
+            std::cout << std::setw(12) << "-";
+        }
+        if (m.payload_usable) {
+            std::cout << std::setw(10) << m.payload_usable;
+        } else {
+            std::cout << std::setw(10) << "-";
+        }
+        std::cout << "\n";
+    }
+    std::cout << "\n堆/个 来自 mallinfo2 的已分配字节增量(含 malloc 头部与对齐);\n"
+                 "控制块块/对象块 是 malloc_usable_size,std:: 的控制块地址不可得。\n";
+
+    if (!csv_path.empty()) {
+        std::ofstream out(csv_path.c_str());
+        if (!out) {
+            std::cerr << "无法写入 " << csv_path << "\n";
+            return 1;
+        }
+        out << "path,ptr,obj,heap_bytes_per_object,rss_bytes_per_object,block_usable,payload_usable\n";
+        for (const Measurement& m : rows) {
+            out << m.path << "," << m.ptr << "," << m.obj << "," << m.heap_per_object << ","
+                << m.rss_per_object << "," << m.block_usable << "," << m.payload_usable << "\n";
+        }
+    }
+    return 0;
+}
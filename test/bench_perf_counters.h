@@ -0,0 +1,198 @@
+// bench_perf_counters.h
+#ifndef MY_BENCH_PERF_COUNTERS_H
+#define MY_BENCH_PERF_COUNTERS_H
+
+// ============================================================================
+// 硬件性能计数器采集器(Linux perf_event_open)
+// ============================================================================
+// 用法: ./benchmark --collect=perf
+//       ./benchmark --collect=perf:hitm=0x10d1,other=0x...   追加原始事件
+//
+// 默认事件:cycles、instructions、L1D 读缺失、LLC 缺失。
+// HITM(读到另一个核心上被修改的缓存行,即引用计数来回"乒乓")没有通用事件,
+// 需要按 CPU 型号给出原始编码 (umask << 8) | event,例如:
+//   Skylake/Cascade Lake: MEM_LOAD_L3_HIT_RETIRED.XSNP_HITM  = 0x04d2
+//   Ice Lake/Sapphire Rapids: MEM_LOAD_L3_HIT_RETIRED.XSNP_FWD = 0x04d2
+// 未提供时自动尝试 Intel 的 0x04d2;打不开就跳过。
+//
+// 计数器随线程继承,多线程用例统计所有工作线程之和(含线程创建本身的开销,
+// 按"所有线程的总操作数"平摊后可忽略)。
+// 在容器里(perf_event_paranoid 过高、seccomp 禁止该系统调用)打不开的计数器
+// 会打印一行说明后跳过;一个都打不开时只报告时间。
+
+#include "bench_harness.h"
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bench {
+
+#if defined(__linux__)
+
+class PerfCounterCollector : public Collector {
+public:
+    struct Event {
+        std::string name;   // 报告中的指标名(会加上 "/op")
+        uint32_t type;
+        uint64_t config;
+        bool optional;      // 自动尝试的事件,打不开时不提示
+    };
+
+    explicit PerfCounterCollector(const std::vector<Event>& events) {
+        for (const Event& event : events) {
+            int fd = Open(event);
+            if (fd < 0) {
+                if (!event.optional) {
+                    std::cerr << "性能计数器 " << event.name << " 不可用: "
+                              << std::strerror(errno) << "\n";
+                }
+                continue;
+            }
+            counters_.push_back(Counter{event.name, fd});
+        }
+    }
+
+    ~PerfCounterCollector() override {
+        for (const Counter& counter : counters_) close(counter.fd);
+    }
+
+    bool empty() const { return counters_.empty(); }
+
+    void Start() override {
+        for (const Counter& counter : counters_) {
+            ioctl(counter.fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(counter.fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    void Stop(uint64_t ops, std::map<std::string, double>* counters) override {
+        for (const Counter& counter : counters_) {
+            ioctl(counter.fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+        double cycles = 0, instructions = 0;
+        for (const Counter& counter : counters_) {
+            double value = 0;
+            if (!Read(counter.fd, &value)) continue;
+            (*counters)[counter.name + "/op"] = value / (ops ? ops : 1);
+            if (counter.name == "cycles") cycles = value;
+            if (counter.name == "instructions") instructions = value;
+        }
+        if (cycles > 0 && instructions > 0) (*counters)["IPC"] = instructions / cycles;
+    }
+
+    // 默认事件 + 选项里的原始事件("名字=0x编码",逗号分隔)
+    static std::vector<Event> ParseEvents(const std::string& options) {
+        std::vector<Event> events;
+        events.push_back(Event{"cycles", PERF_TYPE_HARDWARE,
+                               PERF_COUNT_HW_CPU_CYCLES, false});
+        events.push_back(Event{"instructions", PERF_TYPE_HARDWARE,
+                               PERF_COUNT_HW_INSTRUCTIONS, false});
+        events.push_back(Event{"L1D-miss", PERF_TYPE_HW_CACHE,
+                               PERF_COUNT_HW_CACHE_L1D |
+                                   (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                   (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+                               false});
+        events.push_back(Event{"LLC-miss", PERF_TYPE_HARDWARE,
+                               PERF_COUNT_HW_CACHE_MISSES, false});
+
+        bool has_hitm = false;
+        size_t pos = 0;
+        while (pos < options.size()) {
+            size_t comma = options.find(',', pos);
+            std::string item = options.substr(pos, comma == std::string::npos
+                                                        ? std::string::npos
+                                                        : comma - pos);
+            size_t eq = item.find('=');
+            if (eq != std::string::npos) {
+                std::string name = item.substr(0, eq);
+                uint64_t config = std::strtoull(item.c_str() + eq + 1, nullptr, 0);
+                events.push_back(Event{name, PERF_TYPE_RAW, config, false});
+                if (name == "hitm") has_hitm = true;
+            }
+            if (comma == std::string::npos) break;
+            pos = comma + 1;
+        }
+        if (!has_hitm && IsIntel()) {
+            events.push_back(Event{"hitm", PERF_TYPE_RAW, 0x04d2, true});
+        }
+        return events;
+    }
+
+private:
+    struct Counter {
+        std::string name;
+        int fd;
+    };
+
+    static int Open(const Event& event) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = event.type;
+        attr.config = event.config;
+        attr.disabled = 1;
+        attr.inherit = 1;        // 统计 Start() 之后创建的工作线程
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    // 计数器数量超过硬件寄存器时内核会分时复用,按运行时间比例放大
+    static bool Read(int fd, double* value) {
+        uint64_t data[3] = {0, 0, 0};  // value, time_enabled, time_running
+        if (read(fd, data, sizeof(data)) != static_cast<ssize_t>(sizeof(data))) return false;
+        if (data[2] == 0) return false;
+        *value = static_cast<double>(data[0]) * data[1] / data[2];
+        return true;
+    }
+
+    static bool IsIntel() {
+#if defined(__x86_64__) || defined(__i386__)
+        uint32_t eax = 0, ebx = 0, ecx = 0, edx = 0;
+        __asm__("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(0));
+        return ebx == 0x756e6547 && edx == 0x49656e69 && ecx == 0x6c65746e;  // GenuineIntel
+#else
+        return false;
+#endif
+    }
+
+    std::vector<Counter> counters_;
+};
+
+inline std::unique_ptr<Collector> MakePerfCounterCollector(const std::string& options) {
+    std::unique_ptr<PerfCounterCollector> collector(
+        new PerfCounterCollector(PerfCounterCollector::ParseEvents(options)));
+    if (collector->empty()) {
+        std::cerr << "没有可用的性能计数器(容器内通常需要 perf_event_paranoid <= 2"
+                     " 且允许 perf_event_open),只报告时间\n";
+        return nullptr;
+    }
+    return std::unique_ptr<Collector>(collector.release());
+}
+
+#else  // !__linux__
+
+inline std::unique_ptr<Collector> MakePerfCounterCollector(const std::string&) {
+    std::cerr << "性能计数器仅支持 Linux,只报告时间\n";
+    return nullptr;
+}
+
+#endif  // __linux__
+
+inline void RegisterPerfCounters() {
+    RegisterCollector("perf", MakePerfCounterCollector);
+}
+
+}  // namespace bench
+
+#endif  // MY_BENCH_PERF_COUNTERS_H
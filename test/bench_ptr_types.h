@@ -0,0 +1,57 @@
+// bench_ptr_types.h
+#ifndef MY_BENCH_PTR_TYPES_H
+#define MY_BENCH_PTR_TYPES_H
+
+// ============================================================================
+// 指针类型参数:同一份用例体分别实例化为 my:: 和 std:: 版本
+// ============================================================================
+// 各基准程序共用这两个策略类,保证对照双方的构造和转换方式一致。
+
+#include <memory>  // for std::shared_ptr
+#include <utility>
+
+#include "my_make_shared.h"
+#include "my_pointer_cast.h"
+#include "my_weak_ptr.h"
+
+namespace bench {
+
+struct MyPtrs {
+    static const char* name() { return "my"; }
+
+    template <typename T> using Shared = my::SharedPtr<T>;
+    template <typename T> using Weak = my::WeakPtr<T>;
+
+    template <typename T, typename... Args>
+    static Shared<T> Make(Args&&... args) {
+        return my::make_shared<T>(std::forward<Args>(args)...);
+    }
+
+    template <typename T, typename U>
+    static Shared<T> StaticCast(const Shared<U>& p) { return my::static_pointer_cast<T>(p); }
+
+    template <typename T, typename U>
+    static Shared<T> DynamicCast(const Shared<U>& p) { return my::dynamic_pointer_cast<T>(p); }
+};
+
+struct StdPtrs {
+    static const char* name() { return "std"; }
+
+    template <typename T> using Shared = std::shared_ptr<T>;
+    template <typename T> using Weak = std::weak_ptr<T>;
+
+    template <typename T, typename... Args>
+    static Shared<T> Make(Args&&... args) {
+        return std::make_shared<T>(std::forward<Args>(args)...);
+    }
+
+    template <typename T, typename U>
+    static Shared<T> StaticCast(const Shared<U>& p) { return std::static_pointer_cast<T>(p); }
+
+    template <typename T, typename U>
+    static Shared<T> DynamicCast(const Shared<U>& p) { return std::dynamic_pointer_cast<T>(p); }
+};
+
+}  // namespace bench
+
+#endif  // MY_BENCH_PTR_TYPES_H
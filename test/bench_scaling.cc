@@ -0,0 +1,303 @@
+#include "bench_harness.h"
+#include "bench_ptr_types.h"
+#include "bench_spsc_ring.h"
+#include "my_make_shared.h"
+#include "my_weak_ptr.h"
+#include <memory>  // for std::shared_ptr
+
+// ============================================================================
+// 争用扩展性矩阵
+// ============================================================================
+// 对每种共享模式 × 指针类型 × 线程数(1, 2, 4, ... hardware_concurrency)
+// 在固定时长内测吞吐量,输出 CSV 曲线:
+//   pattern,ptr,threads,mops_per_sec,ns_per_op,speedup
+// speedup 是相对同一模式、同一指针类型单线程吞吐量的倍数。
+//
+// 模式:
+//   shared    所有线程反复拷贝/释放同一个对象(一个计数被所有核心争用)
+//   disjoint  每个线程拷贝自己创建的对象(无共享)
+//   packed    对象由一个线程连续分配,控制块挤在相邻缓存行上(伪共享)
+//   handoff   生产者创建对象,经无锁队列交给消费者释放(跨线程 Release)
+//   weak_lock 所有线程对同一个 WeakPtr 反复 lock()
+//
+// 用法: ./bench_scaling [--max-threads=N] [--duration-ms=200] [--reps=3]
+//                       [--filter=子串] [--csv=curves.csv]
+
+namespace {
+
+using bench::MyPtrs;
+using bench::StdPtrs;
+
+// 每检查一次停止标志执行的操作数
+const uint64_t kBatch = 256;
+
+// ============================================================================
+// 计时运行:所有线程就绪后同时放行,duration 后通知停止
+// ============================================================================
+// setup(t) 在放行前执行(不计时),body(t, stop) 返回完成的操作数
+
+template <typename Setup, typename Body>
+double RunTimed(int threads, double duration_ms, Setup setup, Body body) {
+    typedef std::chrono::steady_clock Clock;
+    std::atomic<int> ready(0);
+    std::atomic<bool> go(false);
+    std::atomic<bool> stop(false);
+    std::vector<uint64_t> ops(threads, 0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            setup(t);
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            ops[t] = body(t, stop);
+        });
+    }
+    while (ready.load() != threads) std::this_thread::yield();
+
+    Clock::time_point start = Clock::now();
+    go.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(std::chrono::microseconds(static_cast<int64_t>(duration_ms * 1000)));
+    stop.store(true, std::memory_order_release);
+    for (auto& worker : workers) worker.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    uint64_t total = 0;
+    for (uint64_t n : ops) total += n;
+    return total / seconds;
+}
+
+// 反复拷贝 *source,直到收到停止信号
+template <typename SharedT>
+uint64_t CopyLoop(const SharedT* source, const std::atomic<bool>& stop) {
+    uint64_t ops = 0;
+    while (!stop.load(std::memory_order_relaxed)) {
+        for (uint64_t i = 0; i < kBatch; ++i) {
+            SharedT copy = *source;
+            bench::DoNotOptimize(copy);
+        }
+        ops += kBatch;
+    }
+    return ops;
+}
+
+// ============================================================================
+// 模式
+// ============================================================================
+
+template <typename P>
+double PatternShared(int threads, double duration_ms) {
+    typedef typename P::template Shared<int> SharedT;
+    SharedT source = P::template Make<int>(42);
+    return RunTimed(threads, duration_ms, [](int) {},
+                    [&source](int, const std::atomic<bool>& stop) {
+                        return CopyLoop(&source, stop);
+                    });
+}
+
+template <typename P>
+double PatternDisjoint(int threads, double duration_ms) {
+    typedef typename P::template Shared<int> SharedT;
+    std::vector<SharedT> objects(threads);
+    // 各线程自己分配,落在各自的 malloc arena / 缓存行上
+    return RunTimed(threads, duration_ms,
+                    [&objects](int t) { objects[t] = P::template Make<int>(t); },
+                    [&objects](int t, const std::atomic<bool>& stop) {
+                        SharedT local = objects[t];
+                        return CopyLoop(&local, stop);
+                    });
+}
+
+template <typename P>
+double PatternPacked(int threads, double duration_ms) {
+    typedef typename P::template Shared<int> SharedT;
+    std::vector<SharedT> objects;
+    for (int t = 0; t < threads; ++t) {
+        objects.push_back(P::template Make<int>(t));  // 连续分配,地址相邻
+    }
+    return RunTimed(threads, duration_ms, [](int) {},
+                    [&objects](int t, const std::atomic<bool>& stop) {
+                        SharedT local = objects[t];
+                        return CopyLoop(&local, stop);
+                    });
+}
+
+template <typename P>
+double PatternHandoff(int threads, double duration_ms) {
+    typedef typename P::template Shared<int> SharedT;
+    if (threads == 1) {
+        // 单线程基线:同一线程创建并释放
+        return RunTimed(1, duration_ms, [](int) {},
+                        [](int, const std::atomic<bool>& stop) {
+                            uint64_t ops = 0;
+                            while (!stop.load(std::memory_order_relaxed)) {
+                                for (uint64_t i = 0; i < kBatch; ++i) {
+                                    SharedT p = P::template Make<int>(static_cast<int>(i));
+                                    bench::DoNotOptimize(p);
+                                }
+                                ops += kBatch;
+                            }
+                            return ops;
+                        });
+    }
+
+    // 线程两两配对:偶数号生产,奇数号消费;只统计消费者释放的对象数
+    const int pairs = threads / 2;
+    std::vector<std::unique_ptr<bench::SpscRing<SharedT>>> rings;
+    std::vector<std::unique_ptr<std::atomic<bool>>> done;
+    for (int i = 0; i < pairs; ++i) {
+        rings.emplace_back(new bench::SpscRing<SharedT>());
+        done.emplace_back(new std::atomic<bool>(false));
+    }
+    return RunTimed(pairs * 2, duration_ms, [](int) {},
+                    [&rings, &done](int t, const std::atomic<bool>& stop) -> uint64_t {
+                        bench::SpscRing<SharedT>& ring = *rings[t / 2];
+                        std::atomic<bool>& producer_done = *done[t / 2];
+                        if (t % 2 == 0) {
+                            int value = 0;
+                            while (!stop.load(std::memory_order_relaxed)) {
+                                SharedT p = P::template Make<int>(value++);
+                                while (!ring.Push(std::move(p))) {
+                                    if (stop.load(std::memory_order_relaxed)) break;
+                                    std::this_thread::yield();
+                                }
+                            }
+                            producer_done.store(true, std::memory_order_release);
+                            return 0;
+                        }
+                        uint64_t ops = 0;
+                        SharedT p;
+                        for (;;) {
+                            if (ring.Pop(&p)) {
+                                p = SharedT();  // 跨线程释放
+                                ++ops;
+                            } else if (producer_done.load(std::memory_order_acquire)) {
+                                while (ring.Pop(&p)) {
+                                    p = SharedT();
+                                    ++ops;
+                                }
+                                return ops;
+                            } else {
+                                std::this_thread::yield();
+                            }
+                        }
+                    });
+}
+
+template <typename P>
+double PatternWeakLock(int threads, double duration_ms) {
+    typedef typename P::template Shared<int> SharedT;
+    typedef typename P::template Weak<int> WeakT;
+    SharedT source = P::template Make<int>(42);
+    WeakT weak = source;
+    return RunTimed(threads, duration_ms, [](int) {},
+                    [&weak](int, const std::atomic<bool>& stop) {
+                        uint64_t ops = 0;
+                        while (!stop.load(std::memory_order_relaxed)) {
+                            for (uint64_t i = 0; i < kBatch; ++i) {
+                                SharedT locked = weak.lock();
+                                bench::DoNotOptimize(locked);
+                            }
+                            ops += kBatch;
+                        }
+                        return ops;
+                    });
+}
+
+typedef double (*PatternFunction)(int threads, double duration_ms);
+
+struct Pattern {
+    const char* name;
+    PatternFunction my_version;
+    PatternFunction std_version;
+    bool needs_pairs;  // 多线程时线程数必须是偶数
+};
+
+const Pattern kPatterns[] = {
+    {"shared", PatternShared<MyPtrs>, PatternShared<StdPtrs>, false},
+    {"disjoint", PatternDisjoint<MyPtrs>, PatternDisjoint<StdPtrs>, false},
+    {"packed", PatternPacked<MyPtrs>, PatternPacked<StdPtrs>, false},
+    {"handoff", PatternHandoff<MyPtrs>, PatternHandoff<StdPtrs>, true},
+    {"weak_lock", PatternWeakLock<MyPtrs>, PatternWeakLock<StdPtrs>, false},
+};
+
+// 1, 2, 4, ... 直到 max_threads,最后补上 max_threads 本身
+std::vector<int> ThreadCounts(int max_threads) {
+    std::vector<int> counts;
+    for (int n = 1; n < max_threads; n *= 2) counts.push_back(n);
+    counts.push_back(max_threads);
+    return counts;
+}
+
+}  // namespace
+
+// ============================================================================
+// 主函数
+// ============================================================================
+
+int main(int argc, char** argv) {
+    int max_threads = static_cast<int>(std::thread::hardware_concurrency());
+    double duration_ms = 200;
+    int reps = 3;
+    std::string filter;
+    std::string csv_path;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        std::string value;
+        if (bench::ParseFlag(arg, "max-threads", &value)) {
+            max_threads = std::atoi(value.c_str());
+        } else if (bench::ParseFlag(arg, "duration-ms", &value)) {
+            duration_ms = std::atof(value.c_str());
+        } else if (bench::ParseFlag(arg, "reps", &value)) {
+            reps = std::max(1, std::atoi(value.c_str()));
+        } else if (bench::ParseFlag(arg, "filter", &value)) {
+            filter = value;
+        } else if (bench::ParseFlag(arg, "csv", &value)) {
+            csv_path = value;
+        } else {
+            std::cerr << "用法: " << argv[0]
+                      << " [--max-threads=N] [--duration-ms=200] [--reps=3]"
+                         " [--filter=子串] [--csv=curves.csv]\n";
+            return 2;
+        }
+    }
+    if (max_threads < 1) max_threads = 1;
+
+    std::ofstream file;
+    if (!csv_path.empty()) {
+        file.open(csv_path.c_str());
+        if (!file) {
+            std::cerr << "无法写入 " << csv_path << "\n";
+            return 1;
+        }
+    }
+    std::ostream& out = csv_path.empty() ? std::cout : file;
+
+    std::cerr << "编译器: " << bench::CompilerName()
+              << "  优化: " << (bench::OptimizedBuild() ? "Release" : "Debug (警告: 未启用优化!)")
+              << "  CPU: " << std::thread::hardware_concurrency()
+              << "  线程: 1.." << max_threads << "  每点 " << reps << " x "
+              << duration_ms << " ms\n";
+
+    out << "pattern,ptr,threads,mops_per_sec,ns_per_op,speedup\n";
+    out << std::fixed << std::setprecision(3);
+    for (const Pattern& pattern : kPatterns) {
+        if (std::string(pattern.name).find(filter) == std::string::npos) continue;
+        for (int variant = 0; variant < 2; ++variant) {
+            const char* ptr = variant == 0 ? "std" : "my";
+            PatternFunction run = variant == 0 ? pattern.std_version : pattern.my_version;
+            double single_thread = 0;
+            for (int threads : ThreadCounts(max_threads)) {
+                if (pattern.needs_pairs && threads > 1 && threads % 2 != 0) continue;
+                std::vector<double> samples;
+                for (int r = 0; r < reps; ++r) samples.push_back(run(threads, duration_ms));
+                double ops_per_sec = bench::Median(samples);
+                if (threads == 1) single_thread = ops_per_sec;
+                out << pattern.name << "," << ptr << "," << threads << ","
+                    << ops_per_sec / 1e6 << "," << 1e9 / ops_per_sec << ","
+                    << (single_thread > 0 ? ops_per_sec / single_thread : 0) << "\n";
+                out.flush();
+            }
+        }
+    }
+    return 0;
+}
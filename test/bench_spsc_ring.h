@@ -0,0 +1,61 @@
+// bench_spsc_ring.h
+#ifndef MY_BENCH_SPSC_RING_H
+#define MY_BENCH_SPSC_RING_H
+
+// ============================================================================
+// 单生产者单消费者环形队列(基准程序里跨线程传递对象)
+// ============================================================================
+// Push/Pop 都不阻塞:满或空时返回 false,由调用方决定让出还是重试。
+// head_ / tail_ 各占一条缓存行;C++11 的 new 不保证 64 字节对齐,
+// 所以类自带按缓存行对齐的 operator new / delete。
+
+#include <stdlib.h>  // for posix_memalign
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace bench {
+
+template <typename T>
+class SpscRing {
+public:
+    SpscRing() : head_(0), tail_(0) {}
+
+    static void* operator new(std::size_t size) {
+        void* memory = nullptr;
+        if (posix_memalign(&memory, kCacheLine, size) != 0) throw std::bad_alloc();
+        return memory;
+    }
+
+    static void operator delete(void* memory) noexcept { free(memory); }
+
+    bool Push(T&& value) {
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) == kCapacity) return false;
+        slots_[tail % kCapacity] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool Pop(T* value) {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) return false;
+        *value = std::move(slots_[head % kCapacity]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    static const uint64_t kCapacity = 1024;
+    static const std::size_t kCacheLine = 64;
+    T slots_[kCapacity];
+    alignas(kCacheLine) std::atomic<uint64_t> head_;
+    alignas(kCacheLine) std::atomic<uint64_t> tail_;
+};
+
+}  // namespace bench
+
+#endif  // MY_BENCH_SPSC_RING_H
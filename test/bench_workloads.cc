@@ -0,0 +1,358 @@
+#include "bench_alloc_counter.h"
+#include "bench_harness.h"
+#include "bench_ptr_types.h"
+#include "bench_spsc_ring.h"
+#include "my_make_shared.h"
+#include "my_weak_ptr.h"
+#include <list>
+#include <memory>  // for std::shared_ptr
+#include <mutex>
+#include <unordered_map>
+
+// ============================================================================
+// 应用形态的工作负载
+// ============================================================================
+// 微基准里的优势到了真实代码里常常消失:计数操作混在哈希、分配、
+// 缓存缺失和线程交接之间。这里每个负载都用同一份模板代码
+// 分别实例化为 my:: 和 std:: 版本:
+//   config     读多写少的配置发布:读者在锁内拷贝当前快照,写者偶尔替换
+//   cache      LRU + 弱引用索引的缓存,键按 Zipf 分布访问
+//   fanout     一条消息同时投递给 100 个订阅者,批量消费后释放
+//   tree       指针连接的二叉搜索树:插入构建、遍历、整体释放
+//   pipeline   三级流水线,消息经两个无锁队列跨线程传递
+//
+// 与 benchmark 共用框架,结果可以用 --json= 保存后交给 bench_compare。
+// 用法: ./bench_workloads [--filter=cache] [--reps=10] [--json=base.json]
+
+namespace {
+
+using bench::MyPtrs;
+using bench::StdPtrs;
+
+// 快速伪随机数(xorshift64*),不让随机数生成本身成为瓶颈
+class Random {
+public:
+    explicit Random(uint64_t seed) : state_(seed ? seed : 1) {}
+
+    uint64_t Next() {
+        state_ ^= state_ >> 12;
+        state_ ^= state_ << 25;
+        state_ ^= state_ >> 27;
+        return state_ * 2685821657736338717ULL;
+    }
+
+private:
+    uint64_t state_;
+};
+
+// ============================================================================
+// config:读多写少的配置发布
+// ============================================================================
+// 每个线程每次迭代读一次配置;0 号线程每 kPublishEvery 次迭代发布一份新配置。
+
+struct Config {
+    int version = 0;
+    int limits[16] = {0};
+    std::string name = "service";
+};
+
+template <typename P>
+class ConfigPublisher {
+public:
+    typedef typename P::template Shared<const Config> Snapshot;
+
+    ConfigPublisher() : current_(P::template Make<Config>()) {}
+
+    Snapshot Get() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return current_;
+    }
+
+    void Publish(Snapshot next) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::swap(current_, next);  // 旧快照随参数在锁外释放
+    }
+
+private:
+    mutable std::mutex mutex_;
+    Snapshot current_;
+};
+
+const uint64_t kPublishEvery = 1024;
+
+template <typename P>
+void BM_Config(bench::State& state) {
+    static ConfigPublisher<P> publisher;
+    long sum = 0;
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        if (state.thread_index() == 0 && i % kPublishEvery == 0) {
+            typename P::template Shared<Config> next = P::template Make<Config>();
+            next->version = static_cast<int>(i);
+            publisher.Publish(std::move(next));
+        }
+        typename ConfigPublisher<P>::Snapshot config = publisher.Get();
+        sum += config->version + config->limits[i % 16];
+    }
+    bench::DoNotOptimize(sum);
+}
+
+// ============================================================================
+// cache:LRU + 弱引用索引,Zipf 分布的键
+// ============================================================================
+// LRU 链表持有最近 kCacheCapacity 个值的强引用;索引只持有弱引用,
+// 被淘汰但仍被调用方持有的值还能通过 lock() 找回。
+// 未命中时"加载"一个新值(make_shared)。
+
+struct CacheValue {
+    explicit CacheValue(uint64_t k) : key(k) { payload[0] = static_cast<char>(k); }
+    uint64_t key;
+    char payload[120];
+};
+
+template <typename P>
+class LruWeakCache {
+public:
+    typedef typename P::template Shared<CacheValue> Value;
+
+    explicit LruWeakCache(size_t capacity) : capacity_(capacity) {}
+
+    Value Get(uint64_t key) {
+        auto lru_it = lru_index_.find(key);
+        if (lru_it != lru_index_.end()) {
+            lru_.splice(lru_.begin(), lru_, lru_it->second);  // 移到最前
+            return lru_.front();
+        }
+        Value value;
+        auto weak_it = weak_index_.find(key);
+        if (weak_it != weak_index_.end()) value = weak_it->second.lock();
+        if (!value) {
+            value = P::template Make<CacheValue>(key);
+            weak_index_[key] = value;
+        }
+        lru_.push_front(value);
+        lru_index_[key] = lru_.begin();
+        if (lru_.size() > capacity_) {
+            uint64_t evicted = lru_.back()->key;
+            lru_index_.erase(evicted);
+            lru_.pop_back();
+            // 没有其他持有者的值随之死亡;顺带清理它的弱索引项
+            auto dead = weak_index_.find(evicted);
+            if (dead != weak_index_.end() && dead->second.expired()) weak_index_.erase(dead);
+        }
+        return value;
+    }
+
+private:
+    size_t capacity_;
+    std::list<Value> lru_;
+    std::unordered_map<uint64_t, typename std::list<Value>::iterator> lru_index_;
+    std::unordered_map<uint64_t, typename P::template Weak<CacheValue>> weak_index_;
+};
+
+// Zipf(s) 分布的键序列,预先生成,不计入计时
+std::vector<uint64_t> ZipfKeys(size_t key_space, double s, size_t count, uint64_t seed) {
+    std::vector<double> cdf(key_space);
+    double sum = 0;
+    for (size_t k = 0; k < key_space; ++k) {
+        sum += 1.0 / std::pow(static_cast<double>(k + 1), s);
+        cdf[k] = sum;
+    }
+    Random random(seed);
+    std::vector<uint64_t> keys(count);
+    for (size_t i = 0; i < count; ++i) {
+        double u = (random.Next() >> 11) * (1.0 / 9007199254740992.0) * sum;
+        keys[i] = std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+    }
+    return keys;
+}
+
+const size_t kCacheCapacity = 1024;
+const size_t kCacheKeySpace = 100000;
+
+// 注册时就生成,避免首次校准把生成时间算进去
+const std::vector<uint64_t>& CacheKeys() {
+    static const std::vector<uint64_t> keys = ZipfKeys(kCacheKeySpace, 0.99, 1 << 16, 42);
+    return keys;
+}
+
+template <typename P>
+void BM_Cache(bench::State& state) {
+    const std::vector<uint64_t>& keys = CacheKeys();
+    static LruWeakCache<P> cache(kCacheCapacity);
+    // 调用方短暂持有最近取到的几个值,让弱索引有机会命中
+    typename LruWeakCache<P>::Value recent[8];
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        typename LruWeakCache<P>::Value value = cache.Get(keys[i % keys.size()]);
+        bench::DoNotOptimize(value->payload[0]);
+        recent[i % 8] = std::move(value);
+    }
+}
+
+// ============================================================================
+// fanout:一条消息投递给 100 个订阅者
+// ============================================================================
+// 每次迭代发布一条消息(1 次创建 + 100 次拷贝);
+// 订阅者每积攒 kFanOutBatch 条就读完并清空收件箱(100 × kFanOutBatch 次释放)。
+
+struct Message {
+    uint64_t id;
+    char body[240];
+};
+
+const int kSubscribers = 100;
+const size_t kFanOutBatch = 16;
+
+template <typename P>
+void BM_FanOut(bench::State& state) {
+    typedef typename P::template Shared<const Message> MessagePtr;
+    std::vector<std::vector<MessagePtr>> inboxes(kSubscribers);
+    for (auto& inbox : inboxes) inbox.reserve(kFanOutBatch);
+    uint64_t checksum = 0;
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        typename P::template Shared<Message> message = P::template Make<Message>();
+        message->id = i;
+        MessagePtr published = std::move(message);
+        for (auto& inbox : inboxes) inbox.push_back(published);
+        if (inboxes[0].size() == kFanOutBatch) {
+            for (auto& inbox : inboxes) {
+                for (const MessagePtr& m : inbox) checksum += m->id;
+                inbox.clear();
+            }
+        }
+    }
+    bench::DoNotOptimize(checksum);
+}
+
+// ============================================================================
+// tree:二叉搜索树的构建、遍历与释放
+// ============================================================================
+// 每次迭代:插入 kTreeNodes 个随机键(沿路径逐级拷贝 SharedPtr,
+// 就像普通业务代码那样),用显式栈中序遍历,最后释放整棵树。
+
+template <typename P>
+struct TreeNode {
+    explicit TreeNode(uint64_t k) : key(k) {}
+    uint64_t key;
+    typename P::template Shared<TreeNode> left;
+    typename P::template Shared<TreeNode> right;
+};
+
+const int kTreeNodes = 1024;
+
+template <typename P>
+void BM_Tree(bench::State& state) {
+    typedef typename P::template Shared<TreeNode<P>> NodePtr;
+    Random random(7);
+    std::vector<NodePtr> stack;
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        NodePtr root;
+        for (int n = 0; n < kTreeNodes; ++n) {
+            uint64_t key = random.Next();
+            if (!root) {
+                root = P::template Make<TreeNode<P>>(key);
+                continue;
+            }
+            NodePtr current = root;
+            for (;;) {
+                NodePtr& child = key < current->key ? current->left : current->right;
+                if (!child) {
+                    child = P::template Make<TreeNode<P>>(key);
+                    break;
+                }
+                current = child;
+            }
+        }
+
+        uint64_t visited = 0;
+        NodePtr current = root;
+        while (current || !stack.empty()) {
+            while (current) {
+                stack.push_back(current);
+                current = current->left;
+            }
+            current = std::move(stack.back());
+            stack.pop_back();
+            visited += current->key & 1;
+            current = current->right;
+        }
+        bench::DoNotOptimize(visited);
+    }  // root 离开作用域:整棵树级联释放
+}
+
+// ============================================================================
+// pipeline:三级流水线跨线程传递消息
+// ============================================================================
+// 0 号线程创建消息,1 号线程处理后转发,2 号线程消费并释放;
+// 每个线程各处理 iterations 条,报告的 ns/op 按 3 × iterations 平摊。
+
+struct Job {
+    uint64_t id = 0;
+    uint64_t stage_sum = 0;
+    char data[48];
+};
+
+template <typename P>
+void BM_Pipeline(bench::State& state) {
+    typedef typename P::template Shared<Job> JobPtr;
+    static bench::SpscRing<JobPtr> first;
+    static bench::SpscRing<JobPtr> second;
+
+    const uint64_t n = state.iterations();
+    uint64_t checksum = 0;
+    JobPtr job;
+    switch (state.thread_index()) {
+        case 0:
+            for (uint64_t i = 0; i < n; ++i) {
+                JobPtr next = P::template Make<Job>();
+                next->id = i;
+                while (!first.Push(std::move(next))) std::this_thread::yield();
+            }
+            break;
+        case 1:
+            for (uint64_t i = 0; i < n; ++i) {
+                while (!first.Pop(&job)) std::this_thread::yield();
+                job->stage_sum += job->id * 3;
+                while (!second.Push(std::move(job))) std::this_thread::yield();
+            }
+            break;
+        default:
+            for (uint64_t i = 0; i < n; ++i) {
+                while (!second.Pop(&job)) std::this_thread::yield();
+                checksum += job->stage_sum;
+                job = JobPtr();  // 在消费线程上释放
+            }
+            break;
+    }
+    bench::DoNotOptimize(checksum);
+}
+
+// ============================================================================
+// 注册
+// ============================================================================
+
+template <typename P>
+void RegisterWorkloads() {
+    const char* ptr = P::name();
+    bench::Register("config", BM_Config<P>).Arg("ptr", ptr);
+    bench::Register("config", BM_Config<P>).Arg("ptr", ptr).Threads(4);
+    bench::Register("cache", BM_Cache<P>).Arg("ptr", ptr);
+    bench::Register("fanout", BM_FanOut<P>).Arg("ptr", ptr);
+    bench::Register("tree", BM_Tree<P>).Arg("ptr", ptr);
+    bench::Register("pipeline", BM_Pipeline<P>).Arg("ptr", ptr).Threads(3);
+}
+
+}  // namespace
+
+// ============================================================================
+// 主函数
+// ============================================================================
+
+int main(int argc, char** argv) {
+    bench::RegisterAllocCounter();
+    CacheKeys();
+
+    RegisterWorkloads<StdPtrs>();
+    RegisterWorkloads<MyPtrs>();
+
+    return bench::RunAll(argc, argv);
+}
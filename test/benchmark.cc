@@ -1,33 +1,28 @@
+#include "bench_alloc_counter.h"
+#include "bench_harness.h"
+#include "bench_perf_counters.h"
+#include "bench_ptr_types.h"
+#include "my_borrowed.h"
+#include "my_bulk_ref.h"
+#include "my_bulk_weak.h"
+#include "my_lazy_shared_ptr.h"
 #include "my_make_shared.h"
+#include "my_parallel_release.h"
 #include "my_pointer_cast.h"
+#include "my_shared_ref.h"
+#include "my_thin_shared_ptr.h"
 #include "my_weak_ptr.h"
-#include <iostream>
-#include <chrono>
-#include <iomanip>
-#include <vector>
+#include <algorithm>
+#include <iterator>
 #include <memory>  // for std::shared_ptr
-#include <thread>
-
-// ============================================================================
-// Benchmark 工具
-// ============================================================================
+#include <random>
+#include <vector>
 
-class Timer {
-public:
-    Timer() : start_(std::chrono::high_resolution_clock::now()) {}
-    
-    void reset() {
-        start_ = std::chrono::high_resolution_clock::now();
-    }
-    
-    double elapsed_ms() const {
-        auto end = std::chrono::high_resolution_clock::now();
-        return std::chrono::duration<double, std::milli>(end - start_).count();
-    }
-    
-private:
-    std::chrono::high_resolution_clock::time_point start_;
-};
+// 用法见 bench_harness.h,例如:
+//   ./benchmark --filter=copy --reps=20 --json=base.json
+//   ./benchmark --filter=copy --collect=perf      附加每次操作的硬件计数
+// 每个用例默认附带 allocs/op 和 bytes/op(见 bench_alloc_counter.h)
+//   ./bench_compare base.json new.json
 
 // ============================================================================
 // 测试用类
@@ -61,453 +56,445 @@ public:
     int get_value() const override { return 42; }
 };
 
+using bench::MyPtrs;
+using bench::StdPtrs;
+
+template <typename T> struct ObjectName;
+template <> struct ObjectName<SmallObject> { static const char* get() { return "Small"; } };
+template <> struct ObjectName<MediumObject> { static const char* get() { return "Medium"; } };
+template <> struct ObjectName<LargeObject> { static const char* get() { return "Large"; } };
+
 // ============================================================================
-// Benchmark 函数
+// 用例体
 // ============================================================================
 
-void benchmark_creation_and_destruction() {
-    std::cout << "\n╔════════════════════════════════════════════════╗\n";
-    std::cout << "║  Benchmark 1: 创建与销毁性能对比              ║\n";
-    std::cout << "╚════════════════════════════════════════════════╝\n";
-    
-    constexpr int ITERATIONS = 1000000;
-    
-    std::cout << "\n[小对象 - " << ITERATIONS << " 次迭代]\n";
-    std::cout << std::string(60, '-') << "\n";
-    
-    // std::shared_ptr (new)
-    {
-        Timer timer;
-        for (int i = 0; i < ITERATIONS; ++i) {
-            std::shared_ptr<SmallObject> sp(new SmallObject(i));
-            (void)sp;
-        }
-        double elapsed = timer.elapsed_ms();
-        std::cout << "std::shared_ptr (new):       " 
-                  << std::fixed << std::setprecision(2) << std::setw(8) << elapsed << " ms\n";
+// 创建与销毁:new + 独立控制块
+template <typename P, typename Obj>
+void BM_CreateNew(bench::State& state) {
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        typename P::template Shared<Obj> sp(new Obj());
+        bench::DoNotOptimize(sp);
     }
-    
-    // std::make_shared
-    {
-        Timer timer;
-        for (int i = 0; i < ITERATIONS; ++i) {
-            auto sp = std::make_shared<SmallObject>(i);
-            (void)sp;
-        }
-        double elapsed = timer.elapsed_ms();
-        std::cout << "std::make_shared:            " 
-                  << std::fixed << std::setprecision(2) << std::setw(8) << elapsed << " ms\n";
+}
+
+// 创建与销毁:LazySharedPtr 从未共享,不分配控制块
+template <typename Obj>
+void BM_CreateLazy(bench::State& state) {
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        my::LazySharedPtr<Obj> sp(new Obj());
+        bench::DoNotOptimize(sp);
     }
-    
-    // my::shared_ptr (new)
-    {
-        Timer timer;
-        for (int i = 0; i < ITERATIONS; ++i) {
-            my::SharedPtr<SmallObject> sp(new SmallObject(i));
-            (void)sp;
-        }
-        double elapsed = timer.elapsed_ms();
-        std::cout << "my::shared_ptr (new):        " 
-                  << std::fixed << std::setprecision(2) << std::setw(8) << elapsed << " ms\n";
+}
+
+// 创建与销毁:make_shared 单次分配
+template <typename P, typename Obj>
+void BM_MakeShared(bench::State& state) {
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        typename P::template Shared<Obj> sp = P::template Make<Obj>();
+        bench::DoNotOptimize(sp);
     }
-    
-    // my::make_shared
-    {
-        Timer timer;
-        for (int i = 0; i < ITERATIONS; ++i) {
-            auto sp = my::make_shared<SmallObject>(i);
-            (void)sp;
-        }
-        double elapsed = timer.elapsed_ms();
-        std::cout << "my::make_shared:             " 
-                  << std::fixed << std::setprecision(2) << std::setw(8) << elapsed << " ms\n";
+}
+
+// 拷贝构造 + 析构;多线程时所有线程拷贝同一个源,争用同一个计数
+template <typename P>
+void BM_Copy(bench::State& state) {
+    static typename P::template Shared<SmallObject> source = P::template Make<SmallObject>(42);
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        typename P::template Shared<SmallObject> copy = source;
+        bench::DoNotOptimize(copy);
     }
-    
-    std::cout << "\n[中等对象 - " << ITERATIONS << " 次迭代]\n";
-    std::cout << std::string(60, '-') << "\n";
-    
-    // std::shared_ptr (new)
-    {
-        Timer timer;
-        for (int i = 0; i < ITERATIONS; ++i) {
-            std::shared_ptr<MediumObject> sp(new MediumObject);
-            (void)sp;
-        }
-        double elapsed = timer.elapsed_ms();
-        std::cout << "std::shared_ptr (new):       " 
-                  << std::fixed << std::setprecision(2) << std::setw(8) << elapsed << " ms\n";
+}
+
+// SharedRef:拷贝无条件 AddRefCopy、析构无条件 Release,没有空指针判断
+void BM_CopyRef(bench::State& state) {
+    static my::SharedRef<SmallObject> source = my::make_shared_ref<SmallObject>(42);
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        my::SharedRef<SmallObject> copy = source;
+        bench::DoNotOptimize(copy);
     }
-    
-    // std::make_shared
-    {
-        Timer timer;
-        for (int i = 0; i < ITERATIONS; ++i) {
-            auto sp = std::make_shared<MediumObject>();
-            (void)sp;
+}
+
+// 批量拷贝进数组再整体析构,按元素计;拷贝和析构各占一半
+const size_t kCopyBatch = 1000;
+
+template <typename Ptr>
+void RunCopyBatch(bench::State& state, const Ptr& source) {
+    std::vector<Ptr> batch;
+    batch.reserve(kCopyBatch);
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        batch.push_back(source);
+        if (batch.size() == kCopyBatch) {
+            bench::ClobberMemory();
+            batch.clear();
         }
-        double elapsed = timer.elapsed_ms();
-        std::cout << "std::make_shared:            " 
-                  << std::fixed << std::setprecision(2) << std::setw(8) << elapsed << " ms\n";
     }
-    
-    // my::shared_ptr (new)
-    {
-        Timer timer;
-        for (int i = 0; i < ITERATIONS; ++i) {
-            my::SharedPtr<MediumObject> sp(new MediumObject);
-            (void)sp;
-        }
-        double elapsed = timer.elapsed_ms();
-        std::cout << "my::shared_ptr (new):        " 
-                  << std::fixed << std::setprecision(2) << std::setw(8) << elapsed << " ms\n";
+    bench::DoNotOptimize(batch.data());
+}
+
+template <typename P>
+void BM_CopyBatch(bench::State& state) {
+    static typename P::template Shared<SmallObject> source = P::template Make<SmallObject>(42);
+    RunCopyBatch(state, source);
+}
+
+void BM_CopyBatchRef(bench::State& state) {
+    static my::SharedRef<SmallObject> source = my::make_shared_ref<SmallObject>(42);
+    RunCopyBatch(state, source);
+}
+
+// 广播:一个消息分发给 kFanOut 个订阅者再全部释放,按订阅者计
+// 多线程时所有线程广播同一个消息,争用同一个计数
+const size_t kFanOut = 64;
+
+template <typename P>
+void BM_FanOut(bench::State& state) {
+    static typename P::template Shared<SmallObject> message = P::template Make<SmallObject>(42);
+    std::vector<typename P::template Shared<SmallObject>> subscribers;
+    subscribers.reserve(kFanOut);
+    for (uint64_t i = 0; i < state.iterations(); i += kFanOut) {
+        for (size_t k = 0; k < kFanOut; ++k) subscribers.push_back(message);
+        bench::ClobberMemory();
+        subscribers.clear();
     }
-    
-    // my::make_shared
-    {
-        Timer timer;
-        for (int i = 0; i < ITERATIONS; ++i) {
-            auto sp = my::make_shared<MediumObject>();
-            (void)sp;
-        }
-        double elapsed = timer.elapsed_ms();
-        std::cout << "my::make_shared:             " 
-                  << std::fixed << std::setprecision(2) << std::setw(8) << elapsed << " ms\n";
+    bench::DoNotOptimize(subscribers.data());
+}
+
+// share_n / release_n:每批只有一次 fetch_add 和一次 fetch_sub
+void BM_FanOutBulk(bench::State& state) {
+    static my::SharedPtr<SmallObject> message = my::make_shared<SmallObject>(42);
+    std::vector<my::SharedPtr<SmallObject>> subscribers;
+    subscribers.reserve(kFanOut);
+    for (uint64_t i = 0; i < state.iterations(); i += kFanOut) {
+        my::share_n(message, kFanOut, std::back_inserter(subscribers));
+        bench::ClobberMemory();
+        my::release_n(subscribers);
     }
+    bench::DoNotOptimize(subscribers.data());
 }
 
-void benchmark_copy_operations() {
-    std::cout << "\n╔════════════════════════════════════════════════╗\n";
-    std::cout << "║  Benchmark 2: 拷贝操作性能对比                 ║\n";
-    std::cout << "╚════════════════════════════════════════════════╝\n";
-    
-    constexpr int ITERATIONS = 10000000;
-    
-    std::cout << "\n[拷贝构造 - " << ITERATIONS << " 次迭代]\n";
-    std::cout << std::string(60, '-') << "\n";
-    
-    // std::shared_ptr
-    {
-        std::shared_ptr<int> source(new int(42));
-        Timer timer;
-        
-        for (int i = 0; i < ITERATIONS; ++i) {
-            std::shared_ptr<int> copy = source;
-            (void)copy;
-        }
-        
-        double elapsed = timer.elapsed_ms();
-        std::cout << "std::shared_ptr:             " 
-                  << std::fixed << std::setprecision(2) << std::setw(8) << elapsed << " ms"
-                  << "  (" << std::fixed << std::setprecision(1) 
-                  << (elapsed / ITERATIONS * 1000000) << " ns/次)\n";
+// 解引用
+void BM_DerefRaw(bench::State& state) {
+    static int* raw = new int(42);
+    int* p = raw;
+    long sum = 0;
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        bench::DoNotOptimize(p);  // 阻止把 *p 提到循环外
+        sum += *p;
     }
-    
-    // my::shared_ptr
-    {
-        my::SharedPtr<int> source(new int(42));
-        Timer timer;
-        
-        for (int i = 0; i < ITERATIONS; ++i) {
-            my::SharedPtr<int> copy = source;
-            (void)copy;
-        }
-        
-        double elapsed = timer.elapsed_ms();
-        std::cout << "my::shared_ptr:              " 
-                  << std::fixed << std::setprecision(2) << std::setw(8) << elapsed << " ms"
-                  << "  (" << std::fixed << std::setprecision(1) 
-                  << (elapsed / ITERATIONS * 1000000) << " ns/次)\n";
+    bench::DoNotOptimize(sum);
+}
+
+template <typename P>
+void BM_Deref(bench::State& state) {
+    static typename P::template Shared<int> source = P::template Make<int>(42);
+    typename P::template Shared<int>* sp = &source;
+    long sum = 0;
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        bench::DoNotOptimize(sp);
+        sum += **sp;
     }
+    bench::DoNotOptimize(sum);
 }
 
-void benchmark_access_performance() {
-    std::cout << "\n╔════════════════════════════════════════════════╗\n";
-    std::cout << "║  Benchmark 3: 对象访问性能对比                 ║\n";
-    std::cout << "╚════════════════════════════════════════════════╝\n";
-    
-    constexpr int ITERATIONS = 100000000;
-    
-    std::cout << "\n[解引用操作 - " << ITERATIONS << " 次迭代]\n";
-    std::cout << std::string(60, '-') << "\n";
-    
-    // 原始指针(基准)
-    {
-        int* raw = new int(42);
-        Timer timer;
-        
-        long sum = 0;
-        for (int i = 0; i < ITERATIONS; ++i) {
-            sum += *raw;
-        }
-        
-        double elapsed = timer.elapsed_ms();
-        std::cout << "原始指针 (baseline):         " 
-                  << std::fixed << std::setprecision(2) << std::setw(8) << elapsed << " ms"
-                  << "  sum=" << sum << "\n";
-        delete raw;
+// weak_ptr::lock()(对象存活,总是成功)
+template <typename P>
+void BM_WeakLock(bench::State& state) {
+    static typename P::template Shared<int> source = P::template Make<int>(42);
+    static typename P::template Weak<int> weak = source;
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        typename P::template Shared<int> locked = weak.lock();
+        bench::DoNotOptimize(locked);
     }
-    
-    // std::shared_ptr
-    {
-        std::shared_ptr<int> sp(new int(42));
-        Timer timer;
-        
-        long sum = 0;
-        for (int i = 0; i < ITERATIONS; ++i) {
-            sum += *sp;
-        }
-        
-        double elapsed = timer.elapsed_ms();
-        std::cout << "std::shared_ptr:             " 
-                  << std::fixed << std::setprecision(2) << std::setw(8) << elapsed << " ms"
-                  << "  sum=" << sum << "\n";
+}
+
+template <typename P>
+void BM_StaticCast(bench::State& state) {
+    static typename P::template Shared<Derived> derived = P::template Make<Derived>();
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        typename P::template Shared<Base> base = P::template StaticCast<Base>(derived);
+        bench::DoNotOptimize(base);
     }
-    
-    // my::shared_ptr
-    {
-        my::SharedPtr<int> sp(new int(42));
-        Timer timer;
-        
-        long sum = 0;
-        for (int i = 0; i < ITERATIONS; ++i) {
-            sum += *sp;
-        }
-        
-        double elapsed = timer.elapsed_ms();
-        std::cout << "my::shared_ptr:              " 
-                  << std::fixed << std::setprecision(2) << std::setw(8) << elapsed << " ms"
-                  << "  sum=" << sum << "\n";
+}
+
+template <typename P>
+void BM_DynamicCast(bench::State& state) {
+    static typename P::template Shared<Base> base = P::template Make<Derived>();
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        typename P::template Shared<Derived> derived = P::template DynamicCast<Derived>(base);
+        bench::DoNotOptimize(derived);
     }
 }
 
-void benchmark_weak_ptr() {
-    std::cout << "\n╔════════════════════════════════════════════════╗\n";
-    std::cout << "║  Benchmark 4: weak_ptr 性能对比                ║\n";
-    std::cout << "╚════════════════════════════════════════════════╝\n";
-    
-    constexpr int ITERATIONS = 1000000;
-    
-    std::cout << "\n[weak_ptr.lock() - " << ITERATIONS << " 次迭代]\n";
-    std::cout << std::string(60, '-') << "\n";
-    
-    // std::weak_ptr
-    {
-        auto sp = std::make_shared<int>(42);
-        std::weak_ptr<int> wp = sp;
-        
-        Timer timer;
-        
-        int success = 0;
-        for (int i = 0; i < ITERATIONS; ++i) {
-            if (auto locked = wp.lock()) {
-                success++;
-            }
-        }
-        
-        double elapsed = timer.elapsed_ms();
-        std::cout << "std::weak_ptr:               " 
-                  << std::fixed << std::setprecision(2) << std::setw(8) << elapsed << " ms"
-                  << "  (成功: " << success << ")\n";
+// 调用链:把指针逐层传下 kCallDepth 层,最内层读一次对象
+// 按值传每层一次拷贝 + 释放;const& 和 Borrowed 都不碰计数
+const int kCallDepth = 8;
+
+template <typename Ptr>
+int PassDown(Ptr p, int depth) {
+    return depth == 0 ? p->value : PassDown<Ptr>(p, depth - 1);
+}
+
+template <typename Ptr, typename Source>
+void RunCallChain(bench::State& state, const Source& source) {
+    long sum = 0;
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        int depth = kCallDepth;
+        bench::DoNotOptimize(depth);
+        sum += PassDown<Ptr>(source, depth);
     }
-    
-    // my::weak_ptr
-    {
-        auto sp = my::make_shared<int>(42);
-        my::WeakPtr<int> wp = sp;
-        
-        Timer timer;
-        
-        int success = 0;
-        for (int i = 0; i < ITERATIONS; ++i) {
-            if (auto locked = wp.lock()) {
-                success++;
-            }
-        }
-        
-        double elapsed = timer.elapsed_ms();
-        std::cout << "my::weak_ptr:                " 
-                  << std::fixed << std::setprecision(2) << std::setw(8) << elapsed << " ms"
-                  << "  (成功: " << success << ")\n";
+    bench::DoNotOptimize(sum);
+}
+
+template <typename P>
+void BM_CallChainByValue(bench::State& state) {
+    static typename P::template Shared<SmallObject> source = P::template Make<SmallObject>(42);
+    RunCallChain<typename P::template Shared<SmallObject>>(state, source);
+}
+
+template <typename P>
+void BM_CallChainConstRef(bench::State& state) {
+    static typename P::template Shared<SmallObject> source = P::template Make<SmallObject>(42);
+    RunCallChain<const typename P::template Shared<SmallObject>&>(state, source);
+}
+
+void BM_CallChainBorrowed(bench::State& state) {
+    static my::SharedPtr<SmallObject> source = my::make_shared<SmallObject>(42);
+    RunCallChain<my::Borrowed<SmallObject>>(state, source);
+}
+
+// 顺序扫描 kScanCount 个指针并读对象,按元素计
+// 指针数组大于 L2;ThinSharedPtr 单字,同样的缓存行能装下两倍的指针
+// 数组在 main() 里预先建好,不计入计时
+const size_t kScanCount = 1 << 18;
+
+template <typename Ptr, typename Make>
+const std::vector<Ptr>& ScanItems(Make make) {
+    static std::vector<Ptr> items;
+    if (items.empty()) {
+        items.reserve(kScanCount);
+        for (size_t i = 0; i < kScanCount; ++i) items.push_back(make());
     }
+    return items;
 }
 
-void benchmark_pointer_cast() {
-    std::cout << "\n╔════════════════════════════════════════════════╗\n";
-    std::cout << "║  Benchmark 5: 类型转换性能对比                 ║\n";
-    std::cout << "╚════════════════════════════════════════════════╝\n";
-    
-    constexpr int ITERATIONS = 5000000;
-    
-    std::cout << "\n[static_pointer_cast - " << ITERATIONS << " 次迭代]\n";
-    std::cout << std::string(60, '-') << "\n";
-    
-    // std::static_pointer_cast
-    {
-        auto derived = std::make_shared<Derived>();
-        Timer timer;
-        
-        for (int i = 0; i < ITERATIONS; ++i) {
-            auto base = std::static_pointer_cast<Base>(derived);
-            (void)base;
-        }
-        
-        double elapsed = timer.elapsed_ms();
-        std::cout << "std::static_pointer_cast:    " 
-                  << std::fixed << std::setprecision(2) << std::setw(8) << elapsed << " ms\n";
+template <typename P>
+const std::vector<typename P::template Shared<SmallObject>>& ScanShared() {
+    return ScanItems<typename P::template Shared<SmallObject>>(
+        [] { return P::template Make<SmallObject>(1); });
+}
+
+const std::vector<my::ThinSharedPtr<SmallObject>>& ScanThin() {
+    return ScanItems<my::ThinSharedPtr<SmallObject>>(
+        [] { return my::make_thin_shared<SmallObject>(1); });
+}
+
+template <typename Vector>
+void RunScan(bench::State& state, const Vector& items) {
+    long sum = 0;
+    size_t index = 0;
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        sum += items[index]->value;
+        if (++index == items.size()) index = 0;
     }
-    
-    // my::static_pointer_cast
-    {
-        auto derived = my::make_shared<Derived>();
-        Timer timer;
-        
-        for (int i = 0; i < ITERATIONS; ++i) {
-            auto base = my::static_pointer_cast<Base>(derived);
-            (void)base;
+    bench::DoNotOptimize(sum);
+}
+
+template <typename P>
+void BM_Scan(bench::State& state) {
+    RunScan(state, ScanShared<P>());
+}
+
+void BM_ScanThin(bench::State& state) {
+    RunScan(state, ScanThin());
+}
+
+// 大容器整体释放,按批(kReleaseCount 个元素)计:每批先按分配顺序拷贝
+// 母本的指针、写到打乱后的位置,再用 clear() 或 release_all() 释放。
+// 拷贝时顺序访问控制块,释放时随机访问;两种方式的拷贝开销相同。
+// 母本在 main() 里预先建好
+const size_t kReleaseCount = 1 << 20;
+
+struct ReleaseFixture {
+    std::vector<my::SharedPtr<SmallObject>> source;  // 分配顺序
+    std::vector<uint32_t> slots;                     // source[i] 写到 slots[i]
+};
+
+const ReleaseFixture& ReleaseSource() {
+    static ReleaseFixture fixture;
+    if (fixture.source.empty()) {
+        fixture.source.reserve(kReleaseCount);
+        fixture.slots.reserve(kReleaseCount);
+        for (size_t i = 0; i < kReleaseCount; ++i) {
+            fixture.source.push_back(my::make_shared<SmallObject>(1));
+            fixture.slots.push_back(static_cast<uint32_t>(i));
         }
-        
-        double elapsed = timer.elapsed_ms();
-        std::cout << "my::static_pointer_cast:     " 
-                  << std::fixed << std::setprecision(2) << std::setw(8) << elapsed << " ms\n";
+        std::shuffle(fixture.slots.begin(), fixture.slots.end(), std::mt19937(42));
     }
-    
-    std::cout << "\n[dynamic_pointer_cast (成功) - " << ITERATIONS << " 次迭代]\n";
-    std::cout << std::string(60, '-') << "\n";
-    
-    // std::dynamic_pointer_cast
-    {
-        std::shared_ptr<Base> base = std::make_shared<Derived>();
-        Timer timer;
-        
-        int success = 0;
-        for (int i = 0; i < ITERATIONS; ++i) {
-            auto derived = std::dynamic_pointer_cast<Derived>(base);
-            if (derived) success++;
-        }
-        
-        double elapsed = timer.elapsed_ms();
-        std::cout << "std::dynamic_pointer_cast:   " 
-                  << std::fixed << std::setprecision(2) << std::setw(8) << elapsed << " ms"
-                  << "  (成功: " << success << ")\n";
+    return fixture;
+}
+
+template <typename Release>
+void RunRelease(bench::State& state, Release release) {
+    const ReleaseFixture& fixture = ReleaseSource();
+    std::vector<my::SharedPtr<SmallObject>> items;
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        items.resize(kReleaseCount);
+        for (size_t k = 0; k < kReleaseCount; ++k) items[fixture.slots[k]] = fixture.source[k];
+        release(items);
     }
-    
-    // my::dynamic_pointer_cast
-    {
-        my::SharedPtr<Base> base = my::make_shared<Derived>();
-        Timer timer;
-        
-        int success = 0;
-        for (int i = 0; i < ITERATIONS; ++i) {
-            auto derived = my::dynamic_pointer_cast<Derived>(base);
-            if (derived) success++;
+    bench::DoNotOptimize(items.data());
+}
+
+void BM_ReleaseClear(bench::State& state) {
+    RunRelease(state, [](std::vector<my::SharedPtr<SmallObject>>& items) { items.clear(); });
+}
+
+void BM_ReleasePrefetch(bench::State& state) {
+    RunRelease(state, [](std::vector<my::SharedPtr<SmallObject>>& items) {
+        my::ReleaseAllOptions options;
+        options.threads = 1;
+        my::release_all(items, options);
+    });
+}
+
+void BM_ReleaseParallel(bench::State& state) {
+    RunRelease(state, [](std::vector<my::SharedPtr<SmallObject>>& items) { my::release_all(items); });
+}
+
+// 同上,但复用常驻的工作线程,不再每批创建和 join 线程
+void BM_ReleasePool(bench::State& state) {
+    static my::ReleasePool pool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+    RunRelease(state, [](std::vector<my::SharedPtr<SmallObject>>& items) {
+        my::ReleaseAllOptions options;
+        options.pool = &pool;
+        my::release_all(items, options);
+    });
+}
+
+// 观察者注册表:kWeakScanCount 个 WeakPtr,顺序打乱(控制块随机访问),
+// 其中一半对象已经死亡;按整个数组一遍计。夹具在 main() 里预先建好
+const size_t kWeakScanCount = 1 << 20;
+
+struct WeakScanFixture {
+    std::vector<my::SharedPtr<SmallObject>> alive;
+    std::vector<my::WeakPtr<SmallObject>> registry;
+};
+
+const WeakScanFixture& WeakScanRegistry() {
+    static WeakScanFixture fixture;
+    if (fixture.registry.empty()) {
+        fixture.alive.reserve(kWeakScanCount / 2);
+        fixture.registry.reserve(kWeakScanCount);
+        for (size_t i = 0; i < kWeakScanCount; ++i) {
+            my::SharedPtr<SmallObject> object = my::make_shared<SmallObject>(1);
+            fixture.registry.push_back(object);
+            if (i % 2 == 0) fixture.alive.push_back(object);
         }
-        
-        double elapsed = timer.elapsed_ms();
-        std::cout << "my::dynamic_pointer_cast:    " 
-                  << std::fixed << std::setprecision(2) << std::setw(8) << elapsed << " ms"
-                  << "  (成功: " << success << ")\n";
+        std::shuffle(fixture.registry.begin(), fixture.registry.end(), std::mt19937(7));
     }
+    return fixture;
 }
 
-void benchmark_multithreaded() {
-    std::cout << "\n╔════════════════════════════════════════════════╗\n";
-    std::cout << "║  Benchmark 6: 多线程性能对比                   ║\n";
-    std::cout << "╚════════════════════════════════════════════════╝\n";
-    
-    constexpr int NUM_THREADS = 8;
-    constexpr int ITERATIONS_PER_THREAD = 1000000;
-    
-    std::cout << "\n[" << NUM_THREADS << " 线程并发拷贝 - " 
-              << (NUM_THREADS * ITERATIONS_PER_THREAD) << " 次总计]\n";
-    std::cout << std::string(60, '-') << "\n";
-    
-    // std::shared_ptr
-    {
-        auto source = std::make_shared<int>(42);
-        Timer timer;
-        
-        std::vector<std::thread> threads;
-        for (int t = 0; t < NUM_THREADS; ++t) {
-            threads.emplace_back([&source]() {
-                for (int i = 0; i < ITERATIONS_PER_THREAD; ++i) {
-                    std::shared_ptr<int> copy = source;
-                    (void)copy;
-                }
-            });
+// 逐个 lock(),活着的收进数组后整体释放
+void BM_WeakLockLoop(bench::State& state) {
+    const std::vector<my::WeakPtr<SmallObject>>& registry = WeakScanRegistry().registry;
+    std::vector<my::SharedPtr<SmallObject>> locked;
+    locked.reserve(kWeakScanCount);
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        for (const auto& weak : registry) {
+            my::SharedPtr<SmallObject> sp = weak.lock();
+            if (sp) locked.push_back(std::move(sp));
         }
-        
-        for (auto& thread : threads) {
-            thread.join();
-        }
-        
-        double elapsed = timer.elapsed_ms();
-        std::cout << "std::shared_ptr:             " 
-                  << std::fixed << std::setprecision(2) << std::setw(8) << elapsed << " ms\n";
+        bench::ClobberMemory();
+        locked.clear();
     }
-    
-    // my::shared_ptr
-    {
-        auto source = my::make_shared<int>(42);
-        Timer timer;
-        
-        std::vector<std::thread> threads;
-        for (int t = 0; t < NUM_THREADS; ++t) {
-            threads.emplace_back([&source]() {
-                for (int i = 0; i < ITERATIONS_PER_THREAD; ++i) {
-                    my::SharedPtr<int> copy = source;
-                    (void)copy;
-                }
-            });
-        }
-        
-        for (auto& thread : threads) {
-            thread.join();
-        }
-        
-        double elapsed = timer.elapsed_ms();
-        std::cout << "my::shared_ptr:              " 
-                  << std::fixed << std::setprecision(2) << std::setw(8) << elapsed << " ms\n";
+    bench::DoNotOptimize(locked.data());
+}
+
+void BM_WeakLockAll(bench::State& state) {
+    const std::vector<my::WeakPtr<SmallObject>>& registry = WeakScanRegistry().registry;
+    std::vector<my::SharedPtr<SmallObject>> locked;
+    locked.reserve(kWeakScanCount);
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        my::lock_all(registry.begin(), registry.end(), std::back_inserter(locked));
+        bench::ClobberMemory();
+        locked.clear();
     }
+    bench::DoNotOptimize(locked.data());
 }
 
-void benchmark_container_usage() {
-    std::cout << "\n╔════════════════════════════════════════════════╗\n";
-    std::cout << "║  Benchmark 7: 容器中使用性能对比               ║\n";
-    std::cout << "╚════════════════════════════════════════════════╝\n";
-    
-    constexpr int CONTAINER_SIZE = 100000;
-    
-    std::cout << "\n[std::vector 插入 - " << CONTAINER_SIZE << " 个元素]\n";
-    std::cout << std::string(60, '-') << "\n";
-    
-    // std::shared_ptr
-    {
-        Timer timer;
-        std::vector<std::shared_ptr<int>> vec;
-        vec.reserve(CONTAINER_SIZE);
-        
-        for (int i = 0; i < CONTAINER_SIZE; ++i) {
-            vec.push_back(std::make_shared<int>(i));
-        }
-        
-        double elapsed = timer.elapsed_ms();
-        std::cout << "std::shared_ptr:             " 
-                  << std::fixed << std::setprecision(2) << std::setw(8) << elapsed << " ms\n";
+void BM_CountExpiredLoop(bench::State& state) {
+    const std::vector<my::WeakPtr<SmallObject>>& registry = WeakScanRegistry().registry;
+    size_t expired = 0;
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        for (const auto& weak : registry) expired += weak.expired() ? 1 : 0;
     }
-    
-    // my::shared_ptr
-    {
-        Timer timer;
-        std::vector<my::SharedPtr<int>> vec;
-        vec.reserve(CONTAINER_SIZE);
-        
-        for (int i = 0; i < CONTAINER_SIZE; ++i) {
-            vec.push_back(my::make_shared<int>(i));
+    bench::DoNotOptimize(expired);
+}
+
+void BM_CountExpired(bench::State& state) {
+    const std::vector<my::WeakPtr<SmallObject>>& registry = WeakScanRegistry().registry;
+    size_t expired = 0;
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        expired += my::count_expired(registry.begin(), registry.end());
+    }
+    bench::DoNotOptimize(expired);
+}
+
+// 容器:填满 1000 个元素后清空,按元素计
+template <typename P, typename Obj>
+void BM_VectorFill(bench::State& state) {
+    const uint64_t kBatch = 1000;
+    std::vector<typename P::template Shared<Obj>> vec;
+    vec.reserve(kBatch);
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        vec.push_back(P::template Make<Obj>());
+        if (vec.size() == kBatch) {
+            bench::ClobberMemory();
+            vec.clear();
         }
-        
-        double elapsed = timer.elapsed_ms();
-        std::cout << "my::shared_ptr:              " 
-                  << std::fixed << std::setprecision(2) << std::setw(8) << elapsed << " ms\n";
+    }
+    bench::DoNotOptimize(vec.data());
+}
+
+// ============================================================================
+// 注册
+// ============================================================================
+
+template <typename P, typename Obj>
+void RegisterPerObject() {
+    const char* ptr = P::name();
+    const char* obj = ObjectName<Obj>::get();
+    bench::Register("create_new", BM_CreateNew<P, Obj>).Arg("ptr", ptr).Arg("obj", obj);
+    bench::Register("make_shared", BM_MakeShared<P, Obj>).Arg("ptr", ptr).Arg("obj", obj);
+    bench::Register("vector_fill", BM_VectorFill<P, Obj>).Arg("ptr", ptr).Arg("obj", obj);
+}
+
+template <typename Obj>
+void RegisterLazy() {
+    bench::Register("create_new", BM_CreateLazy<Obj>).Arg("ptr", "lazy").Arg("obj", ObjectName<Obj>::get());
+}
+
+template <typename P>
+void RegisterPerPointer() {
+    RegisterPerObject<P, SmallObject>();
+    RegisterPerObject<P, MediumObject>();
+    RegisterPerObject<P, LargeObject>();
+
+    const char* ptr = P::name();
+    for (int threads : {1, 2, 4, 8}) {
+        bench::Register("copy", BM_Copy<P>).Arg("ptr", ptr).Threads(threads);
+    }
+    bench::Register("copy_batch", BM_CopyBatch<P>).Arg("ptr", ptr);
+    bench::Register("deref", BM_Deref<P>).Arg("ptr", ptr);
+    bench::Register("weak_lock", BM_WeakLock<P>).Arg("ptr", ptr);
+    bench::Register("static_cast", BM_StaticCast<P>).Arg("ptr", ptr);
+    bench::Register("dynamic_cast", BM_DynamicCast<P>).Arg("ptr", ptr);
+    bench::Register("call_chain", BM_CallChainByValue<P>).Arg("ptr", ptr).Arg("pass", "value");
+    bench::Register("call_chain", BM_CallChainConstRef<P>).Arg("ptr", ptr).Arg("pass", "const_ref");
+    bench::Register("scan", BM_Scan<P>).Arg("ptr", ptr);
+    for (int threads : {1, 4}) {
+        bench::Register("fan_out", BM_FanOut<P>).Arg("ptr", ptr).Threads(threads);
     }
 }
 
@@ -515,40 +502,38 @@ void benchmark_container_usage() {
 // 主函数
 // ============================================================================
 
-int main() {
-    std::cout << "\n";
-    std::cout << "╔════════════════════════════════════════════════╗\n";
-    std::cout << "║  my::shared_ptr vs std::shared_ptr            ║\n";
-    std::cout << "║  性能对比测试                                  ║\n";
-    std::cout << "╚════════════════════════════════════════════════╝\n";
-    
-    std::cout << "\n 提示: 请确保以 Release 模式编译(-O3 或 /O2)\n";
-    std::cout << "   编译器: " << 
-#ifdef __GNUC__
-        "GCC " << __GNUC__ << "." << __GNUC_MINOR__
-#elif defined(_MSC_VER)
-        "MSVC " << _MSC_VER
-#else
-        "Unknown"
-#endif
-        << "\n";
-    
-    std::cout << "   优化级别: " <<
-#ifdef NDEBUG
-        "Release (优化已启用)"
-#else
-        "Debug ( 警告: 未启用优化!)"
-#endif
-        << "\n";
-    
-    benchmark_creation_and_destruction();
-    benchmark_copy_operations();
-    benchmark_access_performance();
-    benchmark_weak_ptr();
-    benchmark_pointer_cast();
-    benchmark_multithreaded();
-    benchmark_container_usage();
-    
-    
-    return 0;
-}
\ No newline at end of file
+int main(int argc, char** argv) {
+    bench::RegisterAllocCounter();
+    bench::RegisterPerfCounters();
+
+    bench::Register("deref", BM_DerefRaw).Arg("ptr", "raw");
+    RegisterPerPointer<StdPtrs>();
+    RegisterPerPointer<MyPtrs>();
+    RegisterLazy<SmallObject>();
+    RegisterLazy<MediumObject>();
+    RegisterLazy<LargeObject>();
+    for (int threads : {1, 2, 4, 8}) {
+        bench::Register("copy", BM_CopyRef).Arg("ptr", "ref").Threads(threads);
+    }
+    bench::Register("copy_batch", BM_CopyBatchRef).Arg("ptr", "ref");
+    bench::Register("call_chain", BM_CallChainBorrowed).Arg("ptr", "my").Arg("pass", "borrowed");
+    bench::Register("scan", BM_ScanThin).Arg("ptr", "thin");
+    for (int threads : {1, 4}) {
+        bench::Register("fan_out", BM_FanOutBulk).Arg("ptr", "my").Arg("mode", "bulk").Threads(threads);
+    }
+    bench::Register("release_all", BM_ReleaseClear).Arg("mode", "clear");
+    bench::Register("release_all", BM_ReleasePrefetch).Arg("mode", "prefetch");
+    bench::Register("release_all", BM_ReleaseParallel).Arg("mode", "parallel");
+    bench::Register("release_all", BM_ReleasePool).Arg("mode", "pool");
+    bench::Register("weak_scan", BM_WeakLockLoop).Arg("op", "lock").Arg("mode", "loop");
+    bench::Register("weak_scan", BM_WeakLockAll).Arg("op", "lock").Arg("mode", "lock_all");
+    bench::Register("weak_scan", BM_CountExpiredLoop).Arg("op", "expired").Arg("mode", "loop");
+    bench::Register("weak_scan", BM_CountExpired).Arg("op", "expired").Arg("mode", "count_expired");
+    ScanShared<StdPtrs>();
+    ScanShared<MyPtrs>();
+    ScanThin();
+    ReleaseSource();
+    WeakScanRegistry();
+
+    return bench::RunAll(argc, argv);
+}
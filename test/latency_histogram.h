@@ -0,0 +1,108 @@
+// latency_histogram.h
+#ifndef MY_LATENCY_HISTOGRAM_H
+#define MY_LATENCY_HISTOGRAM_H
+
+// ============================================================================
+// 延迟直方图(HdrHistogram 风格的对数-线性分桶)
+// ============================================================================
+// 每个 2 的幂区间再线性细分为 64 个桶,相对误差 < 1/64 (1.6%),
+// 覆盖 0 .. 2^64 ns 只需约 3800 个计数器,记录一次是 O(1) 的位运算。
+// 平均值会掩盖长尾,用 Percentile(99.9) 和 max() 看偶发的停顿。
+//
+// 非线程安全:每个线程用自己的直方图,结束后 Merge()。
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <vector>
+
+namespace bench {
+
+class LatencyHistogram {
+public:
+    LatencyHistogram() : counts_(kBucketCount, 0), total_(0), min_(UINT64_MAX), max_(0), sum_(0) {}
+
+    void Record(uint64_t value) {
+        ++counts_[BucketOf(value)];
+        ++total_;
+        sum_ += value;
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+    }
+
+    void Merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < kBucketCount; ++i) counts_[i] += other.counts_[i];
+        total_ += other.total_;
+        sum_ += other.sum_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+
+    void Reset() {
+        std::fill(counts_.begin(), counts_.end(), 0);
+        total_ = 0;
+        sum_ = 0;
+        min_ = UINT64_MAX;
+        max_ = 0;
+    }
+
+    // 第 p 百分位(0 < p <= 100):落在该桶内的最大可能值,不超过实际最大值
+    uint64_t Percentile(double p) const {
+        if (total_ == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(p / 100.0 * total_ + 0.5);
+        rank = std::max<uint64_t>(1, std::min(rank, total_));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            seen += counts_[i];
+            if (seen >= rank) return std::min(UpperBoundOf(i), max_);
+        }
+        return max_;
+    }
+
+    uint64_t count() const { return total_; }
+    uint64_t min() const { return total_ ? min_ : 0; }
+    uint64_t max() const { return max_; }
+    double mean() const { return total_ ? static_cast<double>(sum_) / total_ : 0; }
+
+    // 一行摘要:p50 p99 p99.9 max(单位 ns)
+    void PrintSummary(std::ostream& os) const {
+        os << std::setw(10) << Percentile(50) << std::setw(10) << Percentile(99)
+           << std::setw(10) << Percentile(99.9) << std::setw(12) << max();
+    }
+
+private:
+    static const int kSubBucketBits = 6;                       // 每个 2 的幂区间 64 个桶
+    static const uint64_t kSubBucketCount = uint64_t(1) << kSubBucketBits;
+    // [0, 128) 逐个计数;此后每个区间 [2^k, 2^(k+1)) 64 个桶
+    static const size_t kBucketCount = 2 * kSubBucketCount + (63 - kSubBucketBits) * kSubBucketCount;
+
+    static int HighestBit(uint64_t value) { return 63 - __builtin_clzll(value); }
+
+    static size_t BucketOf(uint64_t value) {
+        if (value < 2 * kSubBucketCount) return static_cast<size_t>(value);
+        int shift = HighestBit(value) - kSubBucketBits;  // >= 1
+        uint64_t top = value >> shift;                   // [64, 128)
+        return static_cast<size_t>(2 * kSubBucketCount + (shift - 1) * kSubBucketCount +
+                                   (top - kSubBucketCount));
+    }
+
+    static uint64_t UpperBoundOf(size_t bucket) {
+        if (bucket < 2 * kSubBucketCount) return bucket;
+        size_t offset = bucket - 2 * kSubBucketCount;
+        int shift = static_cast<int>(offset / kSubBucketCount) + 1;
+        uint64_t top = kSubBucketCount + offset % kSubBucketCount;
+        return ((top + 1) << shift) - 1;
+    }
+
+    std::vector<uint64_t> counts_;
+    uint64_t total_;
+    uint64_t min_;
+    uint64_t max_;
+    uint64_t sum_;
+};
+
+}  // namespace bench
+
+#endif  // MY_LATENCY_HISTOGRAM_H
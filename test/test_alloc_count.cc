@@ -0,0 +1,200 @@
+// 统计每个操作的堆分配次数;alloc_counter.h 替换了全局 operator new/delete
+// 分配次数是本测试的目的,用 MY_CHECK 而不是 assert:默认构建带 -DNDEBUG
+#include "alloc_counter.h"
+#include "my_make_shared.h"
+#include "my_on_expire.h"
+#include "my_pointer_cast.h"
+#include "my_weak_ptr.h"
+#include "test_check.h"
+
+#include <iostream>
+#include <memory>
+#include <utility>
+
+// ============================================================================
+// 测试用类
+// ============================================================================
+
+struct Base {
+    virtual ~Base() {}
+    int base_value = 1;
+};
+
+struct Derived : Base {
+    explicit Derived(int v) : value(v) {}
+    int value;
+};
+
+struct PlainDeleter {
+    void operator()(Derived* p) const { delete p; }
+};
+
+// 先取增量再打印:iostream 首次输出可能自己分配缓冲区
+alloc_counter::Counts report(const char* what, const alloc_counter::Scope& scope) {
+    alloc_counter::Counts delta = scope.Delta();
+    std::cout << "  " << what << ": 分配 " << delta.allocations
+              << " 次 (" << delta.bytes << " 字节), 释放 " << delta.deallocations << " 次\n";
+    return delta;
+}
+
+// ============================================================================
+// 测试函数
+// ============================================================================
+
+void test_make_shared_allocates_once() {
+    std::cout << "\n========== 测试 1:make_shared 恰好分配一次 ==========\n";
+
+    alloc_counter::Scope scope;
+    {
+        my::SharedPtr<Derived> sp = my::make_shared<Derived>(42);
+        alloc_counter::Counts made = report("make_shared<Derived>", scope);
+        MY_CHECK(made.allocations == 1);
+        MY_CHECK(made.deallocations == 0);
+        MY_CHECK(made.bytes >= sizeof(Derived));
+        scope.Reset();
+    }
+    alloc_counter::Counts destroyed = report("析构", scope);
+    MY_CHECK(destroyed.allocations == 0);
+    MY_CHECK(destroyed.deallocations == 1);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_separate_control_block() {
+    std::cout << "\n========== 测试 2:接管裸指针只分配控制块 ==========\n";
+
+    Derived* raw = new Derived(1);
+    alloc_counter::Scope scope;
+    {
+        my::SharedPtr<Derived> sp(raw);
+        alloc_counter::Counts created = report("SharedPtr(new T)", scope);
+        MY_CHECK(created.allocations == 1);
+        scope.Reset();
+    }
+    // 对象和控制块各释放一次
+    alloc_counter::Counts destroyed = report("析构", scope);
+    MY_CHECK(destroyed.deallocations == 2);
+
+    Derived* raw2 = new Derived(2);
+    scope.Reset();
+    {
+        my::SharedPtr<Derived> sp(raw2, PlainDeleter());
+        alloc_counter::Counts created = report("SharedPtr(new T, deleter)", scope);
+        MY_CHECK(created.allocations == 1);
+        scope.Reset();
+    }
+    alloc_counter::Counts destroyed_with_deleter = report("析构", scope);
+    MY_CHECK(destroyed_with_deleter.deallocations == 2);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_copy_move_cast_do_not_allocate() {
+    std::cout << "\n========== 测试 3:拷贝/移动/转换不分配 ==========\n";
+
+    my::SharedPtr<Derived> source = my::make_shared<Derived>(7);
+
+    alloc_counter::Scope scope;
+    {
+        my::SharedPtr<Derived> copy = source;
+        my::SharedPtr<Derived> assigned;
+        assigned = copy;
+        my::SharedPtr<Derived> moved = std::move(copy);
+        my::SharedPtr<Base> upcast = moved;
+        my::SharedPtr<Base> upcast_moved = std::move(moved);
+        my::SharedPtr<Derived> down = my::static_pointer_cast<Derived>(upcast);
+        my::SharedPtr<Derived> dyn = my::dynamic_pointer_cast<Derived>(upcast);
+        my::SharedPtr<const Derived> constant = down;
+        my::SharedPtr<Derived> mutable_again = my::const_pointer_cast<Derived>(constant);
+        my::SharedPtr<int> alias(source, &source->value);
+        MY_CHECK(dyn.get() == source.get());
+        MY_CHECK(*alias == 7);
+    }
+    alloc_counter::Counts delta = report("拷贝/移动/转换/别名", scope);
+    MY_CHECK(delta.allocations == 0);
+    MY_CHECK(delta.deallocations == 0);
+    MY_CHECK(source.use_count() == 1);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_weak_ptr_does_not_allocate() {
+    std::cout << "\n========== 测试 4:WeakPtr 不分配 ==========\n";
+
+    my::SharedPtr<Derived> sp = my::make_shared<Derived>(3);
+    alloc_counter::Scope scope;
+    {
+        my::WeakPtr<Derived> weak = sp;
+        my::WeakPtr<Derived> weak_copy = weak;
+        my::SharedPtr<Derived> locked = weak_copy.lock();
+        MY_CHECK(locked);
+        MY_CHECK(!weak.expired());
+    }
+    alloc_counter::Counts weak_ops = report("WeakPtr 构造/拷贝/lock", scope);
+    MY_CHECK(weak_ops.allocations == 0);
+
+    // 弱引用让合并分配的块在对象析构后继续存在,直到最后一个 WeakPtr 离开
+    my::WeakPtr<Derived> weak = sp;
+    scope.Reset();
+    sp.Reset();
+    MY_CHECK(weak.expired());
+    MY_CHECK(scope.deallocations() == 0);
+    weak = my::WeakPtr<Derived>();
+    alloc_counter::Counts released = report("对象死亡后释放最后一个 WeakPtr", scope);
+    MY_CHECK(released.deallocations == 1);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_on_expire_allocates_listener() {
+    std::cout << "\n========== 测试 5:on_expire 只分配监听器节点 ==========\n";
+
+    my::SharedPtr<Derived> sp = my::make_shared<Derived>(5);
+    int fired = 0;
+
+    alloc_counter::Scope scope;
+    my::ExpiryListenerHandle handle = my::on_expire(sp, [&fired] { ++fired; });
+    alloc_counter::Counts listener = report("on_expire", scope);
+    MY_CHECK(listener.allocations == 1);
+    MY_CHECK(handle);
+
+    sp.Reset();
+    MY_CHECK(fired == 1);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_std_baseline() {
+    std::cout << "\n========== 测试 6:std::shared_ptr 对照 ==========\n";
+
+    alloc_counter::Scope scope;
+    {
+        std::shared_ptr<Derived> sp = std::make_shared<Derived>(1);
+        alloc_counter::Counts made = report("std::make_shared<Derived>", scope);
+        MY_CHECK(made.allocations == 1);
+        scope.Reset();
+        std::shared_ptr<Derived> copy = sp;
+        std::shared_ptr<Base> base = std::move(copy);
+        MY_CHECK(scope.allocations() == 0);
+    }
+
+    std::cout << " 测试通过\n";
+}
+
+// ============================================================================
+// 主函数
+// ============================================================================
+
+int main() {
+    std::cout << "开始分配计数测试...\n";
+
+    test_make_shared_allocates_once();
+    test_separate_control_block();
+    test_copy_move_cast_do_not_allocate();
+    test_weak_ptr_does_not_allocate();
+    test_on_expire_allocates_listener();
+    test_std_baseline();
+
+    std::cout << "\n所有分配计数测试通过!\n";
+    return 0;
+}
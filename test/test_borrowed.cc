@@ -0,0 +1,194 @@
+// 以 -DMY_SP_ENABLE_BORROW_CHECK -DMY_SP_ENABLE_REFCOUNT_PROFILER 编译(见 CMakeLists.txt)
+#include "my_borrowed.h"
+#include "my_make_shared.h"
+#include "my_refcount_profiler.h"
+#include "my_weak_ptr.h"
+#include "test_check.h"
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifndef MY_SP_ENABLE_BORROW_CHECK
+#error "test_borrowed 需要定义 MY_SP_ENABLE_BORROW_CHECK"
+#endif
+
+#ifndef MY_SP_ENABLE_REFCOUNT_PROFILER
+#error "test_borrowed 需要定义 MY_SP_ENABLE_REFCOUNT_PROFILER"
+#endif
+
+// ============================================================================
+// 测试用类与辅助函数
+// ============================================================================
+
+struct Base {
+    virtual ~Base() = default;
+    int id = 0;
+};
+
+struct Request : Base {
+    bool keep = false;
+    std::string path = "/index";
+};
+
+std::vector<my::SharedPtr<Request>> g_kept;
+
+// 模拟深层调用链:每层按值传 Borrowed,只有叶子偶尔保留
+int handle(my::Borrowed<Request> request, int depth) {
+    if (depth > 0) return handle(request, depth - 1);
+    if (request->keep) g_kept.push_back(request.promote());
+    return request->id;
+}
+
+int read_base(my::Borrowed<Base> base) {
+    return base ? base->id : -1;
+}
+
+// 违例记录:替换默认的打印后 abort
+std::vector<std::string> g_violations;
+
+void RecordViolation(const void*, const char* what) {
+    g_violations.push_back(what);
+}
+
+// ============================================================================
+// 测试函数
+// ============================================================================
+
+void test_borrow_is_refcount_free() {
+    std::cout << "\n========== 测试 1:借用和传递不碰强引用计数 ==========\n";
+
+    my::SharedPtr<Request> request = my::make_shared<Request>();
+    request->id = 7;
+
+    my::RefcountOpCounts before = my::refcount_thread_op_counts();
+    int id = handle(request, 16);
+    my::RefcountOpCounts after = my::refcount_thread_op_counts();
+
+    std::cout << "copy=" << after.add_ref_copy - before.add_ref_copy
+              << " release=" << after.release - before.release << "\n";
+    MY_CHECK(id == 7);
+    MY_CHECK(after.add_ref_copy == before.add_ref_copy);
+    MY_CHECK(after.release == before.release);
+    MY_CHECK(request.use_count() == 1);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_promote() {
+    std::cout << "\n========== 测试 2:promote() 只付一次 AddRefCopy ==========\n";
+
+    my::SharedPtr<Request> request = my::make_shared<Request>();
+    request->keep = true;
+
+    my::RefcountOpCounts before = my::refcount_thread_op_counts();
+    handle(request, 16);
+    my::RefcountOpCounts after = my::refcount_thread_op_counts();
+
+    MY_CHECK(after.add_ref_copy - before.add_ref_copy == 1);
+    MY_CHECK(after.release == before.release);
+    MY_CHECK(g_kept.size() == 1);
+    MY_CHECK(g_kept[0] == request);
+    MY_CHECK(g_kept[0].owner_equal(request));
+    MY_CHECK(request.use_count() == 2);
+
+    // 保留下来的引用独立于源
+    request.Reset();
+    MY_CHECK(g_kept[0]->path == "/index");
+    g_kept.clear();
+
+    // 空视图
+    my::Borrowed<Request> empty;
+    MY_CHECK(!empty);
+    MY_CHECK(!empty.promote());
+    MY_CHECK(empty.use_count() == 0);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_conversions() {
+    std::cout << "\n========== 测试 3:向上转换与所有者 ==========\n";
+
+    my::SharedPtr<Request> request = my::make_shared<Request>();
+    request->id = 3;
+    MY_CHECK(read_base(request) == 3);  // SharedPtr<Request> -> Borrowed<Base>
+
+    my::Borrowed<Request> borrowed = request;
+    my::Borrowed<Base> base = borrowed;
+    MY_CHECK(base.get() == request.get());
+    MY_CHECK(base.owner_key() == request.owner_key());
+    MY_CHECK(base.use_count() == 1);
+    MY_CHECK(read_base(my::SharedPtr<Base>()) == -1);
+
+    my::SharedPtr<Base> promoted = base.promote();
+    MY_CHECK(promoted.owner_equal(request));
+    MY_CHECK(request.use_count() == 2);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_borrow_check_reports_dead_object() {
+    std::cout << "\n========== 测试 4:调试模式检测视图比对象活得更久 ==========\n";
+
+    g_violations.clear();
+    my::BorrowViolationHandler previous = my::set_borrow_violation_handler(RecordViolation);
+    MY_CHECK(previous == nullptr);
+
+    {
+        my::SharedPtr<Request> request = my::make_shared<Request>();
+        my::WeakPtr<Request> weak = request;
+        my::Borrowed<Request> dangling = request;
+        request.Reset();                // 唯一的所有者已经释放,视图还在
+        MY_CHECK(weak.expired());
+
+        dangling.get();
+        MY_CHECK(g_violations.size() == 1 && g_violations.back() == "get");
+        my::SharedPtr<Request> revived = dangling.promote();
+        MY_CHECK(!revived);             // 不会复活已经死亡的对象
+        MY_CHECK(g_violations.size() == 2 && g_violations.back() == "promote");
+    }                                   // 析构时再报告一次
+    std::cout << "违例 " << g_violations.size() << " 次\n";
+    MY_CHECK(g_violations.size() == 3);
+
+    // 源存活期间的正常借用不报告
+    g_violations.clear();
+    {
+        my::SharedPtr<Request> request = my::make_shared<Request>();
+        my::Borrowed<Request> borrowed = request;
+        borrowed->id = 1;
+    }
+    MY_CHECK(g_violations.empty());
+
+    // 只检查对象是否已死:源析构了但还有别的所有者时不会报告
+    {
+        my::SharedPtr<Request> other_owner = my::make_shared<Request>();
+        my::SharedPtr<Request>* source = new my::SharedPtr<Request>(other_owner);
+        my::Borrowed<Request> borrowed = *source;
+        delete source;
+        borrowed->id = 2;
+        MY_CHECK(other_owner->id == 2);
+    }
+    MY_CHECK(g_violations.empty());
+
+    previous = my::set_borrow_violation_handler(nullptr);
+    MY_CHECK(previous == RecordViolation);
+
+    std::cout << " 测试通过\n";
+}
+
+// ============================================================================
+// 主函数
+// ============================================================================
+
+int main() {
+    std::cout << "开始 Borrowed 测试...\n";
+
+    test_borrow_is_refcount_free();
+    test_promote();
+    test_conversions();
+    test_borrow_check_reports_dead_object();
+
+    std::cout << "\n所有 Borrowed 测试通过!\n";
+    return 0;
+}
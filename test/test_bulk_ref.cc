@@ -0,0 +1,225 @@
+// 以 -DMY_SP_ENABLE_REFCOUNT_PROFILER 编译(见 CMakeLists.txt)
+// 用每线程计数断言:同一控制块上的一批引用只做一次计数操作
+#include "my_bulk_ref.h"
+#include "my_make_shared.h"
+#include "my_refcount_profiler.h"
+#include "test_check.h"
+
+#include <atomic>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifndef MY_SP_ENABLE_REFCOUNT_PROFILER
+#error "test_bulk_ref 需要定义 MY_SP_ENABLE_REFCOUNT_PROFILER"
+#endif
+
+// ============================================================================
+// 测试用类
+// ============================================================================
+
+static std::atomic<int> g_live(0);
+
+struct Message {
+    int id;
+    int second;
+    explicit Message(int i = 0) : id(i), second(i * 10) { ++g_live; }
+    ~Message() { --g_live; }
+};
+
+// 两次快照之间当前线程的计数操作
+struct OpDelta {
+    uint64_t copy;
+    uint64_t release;
+};
+
+class OpScope {
+public:
+    OpScope() : start_(my::refcount_thread_op_counts()) {}
+
+    OpDelta Delta() const {
+        my::RefcountOpCounts now = my::refcount_thread_op_counts();
+        OpDelta delta = {now.add_ref_copy - start_.add_ref_copy, now.release - start_.release};
+        return delta;
+    }
+
+private:
+    my::RefcountOpCounts start_;
+};
+
+// 第 limit 次赋值时抛出的输出迭代器
+struct ThrowingSink {
+    std::vector<my::SharedPtr<Message>>* items;
+    int limit;
+
+    ThrowingSink& operator*() { return *this; }
+    ThrowingSink& operator++() { return *this; }
+    ThrowingSink& operator=(my::SharedPtr<Message> sp) {
+        if (static_cast<int>(items->size()) == limit) throw std::runtime_error("sink full");
+        items->push_back(std::move(sp));
+        return *this;
+    }
+};
+
+// ============================================================================
+// 测试函数
+// ============================================================================
+
+void test_share_n() {
+    std::cout << "\n========== 测试 1:share_n 一次加上 N 个引用 ==========\n";
+
+    my::SharedPtr<Message> message = my::make_shared<Message>(1);
+    std::vector<my::SharedPtr<Message>> subscribers;
+
+    OpScope scope;
+    my::share_n(message, 100, std::back_inserter(subscribers));
+    OpDelta delta = scope.Delta();
+    std::cout << "share_n(100): copy=" << delta.copy << "\n";
+    MY_CHECK(delta.copy == 1);
+    MY_CHECK(subscribers.size() == 100);
+    MY_CHECK(message.use_count() == 101);
+    for (const auto& sp : subscribers) MY_CHECK(sp.get() == message.get());
+
+    // 空指针:写出空的 SharedPtr,不做计数操作
+    std::vector<my::SharedPtr<Message>> empties;
+    my::share_n(my::SharedPtr<Message>(), 3, std::back_inserter(empties));
+    MY_CHECK(empties.size() == 3 && !empties[0]);
+
+    my::share_n(message, 0, std::back_inserter(subscribers));
+    MY_CHECK(message.use_count() == 101);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_release_n() {
+    std::cout << "\n========== 测试 2:release_n 合并相邻的同一控制块 ==========\n";
+
+    my::SharedPtr<Message> a = my::make_shared<Message>(1);
+    my::SharedPtr<Message> b = my::make_shared<Message>(2);
+    std::vector<my::SharedPtr<Message>> handles;
+    my::share_n(a, 50, std::back_inserter(handles));
+
+    OpScope scope;
+    my::release_n(handles);
+    MY_CHECK(scope.Delta().release == 1);
+    MY_CHECK(handles.empty());
+    MY_CHECK(a.use_count() == 1);
+
+    // a a b b a 空 -> 三段
+    handles = {a, a, b, b, a, my::SharedPtr<Message>()};
+    OpScope mixed;
+    my::release_n(handles.begin(), handles.end());
+    MY_CHECK(mixed.Delta().release == 3);
+    for (const auto& sp : handles) MY_CHECK(!sp);
+    MY_CHECK(a.use_count() == 1 && b.use_count() == 1);
+
+    // 最后一批引用一起归还时析构对象,且只析构一次
+    my::SharedPtr<Message> last = my::make_shared<Message>(3);
+    my::share_n(last, 10, std::back_inserter(handles));
+    last.Reset();
+    MY_CHECK(g_live == 3);
+    my::release_n(handles);
+    MY_CHECK(g_live == 2);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_copy_coalesced() {
+    std::cout << "\n========== 测试 3:copy_coalesced 合并拷贝 ==========\n";
+
+    my::SharedPtr<Message> a = my::make_shared<Message>(1);
+    my::SharedPtr<Message> b = my::make_shared<Message>(2);
+    my::SharedPtr<int> a_second(a, &a->second);  // 别名:同一控制块,不同指针
+
+    std::vector<my::SharedPtr<Message>> source = {a, a, a, b, b, my::SharedPtr<Message>(), a};
+    std::vector<my::SharedPtr<Message>> copy;
+    OpScope scope;
+    my::copy_coalesced(source.begin(), source.end(), std::back_inserter(copy));
+    OpDelta delta = scope.Delta();
+    std::cout << "7 个元素, 3 段非空: copy=" << delta.copy << "\n";
+    MY_CHECK(delta.copy == 3);
+    MY_CHECK(copy.size() == source.size());
+    for (size_t i = 0; i < source.size(); ++i) MY_CHECK(copy[i] == source[i]);
+    MY_CHECK(a.use_count() == 1 + 4 + 4 + 1);  // a、source 里 4 个、copy 里 4 个、a_second
+
+    std::vector<my::SharedPtr<int>> aliases = {a_second, a_second};
+    std::vector<my::SharedPtr<int>> alias_copy(2);
+    my::copy_coalesced(aliases.begin(), aliases.end(), alias_copy.begin());
+    MY_CHECK(alias_copy[1].get() == &a->second);
+    MY_CHECK(a.use_count() == 10 + 2 + 2);  // 再加 aliases 和 alias_copy 各 2 个
+
+    std::cout << " 测试通过\n";
+}
+
+void test_exception_returns_pending() {
+    std::cout << "\n========== 测试 4:写出时抛出异常归还剩余引用 ==========\n";
+
+    my::SharedPtr<Message> message = my::make_shared<Message>(4);
+    std::vector<my::SharedPtr<Message>> items;
+    ThrowingSink sink = {&items, 5};
+    bool thrown = false;
+    try {
+        my::share_n(message, 20, sink);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    MY_CHECK(thrown);
+    MY_CHECK(items.size() == 5);
+    MY_CHECK(message.use_count() == 6);
+
+    items.clear();
+    std::vector<my::SharedPtr<Message>> source(8, message);
+    thrown = false;
+    try {
+        my::copy_coalesced(source.begin(), source.end(), sink);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    MY_CHECK(thrown);
+    MY_CHECK(message.use_count() == 1 + 8 + 5);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_concurrent_fan_out() {
+    std::cout << "\n========== 测试 5:多线程同时广播同一消息 ==========\n";
+
+    my::SharedPtr<Message> message = my::make_shared<Message>(5);
+    const int NUM_THREADS = 4;
+    const int ROUNDS = 2000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NUM_THREADS; ++t) {
+        threads.emplace_back([&message]() {
+            std::vector<my::SharedPtr<Message>> subscribers;
+            for (int i = 0; i < ROUNDS; ++i) {
+                my::share_n(message, 16, std::back_inserter(subscribers));
+                MY_CHECK(message.use_count() >= 17);
+                my::release_n(subscribers);
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    MY_CHECK(message.use_count() == 1);
+
+    std::cout << " 测试通过\n";
+}
+
+// ============================================================================
+// 主函数
+// ============================================================================
+
+int main() {
+    std::cout << "开始批量引用计数测试...\n";
+
+    test_share_n();
+    test_release_n();
+    test_copy_coalesced();
+    test_exception_returns_pending();
+    test_concurrent_fan_out();
+    MY_CHECK(g_live == 0);
+
+    std::cout << "\n所有批量引用计数测试通过!\n";
+    return 0;
+}
@@ -0,0 +1,174 @@
+// 以 -DMY_SP_ENABLE_REFCOUNT_PROFILER 编译(见 CMakeLists.txt)
+// 用每线程计数断言:已死亡的控制块不做 lock() 的 fetch_add
+#include "my_bulk_weak.h"
+#include "my_make_shared.h"
+#include "my_refcount_profiler.h"
+#include "test_check.h"
+
+#include <atomic>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <thread>
+#include <vector>
+
+#ifndef MY_SP_ENABLE_REFCOUNT_PROFILER
+#error "test_bulk_weak 需要定义 MY_SP_ENABLE_REFCOUNT_PROFILER"
+#endif
+
+// ============================================================================
+// 测试用类
+// ============================================================================
+
+struct Observer {
+    int id;
+    explicit Observer(int i) : id(i) {}
+};
+
+// 每 3 个对象中第 0 个已经死亡;strong 保存其余对象
+void build_registry(int count, std::vector<my::SharedPtr<Observer>>* strong,
+                    std::vector<my::WeakPtr<Observer>>* weak) {
+    for (int i = 0; i < count; ++i) {
+        my::SharedPtr<Observer> observer = my::make_shared<Observer>(i);
+        weak->push_back(observer);
+        if (i % 3 != 0) strong->push_back(observer);
+    }
+}
+
+// ============================================================================
+// 测试函数
+// ============================================================================
+
+void test_lock_all() {
+    std::cout << "\n========== 测试 1:lock_all 跳过已过期的元素 ==========\n";
+
+    std::vector<my::SharedPtr<Observer>> strong;
+    std::vector<my::WeakPtr<Observer>> weak;
+    build_registry(1000, &strong, &weak);
+    weak.push_back(my::WeakPtr<Observer>());  // 空 WeakPtr 同样跳过
+
+    for (size_t distance : {size_t(0), size_t(1), size_t(16), size_t(5000)}) {
+        std::vector<my::SharedPtr<Observer>> locked;
+        uint64_t locks_before = my::refcount_thread_op_counts().add_ref_lock;
+        my::lock_all(weak.begin(), weak.end(), std::back_inserter(locked), distance);
+        // 只对活着的对象做 lock(),死亡和空的元素只读一次计数
+        MY_CHECK(my::refcount_thread_op_counts().add_ref_lock - locks_before == strong.size());
+        MY_CHECK(locked.size() == strong.size());
+        for (size_t i = 0; i < locked.size(); ++i) {
+            MY_CHECK(locked[i] == strong[i]);  // 保持原顺序
+            MY_CHECK(locked[i].use_count() == 2);
+        }
+    }
+    for (const auto& sp : strong) MY_CHECK(sp.use_count() == 1);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_count_expired() {
+    std::cout << "\n========== 测试 2:count_expired ==========\n";
+
+    std::vector<my::SharedPtr<Observer>> strong;
+    std::vector<my::WeakPtr<Observer>> weak;
+    build_registry(999, &strong, &weak);
+    weak.push_back(my::WeakPtr<Observer>());
+
+    size_t expected = 0;
+    for (const auto& wp : weak) expected += wp.expired() ? 1 : 0;
+    MY_CHECK(expected == 333 + 1);
+    MY_CHECK(my::count_expired(weak.begin(), weak.end()) == expected);
+    MY_CHECK(my::count_expired(weak.begin(), weak.end(), 0) == expected);
+
+    strong.resize(strong.size() / 2);
+    size_t more = my::count_expired(weak.begin(), weak.end());
+    std::cout << "释放一半后过期: " << more << "\n";
+    MY_CHECK(more == weak.size() - strong.size());
+    MY_CHECK(my::count_expired(weak.end(), weak.end()) == 0);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_lock_all_compact() {
+    std::cout << "\n========== 测试 3:lock_all_compact 同一遍删除过期元素 ==========\n";
+
+    std::vector<my::SharedPtr<Observer>> strong;
+    std::vector<my::WeakPtr<Observer>> weak;
+    build_registry(300, &strong, &weak);
+
+    std::vector<my::SharedPtr<Observer>> locked;
+    uint64_t locks_before = my::refcount_thread_op_counts().add_ref_lock;
+    my::lock_all_compact(weak, std::back_inserter(locked));
+    MY_CHECK(my::refcount_thread_op_counts().add_ref_lock - locks_before == strong.size());
+    MY_CHECK(weak.size() == strong.size());
+    MY_CHECK(locked.size() == strong.size());
+    for (size_t i = 0; i < weak.size(); ++i) {
+        MY_CHECK(weak[i].lock() == strong[i]);
+        MY_CHECK(locked[i] == strong[i]);
+    }
+    locked.clear();
+
+    // 第二遍没有可删的
+    my::lock_all_compact(weak, std::back_inserter(locked));
+    MY_CHECK(weak.size() == strong.size());
+
+    // 只支持前向迭代的容器
+    std::list<my::WeakPtr<Observer>> listeners(weak.begin(), weak.end());
+    strong.erase(strong.begin(), strong.begin() + 50);
+    locked.clear();
+    my::lock_all_compact(listeners, std::back_inserter(locked));
+    MY_CHECK(listeners.size() == strong.size());
+    MY_CHECK(listeners.front().lock() == strong.front());
+
+    std::cout << " 测试通过\n";
+}
+
+void test_scan_while_objects_die() {
+    std::cout << "\n========== 测试 4:扫描期间其他线程释放对象 ==========\n";
+
+    const int COUNT = 5000;
+    std::vector<my::SharedPtr<Observer>> strong;
+    std::vector<my::WeakPtr<Observer>> weak;
+    for (int i = 0; i < COUNT; ++i) {
+        strong.push_back(my::make_shared<Observer>(i));
+        weak.push_back(strong.back());
+    }
+
+    std::atomic<bool> done(false);
+    std::thread releaser([&]() {
+        for (auto& sp : strong) sp.Reset();
+        done.store(true, std::memory_order_release);
+    });
+
+    size_t last_expired = 0;
+    while (!done.load(std::memory_order_acquire)) {
+        std::vector<my::SharedPtr<Observer>> locked;
+        my::lock_all(weak.begin(), weak.end(), std::back_inserter(locked));
+        for (const auto& sp : locked) MY_CHECK(sp->id >= 0 && sp->id < COUNT);
+        size_t expired = my::count_expired(weak.begin(), weak.end());
+        MY_CHECK(expired >= last_expired);  // 过期是单调的
+        last_expired = expired;
+    }
+    releaser.join();
+
+    MY_CHECK(my::count_expired(weak.begin(), weak.end()) == static_cast<size_t>(COUNT));
+    std::vector<my::SharedPtr<Observer>> locked;
+    my::lock_all_compact(weak, std::back_inserter(locked));
+    MY_CHECK(weak.empty() && locked.empty());
+
+    std::cout << " 测试通过\n";
+}
+
+// ============================================================================
+// 主函数
+// ============================================================================
+
+int main() {
+    std::cout << "开始批量 WeakPtr 扫描测试...\n";
+
+    test_lock_all();
+    test_count_expired();
+    test_lock_all_compact();
+    test_scan_while_objects_die();
+
+    std::cout << "\n所有批量 WeakPtr 扫描测试通过!\n";
+    return 0;
+}
@@ -0,0 +1,24 @@
+// test_check.h
+#ifndef MY_TEST_CHECK_H
+#define MY_TEST_CHECK_H
+
+// ============================================================================
+// MY_CHECK: 不受 NDEBUG 影响的断言
+// ============================================================================
+// 默认的 Release 构建带 -DNDEBUG,assert 全部被编译掉。测试真正要守住的
+// 条件(分配次数、计数操作次数、只为检查而取的值)用 MY_CHECK:失败时打印
+// 位置和条件,以非零状态退出。其余检查仍用 assert。
+
+#include <cstdlib>
+#include <iostream>
+
+#define MY_CHECK(cond)                                                        \
+    do {                                                                      \
+        if (!(cond)) {                                                        \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": 检查失败: " #cond  \
+                      << "\n";                                                \
+            std::exit(1);                                                     \
+        }                                                                     \
+    } while (0)
+
+#endif  // MY_TEST_CHECK_H
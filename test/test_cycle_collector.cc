@@ -0,0 +1,165 @@
+// 以 -DMY_SP_ENABLE_CYCLE_COLLECTOR 编译(见 CMakeLists.txt)
+#include "my_cycle_collector.h"
+#include "my_make_shared.h"
+#include "my_weak_ptr.h"
+#include "test_check.h"
+
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+// ============================================================================
+// 测试用类
+// ============================================================================
+
+struct Node {
+    Node(int v) : value(v) { ++alive; }
+    ~Node() { --alive; }
+
+    void trace(my::CycleTracer& tracer) {
+        tracer(next);
+        tracer(prev);
+        for (auto& child : children) {
+            tracer(child);
+        }
+    }
+
+    int value;
+    my::SharedPtr<Node> next;
+    my::SharedPtr<Node> prev;   // 故意用 SharedPtr 形成环(对照 test_cycle.cc)
+    std::vector<my::SharedPtr<Node>> children;
+    my::SharedPtr<int> payload;  // 非可回收的边:回收器忽略
+
+    static int alive;
+};
+
+int Node::alive = 0;
+
+// ============================================================================
+// 测试函数
+// ============================================================================
+
+void test_two_node_cycle() {
+    std::cout << "\n========== 测试 1:双节点环 ==========\n";
+
+    my::WeakPtr<Node> w1;
+    {
+        my::SharedPtr<Node> n1 = my::make_collectable<Node>(1);
+        my::SharedPtr<Node> n2 = my::make_collectable<Node>(2);
+        n1->next = n2;
+        n2->prev = n1;  // 环!
+        w1 = n1;
+    }
+
+    std::cout << "作用域结束后存活节点: " << Node::alive << "\n";
+    MY_CHECK(Node::alive == 2);  // 泄漏,同 demonstrate_cycle_leak()
+    MY_CHECK(my::pending_cycle_roots() > 0);
+
+    size_t freed = my::collect_cycles();
+    std::cout << "回收节点数: " << freed << "\n";
+    MY_CHECK(freed == 2);
+    MY_CHECK(Node::alive == 0);
+    assert(w1.expired());
+    MY_CHECK(my::pending_cycle_roots() == 0);  // 拆环时剪边不会重新登记垃圾
+
+    std::cout << " 测试通过:循环引用被回收\n";
+}
+
+void test_live_cycle_is_kept() {
+    std::cout << "\n========== 测试 2:仍被外部持有的环不回收 ==========\n";
+
+    my::SharedPtr<Node> external;
+    {
+        my::SharedPtr<Node> n1 = my::make_collectable<Node>(1);
+        my::SharedPtr<Node> n2 = my::make_collectable<Node>(2);
+        n1->next = n2;
+        n2->next = n1;
+        n1->payload = my::make_shared<int>(7);
+        external = n2;
+    }
+
+    MY_CHECK(my::collect_cycles() == 0);
+    MY_CHECK(Node::alive == 2);
+    assert(*external->next->payload == 7);
+
+    external.Reset();
+    MY_CHECK(my::collect_cycles() == 2);
+    MY_CHECK(Node::alive == 0);
+
+    std::cout << " 测试通过:外部引用保护整个环\n";
+}
+
+void test_self_loop_and_fan_in() {
+    std::cout << "\n========== 测试 3:自环与汇聚 ==========\n";
+
+    {
+        my::SharedPtr<Node> self = my::make_collectable<Node>(0);
+        self->next = self;
+
+        // hub 同时被环内多个节点指向,环外还挂着一个叶子
+        my::SharedPtr<Node> hub = my::make_collectable<Node>(1);
+        for (int i = 0; i < 5; ++i) {
+            my::SharedPtr<Node> spoke = my::make_collectable<Node>(10 + i);
+            spoke->next = hub;
+            hub->children.push_back(spoke);
+        }
+        hub->prev = my::make_collectable<Node>(99);
+    }
+
+    MY_CHECK(Node::alive == 1 + 1 + 5 + 1);
+    MY_CHECK(my::collect_cycles() == 8);
+    MY_CHECK(Node::alive == 0);
+    MY_CHECK(my::pending_cycle_roots() == 0);
+
+    std::cout << " 测试通过:自环和多边汇聚正确回收\n";
+}
+
+void test_long_ring_and_bounded_increments() {
+    std::cout << "\n========== 测试 4:长环 + 有界增量回收 ==========\n";
+
+    constexpr int RING_SIZE = 100000;
+    constexpr int NUM_RINGS = 3;
+
+    for (int r = 0; r < NUM_RINGS; ++r) {
+        my::SharedPtr<Node> head = my::make_collectable<Node>(0);
+        my::SharedPtr<Node> tail = head;
+        for (int i = 1; i < RING_SIZE; ++i) {
+            my::SharedPtr<Node> node = my::make_collectable<Node>(i);
+            tail->next = node;
+            tail = node;
+        }
+        tail->next = head;  // 首尾相接
+    }
+    MY_CHECK(Node::alive == RING_SIZE * NUM_RINGS);
+
+    // 每次只处理 1 个候选根:显式栈保证长环不会递归爆栈
+    size_t rounds = 0;
+    while (Node::alive > 0) {
+        my::collect_cycles(1);
+        ++rounds;
+        assert(rounds <= static_cast<size_t>(RING_SIZE) * NUM_RINGS);
+    }
+    std::cout << "增量回收轮数: " << rounds << "\n";
+    my::collect_cycles();  // 建环时登记、所在环已被回收的候选根
+    MY_CHECK(my::pending_cycle_roots() == 0);
+
+    std::cout << " 测试通过:长环在有界增量中回收\n";
+}
+
+// ============================================================================
+// 主函数
+// ============================================================================
+
+int main() {
+    std::cout << "\n";
+    std::cout << "╔══════════════════════════════════════╗\n";
+    std::cout << "║   循环回收器(Bacon–Rajan 试删除)   ║\n";
+    std::cout << "╚══════════════════════════════════════╝\n";
+
+    test_two_node_cycle();
+    test_live_cycle_is_kept();
+    test_self_loop_and_fan_in();
+    test_long_ring_and_bounded_increments();
+
+    return 0;
+}
@@ -0,0 +1,243 @@
+// 统计分配次数验证往返不分配;alloc_counter.h 替换了全局 operator new/delete
+#include "alloc_counter.h"
+#include "my_make_shared.h"
+#include "my_shared_ptr.h"
+#include "my_weak_ptr.h"
+#include "test_check.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+// ============================================================================
+// 测试用类
+// ============================================================================
+
+static std::atomic<int> g_live(0);
+
+struct Connection {
+    int fd;
+    int handled;
+    explicit Connection(int f = -1) : fd(f), handled(0) { ++g_live; }
+    ~Connection() { --g_live; }
+};
+
+struct Header {
+    int id;
+};
+
+struct Packet {
+    Header header;  // 位于对象开头的成员
+    char payload[16];
+};
+
+// 模拟只能携带一个 void* 的 C 接口(epoll data.ptr / C 回调上下文)
+struct FakeEventLoop {
+    std::deque<void*> ready;
+
+    void Submit(void* user_data) { ready.push_back(user_data); }
+
+    void* Poll() {
+        void* user_data = ready.front();
+        ready.pop_front();
+        return user_data;
+    }
+};
+
+// 先取增量再打印:iostream 首次输出可能自己分配缓冲区
+alloc_counter::Counts report(const char* what, const alloc_counter::Scope& scope) {
+    alloc_counter::Counts delta = scope.Delta();
+    std::cout << "  " << what << ": 分配 " << delta.allocations << " 次, 释放 "
+              << delta.deallocations << " 次\n";
+    return delta;
+}
+
+// ============================================================================
+// 测试函数
+// ============================================================================
+
+void test_shared_round_trip() {
+    std::cout << "\n========== 测试 1:SharedPtr 经 void* 往返 ==========\n";
+
+    FakeEventLoop loop;
+    my::SharedPtr<Connection> conn = my::make_shared<Connection>(7);
+    my::SharedPtr<Connection> in_flight = conn;
+
+    alloc_counter::Scope scope;
+    loop.Submit(in_flight.into_raw());
+    MY_CHECK(!in_flight);
+    MY_CHECK(conn.use_count() == 2);  // 交出的强引用仍然计在内
+
+    conn.Reset();  // 只剩"在途"的那个引用保活
+    MY_CHECK(g_live == 1);
+
+    my::SharedPtr<Connection> back =
+        my::SharedPtr<Connection>::from_raw(static_cast<Connection*>(loop.Poll()));
+    alloc_counter::Counts delta = report("into_raw + from_raw", scope);
+    MY_CHECK(delta.allocations == 0 && delta.deallocations == 0);
+    MY_CHECK(back->fd == 7 && back.use_count() == 1);
+
+    back.Reset();
+    MY_CHECK(g_live == 0);
+
+    // const 元素类型与空指针
+    my::SharedPtr<const Connection> constant = my::make_shared<Connection>(8);
+    const Connection* raw = constant.into_raw();
+    my::SharedPtr<const Connection> constant_back =
+        my::SharedPtr<const Connection>::from_raw(raw);
+    MY_CHECK(constant_back->fd == 8 && constant_back.use_count() == 1);
+
+    my::SharedPtr<Connection> empty;
+    MY_CHECK(empty.into_raw() == nullptr);
+    MY_CHECK(!my::SharedPtr<Connection>::from_raw(nullptr));
+
+    std::cout << " 测试通过\n";
+}
+
+void test_non_inplace_uses_parts() {
+    std::cout << "\n========== 测试 2:非 inplace 对象用 into_raw_parts ==========\n";
+
+    // new 出来的对象:控制块不能由对象地址反推
+    my::SharedPtr<Connection> separate(new Connection(3));
+    bool thrown = false;
+    try {
+        separate.into_raw();
+    } catch (const std::invalid_argument& e) {
+        thrown = true;
+        std::cout << "预期的异常: " << e.what() << "\n";
+    }
+    MY_CHECK(thrown);
+    MY_CHECK(separate && separate.use_count() == 1);  // 失败时不变
+
+    // 指向成员的别名:即使控制块是 make_shared 的也不能反推
+    my::SharedPtr<Packet> packet = my::make_shared<Packet>();
+    my::SharedPtr<char> alias(packet, packet->payload);
+    thrown = false;
+    try {
+        alias.into_raw();
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    MY_CHECK(thrown && packet.use_count() == 2);
+
+    // into_raw_parts 适用于任何 SharedPtr
+    alloc_counter::Scope scope;
+    my::SharedPtr<Connection>::RawParts parts = separate.into_raw_parts();
+    my::SharedPtr<char>::RawParts alias_parts = alias.into_raw_parts();
+    MY_CHECK(!separate && !alias);
+    my::SharedPtr<Connection> separate_back =
+        my::SharedPtr<Connection>::from_raw_parts(parts);
+    my::SharedPtr<char> alias_back = my::SharedPtr<char>::from_raw_parts(alias_parts);
+    alloc_counter::Counts delta = report("into_raw_parts + from_raw_parts", scope);
+    MY_CHECK(delta.allocations == 0);
+    MY_CHECK(separate_back->fd == 3 && separate_back.use_count() == 1);
+    MY_CHECK(alias_back.get() == packet->payload && packet.use_count() == 2);
+
+    // 成员在对象开头时地址与对象相同,但 T 不同,仍然可以往返
+    my::SharedPtr<Header> head(packet, &packet->header);
+    my::SharedPtr<Header> head_back = my::SharedPtr<Header>::from_raw(head.into_raw());
+    MY_CHECK(head_back.owner_equal(packet) && packet.use_count() == 3);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_weak_round_trip() {
+    std::cout << "\n========== 测试 3:WeakPtr 往返,期间对象过期 ==========\n";
+
+    FakeEventLoop loop;
+    my::SharedPtr<Connection> conn = my::make_shared<Connection>(9);
+    my::WeakPtr<Connection> weak = conn;
+    loop.Submit(weak.into_raw());
+    MY_CHECK(weak.expired());  // weak 已被置空
+
+    my::WeakPtr<Connection> alive =
+        my::WeakPtr<Connection>::from_raw(static_cast<Connection*>(loop.Poll()));
+    MY_CHECK(alive.lock()->fd == 9);
+
+    loop.Submit(alive.into_raw());
+    conn.Reset();  // 在途期间过期
+    MY_CHECK(g_live == 0);
+    my::WeakPtr<Connection> dead =
+        my::WeakPtr<Connection>::from_raw(static_cast<Connection*>(loop.Poll()));
+    MY_CHECK(dead.expired() && !dead.lock());
+
+    my::SharedPtr<Connection> separate(new Connection(4));
+    my::WeakPtr<Connection> separate_weak = separate;
+    my::WeakPtr<Connection> separate_back =
+        my::WeakPtr<Connection>::from_raw_parts(separate_weak.into_raw_parts());
+    MY_CHECK(separate_back.lock() == separate);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_cross_thread_handoff() {
+    std::cout << "\n========== 测试 4:跨线程交接 ==========\n";
+
+    const int COUNT = 10000;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<void*> queue;
+    bool done = false;
+
+    std::thread consumer([&]() {
+        int received = 0;
+        for (;;) {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&]() { return done || !queue.empty(); });
+            if (queue.empty()) break;
+            void* user_data = queue.front();
+            queue.pop_front();
+            lock.unlock();
+
+            my::SharedPtr<Connection> conn =
+                my::SharedPtr<Connection>::from_raw(static_cast<Connection*>(user_data));
+            ++conn->handled;
+            ++received;
+        }
+        MY_CHECK(received == COUNT);
+    });
+
+    my::SharedPtr<Connection> conn = my::make_shared<Connection>(1);
+    for (int i = 0; i < COUNT; ++i) {
+        my::SharedPtr<Connection> copy = conn;
+        void* user_data = copy.into_raw();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(user_data);
+        }
+        cv.notify_one();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+    }
+    cv.notify_one();
+    consumer.join();
+
+    MY_CHECK(conn->handled == COUNT);
+    MY_CHECK(conn.use_count() == 1);
+
+    std::cout << " 测试通过\n";
+}
+
+// ============================================================================
+// 主函数
+// ============================================================================
+
+int main() {
+    std::cout << "开始 into_raw / from_raw 测试...\n";
+
+    test_shared_round_trip();
+    test_non_inplace_uses_parts();
+    test_weak_round_trip();
+    test_cross_thread_handoff();
+    MY_CHECK(g_live == 0);
+
+    std::cout << "\n所有 into_raw / from_raw 测试通过!\n";
+    return 0;
+}
@@ -0,0 +1,172 @@
+// 统计分配次数验证延迟分配;alloc_counter.h 替换了全局 operator new/delete
+#include "alloc_counter.h"
+#include "my_lazy_shared_ptr.h"
+#include "test_check.h"
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// ============================================================================
+// 测试用类
+// ============================================================================
+
+static std::atomic<int> g_live(0);
+
+struct Widget {
+    int value;
+    explicit Widget(int v = 0) : value(v) { ++g_live; }
+    ~Widget() { --g_live; }
+};
+
+// 先取增量再打印:iostream 首次输出可能自己分配缓冲区
+alloc_counter::Counts report(const char* what, const alloc_counter::Scope& scope) {
+    alloc_counter::Counts delta = scope.Delta();
+    std::cout << "  " << what << ": 分配 " << delta.allocations << " 次, 释放 "
+              << delta.deallocations << " 次\n";
+    return delta;
+}
+
+// ============================================================================
+// 测试函数
+// ============================================================================
+
+void test_never_shared_allocates_once() {
+    std::cout << "\n========== 测试 1:从未共享只有对象本身一次分配 ==========\n";
+
+    alloc_counter::Scope scope;
+    {
+        my::LazySharedPtr<Widget> lazy(new Widget(1));
+        my::LazySharedPtr<Widget> moved = std::move(lazy);  // 移动不分配
+        MY_CHECK(!lazy && moved->value == 1);
+        MY_CHECK(!moved.shared());
+        MY_CHECK(moved.use_count() == 1 && moved.unique());
+    }
+    alloc_counter::Counts lazy_counts = report("LazySharedPtr(new T)", scope);
+    MY_CHECK(lazy_counts.allocations == 1);
+    MY_CHECK(lazy_counts.deallocations == 1);
+    MY_CHECK(g_live == 0);
+
+    scope.Reset();
+    {
+        my::SharedPtr<Widget> eager(new Widget(2));
+    }
+    alloc_counter::Counts eager_counts = report("SharedPtr(new T)", scope);
+    MY_CHECK(eager_counts.allocations == 2);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_first_copy_allocates_block() {
+    std::cout << "\n========== 测试 2:第一次拷贝才分配控制块 ==========\n";
+
+    my::LazySharedPtr<Widget> lazy(new Widget(3));
+    alloc_counter::Scope scope;
+    my::LazySharedPtr<Widget> first = lazy;
+    alloc_counter::Counts first_copy = report("第一次拷贝", scope);
+    MY_CHECK(first_copy.allocations == 1);
+    MY_CHECK(lazy.shared() && first.shared());
+    MY_CHECK(lazy.use_count() == 2);
+
+    scope.Reset();
+    my::LazySharedPtr<Widget> second = first;
+    my::LazySharedPtr<Widget> third;
+    third = second;
+    alloc_counter::Counts later = report("之后的拷贝", scope);
+    MY_CHECK(later.allocations == 0);
+    MY_CHECK(lazy.use_count() == 4);
+    MY_CHECK(third.get() == lazy.get());
+
+    lazy.Reset();
+    first.Reset();
+    second.Reset();
+    MY_CHECK(g_live == 1);
+    third.Reset();
+    MY_CHECK(g_live == 0);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_weak_and_shared_conversion() {
+    std::cout << "\n========== 测试 3:WeakPtr 与 SharedPtr 转换 ==========\n";
+
+    my::WeakPtr<Widget> weak;
+    {
+        my::LazySharedPtr<Widget> lazy(new Widget(4));
+        weak = lazy.weak();  // 创建弱引用也会分配控制块
+        MY_CHECK(lazy.shared());
+        MY_CHECK(lazy.use_count() == 1);
+        MY_CHECK(weak.lock()->value == 4);
+
+        my::SharedPtr<Widget> sp = lazy;  // 左值:共享
+        MY_CHECK(sp.get() == lazy.get());
+        MY_CHECK(lazy.use_count() == 2);
+    }
+    MY_CHECK(weak.expired());
+    MY_CHECK(g_live == 0);
+
+    // 右值:独占状态下直接把所有权交给 SharedPtr
+    my::LazySharedPtr<Widget> lazy(new Widget(5));
+    alloc_counter::Scope scope;
+    my::SharedPtr<Widget> sp = std::move(lazy);
+    alloc_counter::Counts moved = report("独占 -> SharedPtr", scope);
+    MY_CHECK(moved.allocations == 1);  // 只有控制块
+    MY_CHECK(!lazy);
+    MY_CHECK(sp->value == 5 && sp.use_count() == 1);
+
+    my::LazySharedPtr<Widget> empty;
+    MY_CHECK(!my::SharedPtr<Widget>(empty));
+    MY_CHECK(empty.weak().expired());
+    MY_CHECK(empty.use_count() == 0);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_concurrent_first_copy() {
+    std::cout << "\n========== 测试 4:并发的首次共享只留下一个控制块 ==========\n";
+
+    const int NUM_THREADS = 4;
+    const int ROUNDS = 200;
+    for (int round = 0; round < ROUNDS; ++round) {
+        my::LazySharedPtr<Widget> lazy(new Widget(round));
+        std::atomic<bool> go(false);
+        std::vector<my::LazySharedPtr<Widget>> copies(NUM_THREADS);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < NUM_THREADS; ++t) {
+            threads.emplace_back([&, t]() {
+                while (!go.load(std::memory_order_acquire)) {
+                }
+                copies[t] = lazy;
+            });
+        }
+        go.store(true, std::memory_order_release);
+        for (auto& th : threads) th.join();
+
+        MY_CHECK(lazy.use_count() == NUM_THREADS + 1);
+        for (int t = 0; t < NUM_THREADS; ++t) {
+            MY_CHECK(copies[t].get() == lazy.get());
+        }
+    }
+    MY_CHECK(g_live == 0);
+    std::cout << "完成 " << ROUNDS << " 轮\n";
+
+    std::cout << " 测试通过\n";
+}
+
+// ============================================================================
+// 主函数
+// ============================================================================
+
+int main() {
+    std::cout << "开始 LazySharedPtr 测试...\n";
+
+    test_never_shared_allocates_once();
+    test_first_copy_allocates_block();
+    test_weak_and_shared_conversion();
+    test_concurrent_first_copy();
+
+    std::cout << "\n所有 LazySharedPtr 测试通过!\n";
+    return 0;
+}
@@ -0,0 +1,263 @@
+// 以 -DMY_SP_ENABLE_TRACE_RING -DMY_SP_TRACE_RING_CAPACITY=1024 编译(见 CMakeLists.txt)
+#include "my_lazy_shared_ptr.h"
+#include "my_lifecycle_trace.h"
+#include "my_make_shared.h"
+#include "my_weak_ptr.h"
+#include "test_check.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <set>
+#include <string>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+
+#ifndef MY_SP_ENABLE_TRACE_RING
+#error "test_lifecycle_trace 需要定义 MY_SP_ENABLE_TRACE_RING"
+#endif
+
+// ============================================================================
+// 测试用类
+// ============================================================================
+
+struct Traced {
+    int value = 0;
+};
+
+// 某个控制块的事件序列
+std::vector<my::TraceRecord> events_of(const std::vector<my::TraceRecord>& records,
+                                      uint64_t block) {
+    std::vector<my::TraceRecord> result;
+    for (const my::TraceRecord& record : records) {
+        if (record.block == block) result.push_back(record);
+    }
+    return result;
+}
+
+// 第一个类型为 T 的 create 记录对应的控制块
+template <typename T>
+uint64_t find_created(const std::vector<my::TraceRecord>& records) {
+    for (const my::TraceRecord& record : records) {
+        if (record.event == my::kTraceCreate &&
+            reinterpret_cast<const char*>(record.value) == typeid(T).name()) {
+            return record.block;
+        }
+    }
+    return 0;
+}
+
+// ============================================================================
+// 测试函数
+// ============================================================================
+
+void test_lifecycle_sequence() {
+    std::cout << "\n========== 测试 1:一个对象的完整生命周期 ==========\n";
+
+    my::trace_reset();
+    {
+        my::SharedPtr<Traced> sp = my::make_shared<Traced>();   // create
+        my::SharedPtr<Traced> copy = sp;                        // copy -> 2
+        my::WeakPtr<Traced> weak = sp;
+        {
+            my::SharedPtr<Traced> locked = weak.lock();         // weak_lock -> 3
+        }                                                       // release -> 2
+        copy.Reset();                                           // release -> 1
+        sp.Reset();                                             // release -> 0, dispose
+        MY_CHECK(!weak.lock());                                 // weak_lock_failed
+    }                                                           // destroy
+
+    std::vector<my::TraceRecord> records = my::trace_snapshot();
+    uint64_t block = find_created<Traced>(records);
+    assert(block != 0);
+    std::vector<my::TraceRecord> seq = events_of(records, block);
+
+    const uint16_t expected_events[] = {
+        my::kTraceCreate, my::kTraceCopy, my::kTraceWeakLock, my::kTraceRelease,
+        my::kTraceRelease, my::kTraceRelease, my::kTraceDispose,
+        my::kTraceWeakLockFailed, my::kTraceDestroy};
+    const int64_t expected_values[] = {-1, 2, 3, 2, 1, 0, 0, 0, 0};
+    for (const my::TraceRecord& record : seq) {
+        std::cout << "  " << my::trace_event_name(record.event) << " " << record.value << "\n";
+    }
+    MY_CHECK(seq.size() == sizeof(expected_events) / sizeof(expected_events[0]));
+    for (size_t i = 0; i < seq.size(); ++i) {
+        MY_CHECK(seq[i].event == expected_events[i]);
+        if (expected_values[i] >= 0) MY_CHECK(seq[i].value == expected_values[i]);
+        if (i > 0) MY_CHECK(seq[i].timestamp_ns >= seq[i - 1].timestamp_ns);
+    }
+
+    std::cout << " 测试通过\n";
+}
+
+void test_dump_round_trip() {
+    std::cout << "\n========== 测试 2:转储文件读回 ==========\n";
+
+    my::trace_reset();
+    {
+        my::SharedPtr<Traced> sp = my::make_shared<Traced>();
+        my::SharedPtr<Traced> copy = sp;
+    }
+    std::vector<my::TraceRecord> records = my::trace_snapshot();
+
+    const std::string path = "test_lifecycle_trace.bin";
+    int64_t written = my::trace_dump(path);
+    std::cout << "写入 " << written << " 条记录\n";
+    MY_CHECK(written == static_cast<int64_t>(records.size()));
+
+    my::TraceFile file;
+    MY_CHECK(my::read_trace_file(path, &file));
+    MY_CHECK(file.records.size() == records.size());
+    uint64_t block = find_created<Traced>(records);
+    bool found_name = false;
+    for (const my::TraceRecord& record : file.records) {
+        if (record.block == block && record.event == my::kTraceCreate) {
+            found_name = file.type_names[record.value] == typeid(Traced).name();
+        }
+    }
+    MY_CHECK(found_name);
+    std::remove(path.c_str());
+
+    std::cout << " 测试通过\n";
+}
+
+void test_corrupt_file_rejected() {
+    std::cout << "\n========== 测试 2b:截断或损坏的文件 ==========\n";
+
+    my::trace_reset();
+    {
+        my::SharedPtr<Traced> sp = my::make_shared<Traced>();
+    }
+    const std::string path = "test_lifecycle_trace_corrupt.bin";
+    MY_CHECK(my::trace_dump(path) > 0);
+    std::string bytes;
+    {
+        std::ifstream in(path.c_str(), std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    const size_t kCountOffset = 8 + 4 + 4;  // 魔数、版本、记录大小之后
+
+    // 记录数被改成天文数字:读取前就拒绝,不做巨大的分配
+    std::string huge = bytes;
+    uint64_t count = uint64_t(1) << 50;
+    std::memcpy(&huge[kCountOffset], &count, sizeof(count));
+    std::ofstream(path.c_str(), std::ios::binary).write(huge.data(), huge.size());
+    my::TraceFile file;
+    MY_CHECK(!my::read_trace_file(path, &file));
+
+    // 截断在记录中间和类型名表中间
+    for (size_t keep : {kCountOffset + 8 + 10, bytes.size() - 3}) {
+        std::ofstream(path.c_str(), std::ios::binary).write(bytes.data(), keep);
+        MY_CHECK(!my::read_trace_file(path, &file));
+    }
+
+    // 原样写回仍能读取
+    std::ofstream(path.c_str(), std::ios::binary).write(bytes.data(), bytes.size());
+    MY_CHECK(my::read_trace_file(path, &file));
+    std::remove(path.c_str());
+
+    std::cout << " 测试通过\n";
+}
+
+void test_per_thread_rings() {
+    std::cout << "\n========== 测试 3:每线程独立的环 ==========\n";
+
+    my::trace_reset();
+    const int NUM_THREADS = 4;
+    my::SharedPtr<Traced> shared = my::make_shared<Traced>();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NUM_THREADS; ++t) {
+        threads.emplace_back([shared]() {
+            for (int i = 0; i < 100; ++i) {
+                my::SharedPtr<Traced> copy = shared;
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    std::vector<my::TraceRecord> records = my::trace_snapshot();
+    std::set<uint32_t> writers;
+    for (const my::TraceRecord& record : records) {
+        if (record.event == my::kTraceCopy) writers.insert(record.thread);
+    }
+    std::cout << "记录 " << records.size() << " 条, 来自 " << writers.size() << " 个线程\n";
+    // 每个工作线程 100 次拷贝 + 100 次释放;lambda 捕获本身还有拷贝和释放
+    assert(writers.size() >= static_cast<size_t>(NUM_THREADS));
+    assert(records.size() >= static_cast<size_t>(NUM_THREADS * 200));
+
+    std::cout << " 测试通过\n";
+}
+
+void test_ring_overwrites_oldest() {
+    std::cout << "\n========== 测试 4:写满后保留最新的记录 ==========\n";
+
+    my::trace_reset();
+    my::SharedPtr<Traced> sp = my::make_shared<Traced>();
+    const int kCopies = 5000;  // 每次拷贝 + 释放 = 2 条,远超容量 1024
+    for (int i = 0; i < kCopies; ++i) {
+        my::SharedPtr<Traced> copy = sp;
+    }
+    std::vector<my::TraceRecord> records = my::trace_snapshot();
+    std::cout << "保留 " << records.size() << " 条\n";
+    assert(records.size() == MY_SP_TRACE_RING_CAPACITY);
+    // 最早的 create 已被覆盖,最后一条是最后一次释放
+    assert(find_created<Traced>(records) == 0);
+    assert(records.back().event == my::kTraceRelease);
+    assert(records.back().value == 1);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_lazy_spare_block_destroyed() {
+    std::cout << "\n========== 测试 5:丢弃未交出的控制块记录 destroy ==========\n";
+
+    // LazySharedPtr 并发首次共享时,CAS 落败方用 DestroyUnshared() 丢弃自己
+    // 分配的控制块:对象不析构,但 create 之后必须有 destroy,
+    // 否则分析工具会把它当作存活
+    my::trace_reset();
+    Traced object;
+    my::detail::SpCountedBase* spare = new my::detail::SpCountedImplPointer<Traced>(&object);
+    spare->DestroyUnshared();
+
+    std::vector<my::TraceRecord> records = my::trace_snapshot();
+    uint64_t block = find_created<Traced>(records);
+    MY_CHECK(block != 0);
+    std::vector<my::TraceRecord> seq = events_of(records, block);
+    MY_CHECK(seq.size() == 2);
+    MY_CHECK(seq[0].event == my::kTraceCreate && seq[1].event == my::kTraceDestroy);
+
+    // 没有竞争的首次共享:控制块照常经 Release 记录 destroy
+    my::trace_reset();
+    {
+        my::LazySharedPtr<Traced> lazy(new Traced);
+        my::LazySharedPtr<Traced> copy = lazy;
+    }
+    records = my::trace_snapshot();
+    block = find_created<Traced>(records);
+    MY_CHECK(block != 0);
+    MY_CHECK(events_of(records, block).back().event == my::kTraceDestroy);
+
+    std::cout << " 测试通过\n";
+}
+
+// ============================================================================
+// 主函数
+// ============================================================================
+
+int main() {
+    std::cout << "开始生命周期跟踪测试...\n";
+
+    test_lifecycle_sequence();
+    test_dump_round_trip();
+    test_corrupt_file_rejected();
+    test_per_thread_rings();
+    test_ring_overwrites_oldest();
+    test_lazy_spare_block_destroyed();
+
+    std::cout << "\n所有生命周期跟踪测试通过!\n";
+    return 0;
+}
@@ -0,0 +1,142 @@
+// 以 -DMY_SP_ENABLE_LIVE_REGISTRY 编译(见 CMakeLists.txt)
+#include "my_live_registry.h"
+#include "my_make_shared.h"
+#include "my_weak_ptr.h"
+#include "test_check.h"
+
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#ifndef MY_SP_ENABLE_LIVE_REGISTRY
+#error "test_live_registry 需要定义 MY_SP_ENABLE_LIVE_REGISTRY"
+#endif
+
+// ============================================================================
+// 测试用类
+// ============================================================================
+
+struct Payload {
+    explicit Payload(int v) : value(v) {}
+    int value;
+    char padding[60];
+};
+
+struct LeakyNode {
+    explicit LeakyNode(int v) : value(v) {}
+    int value;
+    my::SharedPtr<LeakyNode> next;  // 强引用环:永远不会释放
+};
+
+// ============================================================================
+// 测试函数
+// ============================================================================
+
+void test_track_and_untrack() {
+    std::cout << "\n========== 测试 1:控制块登记与注销 ==========\n";
+
+    size_t before = my::live_object_count();
+    {
+        my::SharedPtr<Payload> a(new Payload(1));
+        my::SharedPtr<Payload> b = my::make_shared<Payload>(2);
+        my::SharedPtr<int> c(new int(3), [](int* p) { delete p; });
+        MY_CHECK(my::live_object_count() == before + 3);
+
+        // 弱引用让控制块多活一会儿:对象已析构,但控制块仍在
+        my::WeakPtr<Payload> weak = a;
+        a.Reset();
+        MY_CHECK(my::live_object_count() == before + 3);
+    }
+    std::cout << "作用域结束后存活: " << my::live_object_count() << "\n";
+    MY_CHECK(my::live_object_count() == before);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_dump_groups_by_site() {
+    std::cout << "\n========== 测试 2:按分配点汇总 ==========\n";
+
+    std::vector<my::SharedPtr<Payload>> objects;
+    for (int i = 0; i < 10; ++i) {
+        objects.push_back(my::make_shared<Payload>(i));  // 同一个分配点
+    }
+    my::SharedPtr<Payload> extra = objects[0];
+    my::WeakPtr<Payload> weak = objects[1];
+
+    std::ostringstream report;
+    size_t dumped = my::dump_live_objects(report);
+    std::cout << report.str();
+
+    const std::string text = report.str();
+    const std::string payload_name = typeid(Payload).name();
+    MY_CHECK(dumped == objects.size());
+    MY_CHECK(text.find("10 个 " + payload_name) != std::string::npos);
+    MY_CHECK(text.find("合计 " + std::to_string(10 * sizeof(Payload))) !=
+             std::string::npos);
+    // 10 个对象共 11 个强引用;每个控制块 1 个隐含弱引用,外加 weak
+    MY_CHECK(text.find("strong=11 weak=11") != std::string::npos);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_sampling() {
+    std::cout << "\n========== 测试 3:1/N 采样 ==========\n";
+
+    my::set_live_registry_sample_rate(4);
+    size_t before = my::live_object_count();
+    {
+        std::vector<my::SharedPtr<int>> objects;
+        for (int i = 0; i < 100; ++i) {
+            objects.push_back(my::make_shared<int>(i));
+        }
+        size_t tracked = my::live_object_count() - before;
+        std::cout << "100 个对象中登记了 " << tracked << " 个\n";
+        assert(tracked == 25);
+    }
+    MY_CHECK(my::live_object_count() == before);  // 未登记的控制块注销时不查表
+    my::set_live_registry_sample_rate(1);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_cycle_leak_is_reported() {
+    std::cout << "\n========== 测试 4:循环引用泄漏 ==========\n";
+
+    size_t before = my::live_object_count();
+    {
+        my::SharedPtr<LeakyNode> n1 = my::make_shared<LeakyNode>(1);
+        my::SharedPtr<LeakyNode> n2 = my::make_shared<LeakyNode>(2);
+        n1->next = n2;
+        n2->next = n1;  // 同 test_cycle.cc 的 BadNode
+    }
+    std::cout << "离开作用域后仍存活: " << my::live_object_count() - before << "\n";
+    MY_CHECK(my::live_object_count() == before + 2);
+
+    std::ostringstream report;
+    my::dump_live_objects(report);
+    assert(report.str().find(typeid(LeakyNode).name()) != std::string::npos);
+
+    std::cout << "进程退出时会在 stderr 打印这两个对象\n";
+    std::cout << " 测试通过\n";
+}
+
+// ============================================================================
+// 主函数
+// ============================================================================
+
+int main() {
+    std::cout << "\n";
+    std::cout << "╔══════════════════════════════════════╗\n";
+    std::cout << "║   存活控制块注册表与泄漏报告         ║\n";
+    std::cout << "╚══════════════════════════════════════╝\n";
+
+    test_track_and_untrack();
+    test_dump_groups_by_site();
+    test_sampling();
+    test_cycle_leak_is_reported();  // 必须最后执行:故意泄漏
+
+    return 0;
+}
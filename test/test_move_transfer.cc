@@ -0,0 +1,210 @@
+// 以 -DMY_SP_ENABLE_REFCOUNT_PROFILER 编译(见 CMakeLists.txt)
+// 用每线程计数断言:所有权转移(移动、转换、类型转换、别名)不产生任何计数操作
+#include "my_make_shared.h"
+#include "my_pointer_cast.h"
+#include "my_refcount_profiler.h"
+#include "my_weak_ptr.h"
+#include "test_check.h"
+
+#include <iostream>
+#include <utility>
+
+#ifndef MY_SP_ENABLE_REFCOUNT_PROFILER
+#error "test_move_transfer 需要定义 MY_SP_ENABLE_REFCOUNT_PROFILER"
+#endif
+
+// ============================================================================
+// 测试用类
+// ============================================================================
+
+struct Base {
+    virtual ~Base() = default;
+    int base_value = 1;
+};
+
+struct Derived : Base {
+    int derived_value = 2;
+};
+
+struct Other : Base {};
+
+struct Pair {
+    int first = 10;
+    int second = 20;
+};
+
+// 两次快照之间当前线程的计数操作
+struct OpDelta {
+    uint64_t copy;
+    uint64_t release;
+    uint64_t weak;
+    uint64_t lock;
+
+    uint64_t total() const { return copy + release + weak + lock; }
+};
+
+class OpScope {
+public:
+    OpScope() : start_(my::refcount_thread_op_counts()) {}
+
+    OpDelta Delta() const {
+        my::RefcountOpCounts now = my::refcount_thread_op_counts();
+        OpDelta delta = {now.add_ref_copy - start_.add_ref_copy, now.release - start_.release,
+                         now.weak_add_ref - start_.weak_add_ref,
+                         now.add_ref_lock - start_.add_ref_lock};
+        return delta;
+    }
+
+private:
+    my::RefcountOpCounts start_;
+};
+
+void report(const char* what, const OpDelta& delta) {
+    std::cout << "  " << what << ": copy=" << delta.copy << " release=" << delta.release
+              << " weak=" << delta.weak << " lock=" << delta.lock << "\n";
+}
+
+// ============================================================================
+// 测试函数
+// ============================================================================
+
+void test_make_shared_no_extra_ops() {
+    std::cout << "\n========== 测试 1:make_shared 不产生计数操作 ==========\n";
+
+    OpScope scope;
+    my::SharedPtr<Derived> sp = my::make_shared<Derived>();
+    OpDelta delta = scope.Delta();
+    report("make_shared", delta);
+    MY_CHECK(delta.total() == 0);
+    MY_CHECK(sp.use_count() == 1);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_converting_move() {
+    std::cout << "\n========== 测试 2:转换构造与赋值的右值版本 ==========\n";
+
+    my::SharedPtr<Derived> derived = my::make_shared<Derived>();
+    my::SharedPtr<Derived> replacement = my::make_shared<Derived>();
+    Derived* raw = replacement.get();
+
+    OpScope scope;
+    my::SharedPtr<Base> base(std::move(derived));  // 转换构造
+    base = std::move(replacement);                 // 转换赋值,释放旧对象
+    OpDelta delta = scope.Delta();
+    report("convert", delta);
+
+    MY_CHECK(!derived && !replacement);
+    MY_CHECK(base.get() == raw);
+    MY_CHECK(base.use_count() == 1);
+    MY_CHECK(delta.copy == 0);
+    MY_CHECK(delta.release == 1);  // 只有 base 原来指向的对象被释放
+
+    std::cout << " 测试通过\n";
+}
+
+void test_casts_move() {
+    std::cout << "\n========== 测试 3:类型转换的右值版本 ==========\n";
+
+    my::SharedPtr<Base> base = my::make_shared<Derived>();
+    Base* raw = base.get();
+
+    OpScope scope;
+    my::SharedPtr<Derived> down = my::static_pointer_cast<Derived>(std::move(base));
+    my::SharedPtr<const Derived> constant = std::move(down);
+    my::SharedPtr<Derived> mutable_again = my::const_pointer_cast<Derived>(std::move(constant));
+    my::SharedPtr<Base> up = std::move(mutable_again);
+    my::SharedPtr<Derived> dyn = my::dynamic_pointer_cast<Derived>(std::move(up));
+    OpDelta delta = scope.Delta();
+    report("casts", delta);
+
+    MY_CHECK(delta.total() == 0);
+    MY_CHECK(!base && !down && !constant && !mutable_again && !up);
+    MY_CHECK(dyn.get() == raw);
+    MY_CHECK(dyn.use_count() == 1);
+
+    // 失败的 dynamic_pointer_cast 不接管所有权,源保持不变
+    my::SharedPtr<Base> keep = std::move(dyn);
+    OpScope fail_scope;
+    my::SharedPtr<Other> other = my::dynamic_pointer_cast<Other>(std::move(keep));
+    MY_CHECK(fail_scope.Delta().total() == 0);
+    MY_CHECK(!other);
+    MY_CHECK(keep.get() == raw);
+    MY_CHECK(keep.use_count() == 1);
+
+    // 左值版本仍然共享所有权
+    OpScope copy_scope;
+    my::SharedPtr<Derived> shared = my::static_pointer_cast<Derived>(keep);
+    MY_CHECK(copy_scope.Delta().copy == 1);
+    MY_CHECK(keep.use_count() == 2);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_aliasing_move() {
+    std::cout << "\n========== 测试 4:别名构造的右值版本 ==========\n";
+
+    my::SharedPtr<Pair> pair = my::make_shared<Pair>();
+    int* second = &pair->second;
+
+    OpScope scope;
+    my::SharedPtr<int> member(std::move(pair), second);
+    OpDelta delta = scope.Delta();
+    report("alias", delta);
+
+    MY_CHECK(delta.total() == 0);
+    MY_CHECK(!pair);
+    MY_CHECK(member.get() == second);
+    MY_CHECK(*member == 20);
+    MY_CHECK(member.use_count() == 1);
+
+    // 别名指针是唯一所有者,释放它会析构整个 Pair
+    my::WeakPtr<int> weak = member;
+    member.Reset();
+    MY_CHECK(weak.expired());
+
+    std::cout << " 测试通过\n";
+}
+
+void test_weak_move() {
+    std::cout << "\n========== 测试 5:WeakPtr 移动与转换 ==========\n";
+
+    my::SharedPtr<Derived> sp = my::make_shared<Derived>();
+    my::WeakPtr<Derived> weak = sp;
+
+    OpScope scope;
+    my::WeakPtr<Base> base_weak(std::move(weak));
+    my::WeakPtr<Base> assigned;
+    assigned = std::move(base_weak);
+    OpDelta delta = scope.Delta();
+    report("weak move", delta);
+    MY_CHECK(delta.total() == 0);
+    MY_CHECK(assigned.use_count() == 1);
+
+    // 提升为强引用必须经过 AddRefLock,这一次无法省掉
+    OpScope lock_scope;
+    my::SharedPtr<Base> locked = my::WeakPtr<Base>(std::move(assigned)).lock();
+    OpDelta lock_delta = lock_scope.Delta();
+    report("lock temporary", lock_delta);
+    MY_CHECK(lock_delta.lock == 1 && lock_delta.copy == 0);
+    MY_CHECK(locked.get() == sp.get());
+
+    std::cout << " 测试通过\n";
+}
+
+// ============================================================================
+// 主函数
+// ============================================================================
+
+int main() {
+    std::cout << "开始所有权转移测试...\n";
+
+    test_make_shared_no_extra_ops();
+    test_converting_move();
+    test_casts_move();
+    test_aliasing_move();
+    test_weak_move();
+
+    std::cout << "\n所有所有权转移测试通过!\n";
+    return 0;
+}
@@ -0,0 +1,235 @@
+#include "my_make_shared.h"
+#include "my_on_expire.h"
+#include "my_weak_ptr.h"
+#include "test_check.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// 测试用类
+// ============================================================================
+
+class Widget {
+public:
+    Widget(int id) : id_(id) {
+        ++alive_count;
+    }
+
+    ~Widget() {
+        --alive_count;
+    }
+
+    int id_;
+    static std::atomic<int> alive_count;
+};
+
+std::atomic<int> Widget::alive_count{0};
+
+// ============================================================================
+// 测试函数
+// ============================================================================
+
+void test_callback_runs_after_dispose() {
+    std::cout << "\n========== 测试 1:回调在 Dispose() 之后执行 ==========\n";
+
+    int fired = 0;
+    int alive_at_callback = -1;
+    bool expired_at_callback = false;
+
+    my::SharedPtr<Widget> sp = my::make_shared<Widget>(1);
+    my::WeakPtr<Widget> wp = sp;
+
+    my::on_expire(sp, [&]() {
+        ++fired;
+        alive_at_callback = Widget::alive_count;
+        expired_at_callback = wp.expired();
+    });
+
+    my::SharedPtr<Widget> copy = sp;
+    sp.Reset();
+    assert(fired == 0);  // 还有强引用
+
+    copy.Reset();
+    std::cout << "回调次数: " << fired << ", 回调时存活对象: " << alive_at_callback << "\n";
+    assert(fired == 1);
+    assert(alive_at_callback == 0);  // 对象已析构
+    assert(expired_at_callback);
+
+    std::cout << " 测试通过:回调恰好执行一次,且在析构之后\n";
+}
+
+void test_multiple_listeners_and_cancel() {
+    std::cout << "\n========== 测试 2:多个监听器与取消 ==========\n";
+
+    std::vector<int> order;
+    my::SharedPtr<Widget> sp(new Widget(2));
+
+    my::on_expire(sp, [&order]() { order.push_back(1); });
+    my::ExpiryListenerHandle handle = my::on_expire(sp, [&order]() { order.push_back(2); });
+    my::on_expire(sp, [&order]() { order.push_back(3); });
+
+    assert(handle);
+    MY_CHECK(handle.Cancel());   // 取消成功
+    MY_CHECK(!handle.Cancel());  // 句柄已清空
+
+    sp.Reset();
+
+    // 后注册先执行,被取消的监听器跳过
+    MY_CHECK(order.size() == 2);
+    MY_CHECK(order[0] == 3);
+    MY_CHECK(order[1] == 1);
+
+    std::cout << " 测试通过:取消的监听器不执行,执行顺序同 atexit\n";
+}
+
+void test_cancel_after_fire() {
+    std::cout << "\n========== 测试 3:触发后取消 ==========\n";
+
+    int fired = 0;
+    my::ExpiryListenerHandle handle;
+    {
+        my::SharedPtr<Widget> sp = my::make_shared<Widget>(3);
+        handle = my::on_expire(sp, [&fired]() { ++fired; });
+    }
+
+    // 句柄持有弱引用,控制块仍在,Cancel() 安全并如实返回 false
+    assert(fired == 1);
+    MY_CHECK(!handle.Cancel());
+
+    std::cout << " 测试通过:触发后取消返回 false\n";
+}
+
+void test_custom_deleter_block() {
+    std::cout << "\n========== 测试 4:自定义删除器 ==========\n";
+
+    bool deleter_ran_first = false;
+    bool closed = false;
+    {
+        my::SharedPtr<int> handle(new int(42), [&closed](int* p) {
+            closed = true;
+            delete p;
+        });
+        my::on_expire(handle, [&]() { deleter_ran_first = closed; });
+    }
+    assert(deleter_ran_first);
+
+    // 空指针不注册
+    my::SharedPtr<Widget> empty;
+    assert(!my::on_expire(empty, []() {}));
+
+    std::cout << " 测试通过:删除器先于监听器执行\n";
+}
+
+void test_concurrent_registration() {
+    std::cout << "\n========== 测试 5:并发注册 ==========\n";
+
+    constexpr int NUM_THREADS = 8;
+    constexpr int PER_THREAD = 1000;
+
+    std::atomic<int> fired{0};
+    std::atomic<int> cancelled{0};
+    my::SharedPtr<Widget> sp = my::make_shared<Widget>(5);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NUM_THREADS; ++t) {
+        threads.emplace_back([sp, &fired, &cancelled]() {
+            for (int i = 0; i < PER_THREAD; ++i) {
+                my::ExpiryListenerHandle h = my::on_expire(sp, [&fired]() { ++fired; });
+                if (i % 4 == 0 && h.Cancel()) {
+                    ++cancelled;
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    sp.Reset();
+    std::cout << "触发: " << fired.load() << ", 取消: " << cancelled.load() << "\n";
+    assert(fired + cancelled == NUM_THREADS * PER_THREAD);
+    assert(Widget::alive_count == 0);
+
+    std::cout << " 测试通过:无锁注册不丢失监听器\n";
+}
+
+// 统计存活的回调对象,即尚未释放的监听器节点
+struct CountedCallback {
+    static std::atomic<int> live;
+    std::atomic<int>* fired;
+
+    explicit CountedCallback(std::atomic<int>* f) : fired(f) { ++live; }
+    CountedCallback(const CountedCallback& other) : fired(other.fired) { ++live; }
+    ~CountedCallback() { --live; }
+
+    void operator()() { ++*fired; }
+};
+
+std::atomic<int> CountedCallback::live{0};
+
+void test_cancelled_listeners_are_freed() {
+    std::cout << "\n========== 测试 6:反复注册并取消不会无限增长 ==========\n";
+
+    constexpr int ROUNDS = 100000;
+    std::atomic<int> fired{0};
+    my::SharedPtr<Widget> sp = my::make_shared<Widget>(6);
+    my::ExpiryListenerHandle keep = my::on_expire(sp, CountedCallback(&fired));
+
+    for (int i = 0; i < ROUNDS; ++i) {
+        my::ExpiryListenerHandle h = my::on_expire(sp, CountedCallback(&fired));
+        MY_CHECK(h.Cancel());
+    }
+    // 被取消的节点在下次注册时释放;最多留下最近的一个
+    std::cout << ROUNDS << " 次注册并取消后存活节点: " << CountedCallback::live.load() << "\n";
+    MY_CHECK(CountedCallback::live <= 2);
+
+    // 多线程同时注册、取消
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([sp, &fired]() {
+            for (int i = 0; i < ROUNDS / 10; ++i) {
+                my::ExpiryListenerHandle h = my::on_expire(sp, CountedCallback(&fired));
+                h.Cancel();
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    my::on_expire(sp, CountedCallback(&fired)).Cancel();
+    my::on_expire(sp, CountedCallback(&fired));  // 触发清理,自己保留到对象死亡
+    std::cout << "并发注册并取消后存活节点: " << CountedCallback::live.load() << "\n";
+    MY_CHECK(CountedCallback::live <= 4);
+
+    sp.Reset();
+    assert(fired == 2);  // keep 和最后注册的那个
+    keep = my::ExpiryListenerHandle();  // 句柄的弱引用是最后一个,节点随控制块释放
+    MY_CHECK(CountedCallback::live == 0);
+
+    std::cout << " 测试通过:取消的节点被及时释放\n";
+}
+
+// ============================================================================
+// 主函数
+// ============================================================================
+
+int main() {
+    std::cout << "\n";
+    std::cout << "╔══════════════════════════════════════╗\n";
+    std::cout << "║   on_expire: 控制块过期回调          ║\n";
+    std::cout << "╚══════════════════════════════════════╝\n";
+
+    test_callback_runs_after_dispose();
+    test_multiple_listeners_and_cancel();
+    test_cancel_after_fire();
+    test_custom_deleter_block();
+    test_concurrent_registration();
+    test_cancelled_listeners_are_freed();
+
+    return 0;
+}
@@ -0,0 +1,154 @@
+#include "my_make_shared.h"
+#include "my_owner_hash.h"
+#include "my_weak_ptr.h"
+#include "test_check.h"
+
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+// ============================================================================
+// 测试用类
+// ============================================================================
+
+struct Session {
+    int id;
+    std::string user;
+
+    Session(int i, const std::string& u) : id(i), user(u) {}
+};
+
+// ============================================================================
+// 测试函数
+// ============================================================================
+
+void test_owner_functors_mixed_types() {
+    std::cout << "\n========== 测试 1:混合类型的所有权比较 ==========\n";
+
+    my::SharedPtr<Session> a = my::make_shared<Session>(1, "alice");
+    my::SharedPtr<Session> b = my::make_shared<Session>(2, "bob");
+    my::WeakPtr<Session> wa = a;
+    my::SharedPtr<std::string> alias(a, &a->user);  // 别名:同一所有者
+
+    my::OwnerHash hash;
+    my::OwnerEqual equal;
+    my::OwnerLess less;
+
+    MY_CHECK(equal(a, wa));
+    MY_CHECK(equal(alias, wa));
+    MY_CHECK(equal(a, a.owner_key()));
+    MY_CHECK(!equal(a, b));
+    MY_CHECK(hash(a) == hash(wa));
+    MY_CHECK(hash(alias) == hash(a.owner_key()));
+    MY_CHECK(less(a, b) != less(b, a));
+    MY_CHECK(!less(a, alias) && !less(alias, a));
+
+    // 比较和哈希不改动引用计数
+    assert(a.use_count() == 2);  // a + alias
+
+    std::cout << " 测试通过:所有权比较正确\n";
+}
+
+void test_unordered_weak_registry() {
+    std::cout << "\n========== 测试 2:WeakPtr 哈希注册表 ==========\n";
+
+    std::unordered_set<my::WeakPtr<Session>, my::OwnerHash, my::OwnerEqual> registry;
+
+    my::SharedPtr<Session> s1 = my::make_shared<Session>(1, "alice");
+    my::SharedPtr<Session> s2(new Session(2, "bob"));
+
+    registry.insert(s1);
+    registry.insert(s2);
+    registry.insert(my::WeakPtr<Session>(s1));  // 重复
+    assert(registry.size() == 2);
+
+    assert(registry.count(my::WeakPtr<Session>(s2)) == 1);
+
+    // 对象过期后控制块仍在,哈希和相等性保持稳定,仍可查找并删除
+    const void* key = s2.owner_key();
+    my::WeakPtr<Session> w2 = s2;
+    s2.Reset();
+    assert(w2.expired());
+    MY_CHECK(w2.owner_key() == key);
+    MY_CHECK(registry.erase(w2) == 1);
+    assert(registry.size() == 1);
+
+    std::cout << " 测试通过:无序容器按所有权去重与查找\n";
+}
+
+void test_ordered_lookup_without_temporary() {
+    std::cout << "\n========== 测试 3:OwnerLess 有序容器 ==========\n";
+
+    std::set<my::WeakPtr<Session>, my::OwnerLess> ordered;
+
+    my::SharedPtr<Session> s1 = my::make_shared<Session>(1, "alice");
+    my::SharedPtr<Session> s2 = my::make_shared<Session>(2, "bob");
+    ordered.insert(s1);
+    ordered.insert(s2);
+    assert(ordered.size() == 2);
+
+#if __cplusplus >= 201402L
+    // 透明查找(test_owner_hash_cxx14 目标):直接用 SharedPtr / owner_key()
+    // 查找,不构造临时 WeakPtr
+    std::cout << "C++14 透明查找\n";
+    assert(ordered.find(s1) != ordered.end());
+    assert(ordered.find(s2.owner_key()) != ordered.end());
+    assert(ordered.count(s1) == 1);
+    my::SharedPtr<Session> other = my::make_shared<Session>(3, "carol");
+    assert(ordered.find(other) == ordered.end());
+    ordered.erase(ordered.find(s2.owner_key()));  // 异构 erase(key) 要到 C++23
+    assert(ordered.size() == 1);
+#else
+    // C++11:find() 只接受键类型,要先构造 WeakPtr
+    std::cout << "C++11 按 WeakPtr 查找\n";
+    assert(ordered.find(my::WeakPtr<Session>(s1)) != ordered.end());
+#endif
+    assert(s1.use_count() == 1);
+
+    std::cout << " 测试通过:有序容器按所有权查找\n";
+}
+
+void test_std_hash_shared_ptr() {
+    std::cout << "\n========== 测试 4:std::hash<SharedPtr> ==========\n";
+
+    my::SharedPtr<Session> s1 = my::make_shared<Session>(1, "alice");
+    my::SharedPtr<Session> s1_copy = s1;
+    my::SharedPtr<Session> s2 = my::make_shared<Session>(2, "bob");
+
+    // 与 operator== 一致:按 get() 哈希
+    assert(std::hash<my::SharedPtr<Session>>()(s1) ==
+           std::hash<my::SharedPtr<Session>>()(s1_copy));
+    assert(std::hash<my::SharedPtr<Session>>()(s1) ==
+           std::hash<Session*>()(s1.get()));
+
+    std::unordered_map<my::SharedPtr<Session>, int> visits;
+    visits[s1] += 1;
+    visits[s1_copy] += 1;
+    visits[s2] += 1;
+    assert(visits.size() == 2);
+    assert(visits[s1] == 2);
+
+    std::cout << " 测试通过:SharedPtr 可直接作为无序容器的键\n";
+}
+
+// ============================================================================
+// 主函数
+// ============================================================================
+
+int main() {
+    std::cout << "\n";
+    std::cout << "╔══════════════════════════════════════╗\n";
+    std::cout << "║   所有权哈希与透明查找               ║\n";
+    std::cout << "╚══════════════════════════════════════╝\n";
+
+    test_owner_functors_mixed_types();
+    test_unordered_weak_registry();
+    test_ordered_lookup_without_temporary();
+    test_std_hash_shared_ptr();
+
+    return 0;
+}
@@ -0,0 +1,198 @@
+#include "my_make_shared.h"
+#include "my_parallel_release.h"
+#include "test_check.h"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// 测试用类
+// ============================================================================
+
+const int kObjects = 20000;
+
+static std::atomic<int> g_destroyed[kObjects];
+static std::mutex g_threads_mutex;
+static std::set<std::thread::id> g_destroy_threads;
+
+struct Entry {
+    int id;
+    explicit Entry(int i) : id(i) {}
+    ~Entry() {
+        g_destroyed[id].fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(g_threads_mutex);
+        g_destroy_threads.insert(std::this_thread::get_id());
+    }
+};
+
+struct Node {
+    my::SharedPtr<Node> next;
+    static std::atomic<int> live;
+    Node() { ++live; }
+    ~Node() { --live; }
+};
+std::atomic<int> Node::live(0);
+
+void reset_counters() {
+    for (int i = 0; i < kObjects; ++i) g_destroyed[i].store(0);
+    g_destroy_threads.clear();
+}
+
+// 每个对象被 4 个元素引用,打乱后分散在各个线程的分段里
+std::vector<my::SharedPtr<Entry>> build_shuffled() {
+    std::vector<my::SharedPtr<Entry>> items;
+    items.reserve(kObjects * 4);
+    for (int i = 0; i < kObjects; ++i) {
+        my::SharedPtr<Entry> entry = my::make_shared<Entry>(i);
+        for (int k = 0; k < 4; ++k) items.push_back(entry);
+    }
+    std::mt19937 rng(42);
+    std::shuffle(items.begin(), items.end(), rng);
+    return items;
+}
+
+// ============================================================================
+// 测试函数
+// ============================================================================
+
+void test_each_object_destroyed_once() {
+    std::cout << "\n========== 测试 1:并行释放,每个对象恰好析构一次 ==========\n";
+
+    reset_counters();
+    std::vector<my::SharedPtr<Entry>> items = build_shuffled();
+    my::ReleaseAllOptions options;
+    options.threads = 4;
+    options.min_per_thread = 1000;
+    my::release_all(items, options);
+
+    MY_CHECK(items.empty());
+    for (int i = 0; i < kObjects; ++i) MY_CHECK(g_destroyed[i].load() == 1);
+    std::cout << "析构分布在 " << g_destroy_threads.size() << " 个线程上\n";
+    MY_CHECK(g_destroy_threads.size() > 1);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_survivors_keep_references() {
+    std::cout << "\n========== 测试 2:容器外仍有引用的对象不析构 ==========\n";
+
+    reset_counters();
+    std::vector<my::SharedPtr<Entry>> items = build_shuffled();
+    std::vector<my::SharedPtr<Entry>> kept;
+    for (int i = 0; i < 100; ++i) kept.push_back(items[i]);
+
+    my::ReleaseAllOptions options;
+    options.threads = 3;
+    options.min_per_thread = 1000;
+    options.prefetch_distance = 0;  // 不预取也应当正确
+    my::release_all(items, options);
+
+    for (const auto& entry : kept) {
+        MY_CHECK(g_destroyed[entry->id].load() == 0);
+        MY_CHECK(entry.use_count() >= 1);
+    }
+    int destroyed = 0;
+    for (int i = 0; i < kObjects; ++i) destroyed += g_destroyed[i].load();
+    std::set<int> kept_ids;
+    for (const auto& entry : kept) kept_ids.insert(entry->id);
+    MY_CHECK(destroyed == kObjects - static_cast<int>(kept_ids.size()));
+
+    kept.clear();
+    for (int i = 0; i < kObjects; ++i) MY_CHECK(g_destroyed[i].load() == 1);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_small_and_other_containers() {
+    std::cout << "\n========== 测试 3:小容器单线程,deque 与链式析构 ==========\n";
+
+    reset_counters();
+    std::vector<my::SharedPtr<Entry>> empty;
+    my::release_all(empty);
+    MY_CHECK(empty.empty());
+
+    // 元素太少:不开线程,在调用线程上释放
+    std::vector<my::SharedPtr<Entry>> small;
+    for (int i = 0; i < 10; ++i) small.push_back(my::make_shared<Entry>(i));
+    my::release_all(small);
+    MY_CHECK(small.empty());
+    MY_CHECK(g_destroy_threads.size() == 1 &&
+             *g_destroy_threads.begin() == std::this_thread::get_id());
+
+    // deque;每个节点析构时再释放链上的下一个节点
+    std::deque<my::SharedPtr<Node>> heads;
+    for (int i = 0; i < 2000; ++i) {
+        my::SharedPtr<Node> head = my::make_shared<Node>();
+        head->next = my::make_shared<Node>();
+        head->next->next = my::make_shared<Node>();
+        heads.push_back(head);
+    }
+    MY_CHECK(Node::live == 6000);
+    my::ReleaseAllOptions options;
+    options.threads = 4;
+    options.min_per_thread = 100;
+    my::release_all(heads, options);
+    MY_CHECK(heads.empty());
+    MY_CHECK(Node::live == 0);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_pool_reuses_threads() {
+    std::cout << "\n========== 测试 4:复用 ReleasePool 的工作线程 ==========\n";
+
+    my::ReleasePool pool(3);
+    MY_CHECK(pool.workers() == 3);
+    my::ReleaseAllOptions options;
+    options.pool = &pool;
+    options.min_per_thread = 1000;
+
+    // 多次调用:析构只发生在调用线程和池里的 3 个线程上,不会每次换新线程
+    std::set<std::thread::id> all_threads;
+    for (int round = 0; round < 5; ++round) {
+        reset_counters();
+        std::vector<my::SharedPtr<Entry>> items = build_shuffled();
+        my::release_all(items, options);
+        MY_CHECK(items.empty());
+        for (int i = 0; i < kObjects; ++i) MY_CHECK(g_destroyed[i].load() == 1);
+        all_threads.insert(g_destroy_threads.begin(), g_destroy_threads.end());
+    }
+    std::cout << "5 次调用的析构分布在 " << all_threads.size() << " 个线程上\n";
+    MY_CHECK(all_threads.size() > 1 && all_threads.size() <= pool.workers() + 1);
+
+    // 两个线程同时使用同一个池
+    reset_counters();
+    std::vector<my::SharedPtr<Entry>> first = build_shuffled();
+    std::vector<my::SharedPtr<Entry>> second(first.begin() + first.size() / 2, first.end());
+    first.resize(first.size() / 2);
+    std::thread other([&]() { my::release_all(second, options); });
+    my::release_all(first, options);
+    other.join();
+    MY_CHECK(first.empty() && second.empty());
+    for (int i = 0; i < kObjects; ++i) MY_CHECK(g_destroyed[i].load() == 1);
+
+    std::cout << " 测试通过\n";
+}
+
+// ============================================================================
+// 主函数
+// ============================================================================
+
+int main() {
+    std::cout << "开始 release_all 测试...\n";
+
+    test_each_object_destroyed_once();
+    test_survivors_keep_references();
+    test_small_and_other_containers();
+    test_pool_reuses_threads();
+
+    std::cout << "\n所有 release_all 测试通过!\n";
+    return 0;
+}
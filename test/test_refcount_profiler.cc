@@ -0,0 +1,140 @@
+// 以 -DMY_SP_ENABLE_REFCOUNT_PROFILER 编译(见 CMakeLists.txt)
+#include "my_make_shared.h"
+#include "my_refcount_profiler.h"
+#include "my_weak_ptr.h"
+#include "test_check.h"
+
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+
+#ifndef MY_SP_ENABLE_REFCOUNT_PROFILER
+#error "test_refcount_profiler 需要定义 MY_SP_ENABLE_REFCOUNT_PROFILER"
+#endif
+
+// ============================================================================
+// 测试用类
+// ============================================================================
+
+struct HotConfig {
+    int value = 42;
+};
+
+struct ColdItem {
+    int value = 0;
+};
+
+// ============================================================================
+// 测试函数
+// ============================================================================
+
+void test_thread_op_counts() {
+    std::cout << "\n========== 测试 1:每线程精确计数 ==========\n";
+
+    my::SharedPtr<int> sp = my::make_shared<int>(1);
+    my::RefcountOpCounts before = my::refcount_thread_op_counts();
+    {
+        my::SharedPtr<int> copy = sp;           // AddRefCopy
+        my::WeakPtr<int> weak = sp;             // WeakAddRef
+        my::SharedPtr<int> locked = weak.lock();  // AddRefLock
+        assert(locked);
+    }                                           // 2 次 Release
+    my::SharedPtr<int> moved = std::move(sp);   // 移动不碰计数
+    my::RefcountOpCounts after = my::refcount_thread_op_counts();
+
+    std::cout << "copy=" << after.add_ref_copy - before.add_ref_copy
+              << " release=" << after.release - before.release
+              << " weak=" << after.weak_add_ref - before.weak_add_ref
+              << " lock=" << after.add_ref_lock - before.add_ref_lock << "\n";
+    assert(after.add_ref_copy - before.add_ref_copy == 1);
+    assert(after.release - before.release == 2);
+    assert(after.weak_add_ref - before.weak_add_ref == 1);
+    assert(after.add_ref_lock - before.add_ref_lock == 1);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_report_ranks_hot_shared_object() {
+    std::cout << "\n========== 测试 2:多线程共享对象排在最前 ==========\n";
+
+    my::set_refcount_profile_sample_rate(1);
+    my::refcount_profile_reset();
+
+    const int NUM_THREADS = 4;
+    const int ITERATIONS = 20000;
+    my::SharedPtr<HotConfig> config = my::make_shared<HotConfig>();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NUM_THREADS; ++t) {
+        threads.emplace_back([config]() {
+            for (int i = 0; i < ITERATIONS; ++i) {
+                my::SharedPtr<HotConfig> local = config;
+                if (i % 100 == 0) std::this_thread::yield();
+            }
+            // 每个线程自己的短命对象,只被一个线程触碰
+            for (int i = 0; i < 100; ++i) {
+                my::SharedPtr<ColdItem> item = my::make_shared<ColdItem>();
+                my::SharedPtr<ColdItem> copy = item;
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    std::ostringstream report;
+    size_t ranked = my::refcount_profile_report(report, 3);
+    std::cout << report.str();
+
+    const std::string text = report.str();
+    const std::string hot_name = typeid(HotConfig).name();
+    size_t first_entry = text.find("\n  ");
+    MY_CHECK(ranked > 3);
+    MY_CHECK(first_entry != std::string::npos);
+    MY_CHECK(text.compare(first_entry + 3, hot_name.size(), hot_name) == 0);
+    // config 由主线程创建,lambda 捕获时拷贝;至少 NUM_THREADS 个线程触碰过它
+    MY_CHECK(text.find("线程=" + std::to_string(NUM_THREADS)) != std::string::npos ||
+             text.find("线程=" + std::to_string(NUM_THREADS + 1)) != std::string::npos);
+    // 已销毁的短命对象仍保留统计,排在热点之后
+    MY_CHECK(text.find("已销毁") != std::string::npos);
+
+    my::set_refcount_profile_sample_rate(64);
+    std::cout << " 测试通过\n";
+}
+
+void test_release_race_is_safe() {
+    std::cout << "\n========== 测试 3:采样 Release 与并发销毁 ==========\n";
+
+    // 每次都采样:Release 记录统计时,对象可能已被另一个线程释放
+    my::set_refcount_profile_sample_rate(1);
+    for (int round = 0; round < 2000; ++round) {
+        my::SharedPtr<int> sp = my::make_shared<int>(round);
+        my::SharedPtr<int> other = sp;
+        std::thread t([&other]() { other.Reset(); });
+        sp.Reset();
+        t.join();
+    }
+    my::set_refcount_profile_sample_rate(64);
+    my::refcount_profile_reset();
+
+    std::cout << " 测试通过\n";
+}
+
+// ============================================================================
+// 主函数
+// ============================================================================
+
+int main() {
+    std::cout << "\n";
+    std::cout << "╔══════════════════════════════════════╗\n";
+    std::cout << "║   引用计数争用剖析器                 ║\n";
+    std::cout << "╚══════════════════════════════════════╝\n";
+
+    test_thread_op_counts();
+    test_report_ranks_hot_shared_object();
+    test_release_race_is_safe();
+
+    return 0;
+}
@@ -0,0 +1,156 @@
+// 以 -DMY_SP_ENABLE_RELEASE_LATENCY_HOOK 编译(见 CMakeLists.txt)
+#include "my_make_shared.h"
+#include "my_release_latency.h"
+#include "my_weak_ptr.h"
+#include "test_check.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <typeinfo>
+#include <vector>
+
+#ifndef MY_SP_ENABLE_RELEASE_LATENCY_HOOK
+#error "test_release_latency 需要定义 MY_SP_ENABLE_RELEASE_LATENCY_HOOK"
+#endif
+
+// ============================================================================
+// 测试用类与钩子
+// ============================================================================
+
+struct Widget {
+    int value = 0;
+};
+
+struct Node {
+    my::SharedPtr<Node> left;
+    my::SharedPtr<Node> right;
+};
+
+std::vector<my::ReleaseLatency> g_samples;
+
+void RecordSample(const my::ReleaseLatency& sample) {
+    g_samples.push_back(sample);
+}
+
+void CountOnly(const my::ReleaseLatency&) {}
+
+my::SharedPtr<Node> BuildTree(int depth) {
+    my::SharedPtr<Node> node = my::make_shared<Node>();
+    if (depth > 1) {
+        node->left = BuildTree(depth - 1);
+        node->right = BuildTree(depth - 1);
+    }
+    return node;
+}
+
+// ============================================================================
+// 测试函数
+// ============================================================================
+
+void test_hook_fires_on_last_release() {
+    std::cout << "\n========== 测试 1:只有最后一次释放触发钩子 ==========\n";
+
+    g_samples.clear();
+    my::ReleaseLatencyHook previous = my::set_release_latency_hook(RecordSample);
+    MY_CHECK(previous == nullptr);
+
+    my::SharedPtr<Widget> sp = my::make_shared<Widget>();
+    {
+        my::SharedPtr<Widget> copy = sp;
+    }
+    assert(g_samples.empty());  // 还有强引用,不是最后一次
+
+    sp.Reset();
+    MY_CHECK(g_samples.size() == 1);
+    assert(std::strcmp(g_samples[0].type_name, typeid(Widget).name()) == 0);
+    std::cout << "dispose=" << g_samples[0].dispose_ns
+              << "ns destroy=" << g_samples[0].destroy_ns << "ns\n";
+
+    // 空指针没有控制块,不会触发
+    my::SharedPtr<Widget> empty;
+    empty.Reset();
+    assert(g_samples.size() == 1);
+
+    previous = my::set_release_latency_hook(nullptr);
+    MY_CHECK(previous == RecordSample);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_uninstalled_hook_is_silent() {
+    std::cout << "\n========== 测试 2:卸载后不再回调 ==========\n";
+
+    g_samples.clear();
+    my::set_release_latency_hook(RecordSample);
+    my::set_release_latency_hook(CountOnly);
+    my::make_shared<Widget>().Reset();
+    my::set_release_latency_hook(nullptr);
+    my::make_shared<Widget>().Reset();
+    assert(g_samples.empty());
+
+    std::cout << " 测试通过\n";
+}
+
+void test_weak_ref_keeps_block() {
+    std::cout << "\n========== 测试 3:弱引用存在时只计对象析构 ==========\n";
+
+    g_samples.clear();
+    my::set_release_latency_hook(RecordSample);
+
+    my::SharedPtr<Widget> sp = my::make_shared<Widget>();
+    my::WeakPtr<Widget> weak = sp;
+    sp.Reset();
+    assert(g_samples.size() == 1);
+    assert(weak.expired());
+
+    // 最后一个 WeakPtr 释放控制块不是"最后一次 Release",不触发
+    weak = my::WeakPtr<Widget>();
+    assert(g_samples.size() == 1);
+
+    my::set_release_latency_hook(nullptr);
+    std::cout << " 测试通过\n";
+}
+
+void test_graph_teardown_reports_each_node() {
+    std::cout << "\n========== 测试 4:对象图级联释放逐节点回调 ==========\n";
+
+    const int kDepth = 8;
+    const size_t kNodes = (1u << kDepth) - 1;
+    my::SharedPtr<Node> root = BuildTree(kDepth);
+
+    g_samples.clear();
+    g_samples.reserve(kNodes);  // 钩子里不再分配
+    my::set_release_latency_hook(RecordSample);
+    root.Reset();
+    my::set_release_latency_hook(nullptr);
+
+    std::cout << "回调 " << g_samples.size() << " 次, 根节点 dispose="
+              << g_samples.back().dispose_ns << "ns\n";
+    assert(g_samples.size() == kNodes);
+    // 从内到外回调:根最后一个,它的耗时包含所有子节点
+    uint64_t max_child = 0;
+    for (size_t i = 0; i + 1 < g_samples.size(); ++i) {
+        max_child = std::max(max_child, g_samples[i].dispose_ns);
+    }
+    assert(g_samples.back().dispose_ns >= max_child);
+
+    std::cout << " 测试通过\n";
+}
+
+// ============================================================================
+// 主函数
+// ============================================================================
+
+int main() {
+    std::cout << "开始释放耗时钩子测试...\n";
+
+    test_hook_fires_on_last_release();
+    test_uninstalled_hook_is_silent();
+    test_weak_ref_keeps_block();
+    test_graph_teardown_reports_each_node();
+
+    std::cout << "\n所有释放耗时钩子测试通过!\n";
+    return 0;
+}
@@ -0,0 +1,191 @@
+#include "my_shared_ref.h"
+#include "my_weak_ptr.h"
+#include "test_check.h"
+
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+// ============================================================================
+// 测试用类
+// ============================================================================
+
+static int g_live = 0;
+
+struct Shape {
+    virtual ~Shape() = default;
+    virtual int sides() const { return 0; }
+};
+
+struct Square : Shape {
+    std::string label;
+    explicit Square(const std::string& l = "square") : label(l) { ++g_live; }
+    ~Square() override { --g_live; }
+    int sides() const override { return 4; }
+};
+
+struct Document {
+    my::SharedRef<Square> owner;  // 永不为空的字段
+    explicit Document(const my::SharedRef<Square>& o) : owner(o) {}
+};
+
+// ============================================================================
+// 测试函数
+// ============================================================================
+
+void test_make_and_copy() {
+    std::cout << "\n========== 测试 1:make_shared_ref 与拷贝 ==========\n";
+
+    {
+        my::SharedRef<Square> ref = my::make_shared_ref<Square>("a");
+        assert(ref->label == "a");
+        assert((*ref).sides() == 4);
+        assert(ref.use_count() == 1);
+
+        my::SharedRef<Square> copy = ref;
+        assert(copy == ref);
+        assert(ref.use_count() == 2);
+
+        // 没有移动后的空状态:移动构造按拷贝处理,源仍然可用
+        my::SharedRef<Square> moved = std::move(copy);
+        assert(copy->label == "a");
+        assert(ref.use_count() == 3);
+
+        my::SharedRef<Square> other = my::make_shared_ref<Square>("b");
+        moved = other;
+        assert(moved->label == "b");
+        assert(ref.use_count() == 2);
+        moved = moved;  // 自赋值
+        assert(other.use_count() == 2);
+
+        // 移动赋值交换两者,计数不变
+        moved = std::move(copy);
+        assert(moved->label == "a" && copy->label == "b");
+        assert(ref.use_count() == 2 && other.use_count() == 2);
+        moved = std::move(moved);  // 自移动赋值
+        assert(moved->label == "a");
+
+        ref.Swap(other);
+        assert(ref->label == "b" && other->label == "a");
+
+        Document doc(ref);
+        assert(doc.owner == ref);
+        assert(g_live == 2);
+    }
+    assert(g_live == 0);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_from_shared_ptr() {
+    std::cout << "\n========== 测试 2:从 SharedPtr 构造(检查非空) ==========\n";
+
+    my::SharedPtr<Square> sp(new Square());
+    my::SharedRef<Square> ref(sp);
+    assert(ref.get() == sp.get());
+    assert(ref.owner_key() == sp.owner_key());
+    assert(sp.use_count() == 2);
+
+    // 右值构造接管所有权
+    my::SharedPtr<Square> source = sp;
+    my::SharedRef<Square> stolen(std::move(source));
+    assert(!source);
+    assert(sp.use_count() == 3);
+
+    bool thrown = false;
+    try {
+        my::SharedRef<Square> bad{my::SharedPtr<Square>()};
+    } catch (const std::invalid_argument& e) {
+        thrown = true;
+        std::cout << "预期的异常: " << e.what() << "\n";
+    }
+    MY_CHECK(thrown);
+
+    // 右值构造失败时源不变(别名为空指针也算空)
+    my::SharedPtr<Square> alias_null(sp, static_cast<Square*>(nullptr));
+    thrown = false;
+    try {
+        my::SharedRef<Square> bad(std::move(alias_null));
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    MY_CHECK(thrown);
+    MY_CHECK(alias_null.use_count() == 4);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_convert_to_shared_ptr() {
+    std::cout << "\n========== 测试 3:隐式转换为 SharedPtr ==========\n";
+
+    my::SharedRef<Square> ref = my::make_shared_ref<Square>();
+    my::SharedPtr<Square> sp = ref;
+    assert(sp.get() == ref.get());
+    assert(ref.use_count() == 2);
+
+    my::SharedPtr<Shape> base = ref;  // 同时向上转换
+    assert(base->sides() == 4);
+    assert(ref.use_count() == 3);
+
+    my::SharedRef<Shape> shape = ref;
+    assert(shape->sides() == 4);
+    assert(shape.owner_key() == ref.owner_key());
+
+    my::WeakPtr<Square> weak = my::SharedPtr<Square>(ref);
+    assert(!weak.expired());
+
+    std::cout << " 测试通过\n";
+}
+
+void test_containers_and_threads() {
+    std::cout << "\n========== 测试 4:容器与多线程拷贝 ==========\n";
+
+    my::SharedRef<Square> ref = my::make_shared_ref<Square>();
+    std::vector<my::SharedRef<Square>> items;
+    for (int i = 0; i < 100; ++i) items.push_back(ref);  // 扩容时按拷贝搬移
+    assert(ref.use_count() == 101);
+    items.clear();
+
+    std::unordered_set<my::SharedRef<Square>> set;
+    set.insert(ref);
+    set.insert(ref);
+    assert(set.size() == 1);
+    set.clear();
+
+    const int NUM_THREADS = 4;
+    const int ITERATIONS = 10000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NUM_THREADS; ++t) {
+        threads.emplace_back([&ref]() {
+            for (int i = 0; i < ITERATIONS; ++i) {
+                my::SharedRef<Square> copy = ref;
+                assert(copy.get() == ref.get());
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    assert(ref.use_count() == 1);
+
+    std::cout << " 测试通过\n";
+}
+
+// ============================================================================
+// 主函数
+// ============================================================================
+
+int main() {
+    std::cout << "开始 SharedRef 测试...\n";
+
+    test_make_and_copy();
+    test_from_shared_ptr();
+    test_convert_to_shared_ptr();
+    test_containers_and_threads();
+    assert(g_live == 0);
+
+    std::cout << "\n所有 SharedRef 测试通过!\n";
+    return 0;
+}
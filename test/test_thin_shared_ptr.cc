@@ -0,0 +1,193 @@
+#include "my_make_shared.h"
+#include "my_pointer_cast.h"
+#include "my_thin_shared_ptr.h"
+#include "my_weak_ptr.h"
+
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+// ============================================================================
+// 测试用类
+// ============================================================================
+
+static int g_live = 0;
+
+struct Base {
+    virtual ~Base() = default;
+};
+
+struct Payload : Base {
+    int id;
+    std::string name;
+    Payload(int i, const std::string& n) : id(i), name(n) { ++g_live; }
+    ~Payload() override { --g_live; }
+};
+
+// ============================================================================
+// 测试函数
+// ============================================================================
+
+void test_size_and_basic() {
+    std::cout << "\n========== 测试 1:单字大小与基本操作 ==========\n";
+
+    static_assert(sizeof(my::ThinSharedPtr<Payload>) == sizeof(void*), "应为单字");
+    static_assert(sizeof(my::ThinWeakPtr<Payload>) == sizeof(void*), "应为单字");
+    std::cout << "sizeof(ThinSharedPtr)=" << sizeof(my::ThinSharedPtr<Payload>)
+              << " sizeof(SharedPtr)=" << sizeof(my::SharedPtr<Payload>) << "\n";
+
+    {
+        my::ThinSharedPtr<Payload> thin = my::make_thin_shared<Payload>(1, "one");
+        assert(thin);
+        assert(thin->id == 1 && (*thin).name == "one");
+        assert(thin.use_count() == 1);
+
+        my::ThinSharedPtr<Payload> copy = thin;
+        assert(copy == thin);
+        assert(copy.get() == thin.get());
+        assert(thin.use_count() == 2);
+
+        my::ThinSharedPtr<Payload> moved = std::move(copy);
+        assert(!copy && copy == nullptr);
+        assert(thin.use_count() == 2);
+
+        moved.Reset();
+        assert(thin.unique());
+        assert(g_live == 1);
+    }
+    assert(g_live == 0);
+
+    my::ThinSharedPtr<Payload> empty;
+    assert(!empty && empty.get() == nullptr && empty.use_count() == 0);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_convert_from_shared() {
+    std::cout << "\n========== 测试 2:与 SharedPtr 互相转换 ==========\n";
+
+    my::SharedPtr<Payload> sp = my::make_shared<Payload>(2, "two");
+    my::ThinSharedPtr<Payload> thin = my::to_thin(sp);
+    assert(thin.get() == sp.get());
+    assert(thin.owner_key() == sp.owner_key());
+    assert(sp.use_count() == 2);
+
+    // 右值转换不改动计数,源被置空
+    my::SharedPtr<Payload> source = sp;
+    my::ThinSharedPtr<Payload> stolen = my::to_thin(std::move(source));
+    assert(!source);
+    assert(sp.use_count() == 3);
+
+    // 回到 SharedPtr:左值共享,右值转移
+    my::SharedPtr<Payload> back = thin;
+    assert(back.get() == sp.get());
+    assert(sp.use_count() == 4);
+    my::SharedPtr<Payload> back_moved = std::move(stolen);
+    assert(!stolen);
+    assert(sp.use_count() == 4);
+
+    // 转成 SharedPtr 后可以正常做类型转换
+    my::SharedPtr<Base> base = my::SharedPtr<Payload>(thin);
+    assert(base.get() == static_cast<Base*>(sp.get()));
+
+    std::cout << " 测试通过\n";
+}
+
+void test_incompatible_shared() {
+    std::cout << "\n========== 测试 3:不能转换的 SharedPtr ==========\n";
+
+    // new 出来的对象不在控制块里
+    my::SharedPtr<Payload> allocated(new Payload(3, "three"));
+    assert(!my::to_thin(allocated));
+
+    // 别名指针指向成员
+    my::SharedPtr<Payload> sp = my::make_shared<Payload>(4, "four");
+    my::SharedPtr<std::string> alias(sp, &sp->name);
+    assert(!my::to_thin(alias));
+
+    // 失败的右值转换不改动源
+    my::SharedPtr<Payload> keep = allocated;
+    my::ThinSharedPtr<Payload> failed = my::to_thin(std::move(keep));
+    assert(!failed);
+    assert(keep.get() == allocated.get());
+    assert(allocated.use_count() == 2);
+
+    assert(!my::to_thin(my::SharedPtr<Payload>()));
+
+    std::cout << " 测试通过\n";
+}
+
+void test_weak() {
+    std::cout << "\n========== 测试 4:ThinWeakPtr ==========\n";
+
+    my::ThinWeakPtr<Payload> weak;
+    assert(weak.expired() && !weak.lock());
+    {
+        my::ThinSharedPtr<Payload> thin = my::make_thin_shared<Payload>(5, "five");
+        weak = thin;
+        assert(!weak.expired());
+        my::ThinSharedPtr<Payload> locked = weak.lock();
+        assert(locked == thin);
+        assert(thin.use_count() == 2);
+
+        // 与普通 WeakPtr 混合持有同一个对象
+        my::WeakPtr<Payload> regular = my::SharedPtr<Payload>(thin);
+        assert(regular.lock().get() == thin.get());
+    }
+    assert(weak.expired());
+    assert(!weak.lock());
+    assert(g_live == 0);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_containers_and_threads() {
+    std::cout << "\n========== 测试 5:容器与多线程拷贝 ==========\n";
+
+    my::ThinSharedPtr<Payload> shared = my::make_thin_shared<Payload>(6, "six");
+    std::unordered_set<my::ThinSharedPtr<Payload>> set;
+    set.insert(shared);
+    set.insert(shared);
+    assert(set.size() == 1);
+
+    const int NUM_THREADS = 4;
+    const int ITERATIONS = 10000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NUM_THREADS; ++t) {
+        threads.emplace_back([&shared]() {
+            std::vector<my::ThinSharedPtr<Payload>> local;
+            for (int i = 0; i < ITERATIONS; ++i) {
+                local.push_back(shared);
+                if (local.size() == 64) local.clear();
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    assert(shared.use_count() == 2);  // shared + set 里的一份
+
+    set.clear();
+    shared.Reset();
+    assert(g_live == 0);
+
+    std::cout << " 测试通过\n";
+}
+
+// ============================================================================
+// 主函数
+// ============================================================================
+
+int main() {
+    std::cout << "开始 ThinSharedPtr 测试...\n";
+
+    test_size_and_basic();
+    test_convert_from_shared();
+    test_incompatible_shared();
+    test_weak();
+    test_containers_and_threads();
+
+    std::cout << "\n所有 ThinSharedPtr 测试通过!\n";
+    return 0;
+}
@@ -0,0 +1,175 @@
+// 统计分配次数验证原地提升;alloc_counter.h 替换了全局 operator new/delete
+#include "alloc_counter.h"
+#include "my_unique_ptr.h"
+#include "my_weak_ptr.h"
+#include "test_check.h"
+
+#include <iostream>
+#include <string>
+#include <utility>
+
+// ============================================================================
+// 测试用类
+// ============================================================================
+
+static int g_live = 0;
+
+struct Shape {
+    virtual ~Shape() = default;
+    virtual int sides() const { return 0; }
+};
+
+struct Square : Shape {
+    std::string label;
+    explicit Square(const char* l = "square") : label(l) { ++g_live; }
+    ~Square() override { --g_live; }
+    int sides() const override { return 4; }
+};
+
+struct CountingDeleter {
+    int* calls;
+    explicit CountingDeleter(int* c = nullptr) : calls(c) {}
+    void operator()(Square* p) const {
+        if (calls) ++*calls;
+        delete p;
+    }
+};
+
+// 先取增量再打印:iostream 首次输出可能自己分配缓冲区
+alloc_counter::Counts report(const char* what, const alloc_counter::Scope& scope) {
+    alloc_counter::Counts delta = scope.Delta();
+    std::cout << "  " << what << ": 分配 " << delta.allocations << " 次, 释放 "
+              << delta.deallocations << " 次\n";
+    return delta;
+}
+
+// ============================================================================
+// 测试函数
+// ============================================================================
+
+void test_exclusive_ownership() {
+    std::cout << "\n========== 测试 1:独占所有权 ==========\n";
+
+    {
+        my::UniquePtr<Square> a = my::make_unique<Square>("a");
+        MY_CHECK(a && a->label == "a" && !a.promotable());
+
+        my::UniquePtr<Square> b = std::move(a);
+        MY_CHECK(!a && b->label == "a");
+
+        my::UniquePtr<Shape> base = std::move(b);  // 向上转换
+        MY_CHECK(!b && base->sides() == 4);
+
+        my::UniquePtr<Square> p = my::make_unique_promotable<Square>("p");
+        MY_CHECK(p.promotable());
+        my::UniquePtr<Shape> promotable_base = std::move(p);
+        MY_CHECK(promotable_base.promotable() && !p);
+
+        std::swap(base, promotable_base);
+        MY_CHECK(base.promotable() && !promotable_base.promotable());
+        MY_CHECK(g_live == 2);
+
+        base = nullptr;
+        MY_CHECK(g_live == 1);
+        promotable_base.Reset(new Square("r"));
+        MY_CHECK(g_live == 1);
+    }
+    MY_CHECK(g_live == 0);
+
+    int calls = 0;
+    {
+        my::UniquePtr<Square, CountingDeleter> custom(new Square(), CountingDeleter(&calls));
+        MY_CHECK(custom.get_deleter().calls == &calls);
+    }
+    MY_CHECK(calls == 1 && g_live == 0);
+
+    // 空删除器经空基类优化不占空间:指针 + 预留控制块
+    static_assert(sizeof(my::UniquePtr<Square>) == 2 * sizeof(void*),
+                  "DefaultDelete 不应占用存储");
+    static_assert(sizeof(my::UniquePtr<Square, CountingDeleter>) == 3 * sizeof(void*),
+                  "有状态的删除器按成员存储");
+
+    std::cout << " 测试通过\n";
+}
+
+void test_promote_without_allocation() {
+    std::cout << "\n========== 测试 2:可提升对象共享时不再分配 ==========\n";
+
+    alloc_counter::Scope scope;
+    {
+        my::UniquePtr<Square> unique = my::make_unique_promotable<Square>("x");
+        my::SharedPtr<Square> sp(std::move(unique));
+        MY_CHECK(!unique);
+        MY_CHECK(sp->label == "x" && sp.use_count() == 1);
+        my::SharedPtr<Square> copy = sp;
+        MY_CHECK(sp.use_count() == 2);
+    }
+    alloc_counter::Counts promoted = report("make_unique_promotable + 提升", scope);
+    MY_CHECK(promoted.allocations == 1);
+    MY_CHECK(promoted.deallocations == 1);
+    MY_CHECK(g_live == 0);
+
+    scope.Reset();
+    {
+        my::UniquePtr<Square> unique = my::make_unique_promotable<Square>("never shared");
+    }
+    alloc_counter::Counts never = report("make_unique_promotable, 从未共享", scope);
+    MY_CHECK(never.allocations == 1 && never.deallocations == 1);
+
+    scope.Reset();
+    {
+        my::UniquePtr<Square> unique = my::make_unique<Square>("y");
+        my::SharedPtr<Square> sp(std::move(unique));
+    }
+    alloc_counter::Counts plain = report("make_unique + 提升", scope);
+    MY_CHECK(plain.allocations == 2);  // 对象 + 控制块
+    MY_CHECK(g_live == 0);
+
+    std::cout << " 测试通过\n";
+}
+
+void test_promoted_behaves_like_shared_ptr() {
+    std::cout << "\n========== 测试 3:提升后与 SharedPtr 行为一致 ==========\n";
+
+    my::WeakPtr<Shape> weak;
+    {
+        my::UniquePtr<Square> unique = my::make_unique_promotable<Square>();
+        my::SharedPtr<Shape> base;
+        base = std::move(unique);  // 同时向上转换
+        MY_CHECK(base->sides() == 4);
+        weak = base;
+        MY_CHECK(weak.lock().get() == base.get());
+    }
+    MY_CHECK(weak.expired());
+    MY_CHECK(g_live == 0);
+
+    // 自定义删除器随对象一起交给控制块
+    int calls = 0;
+    {
+        my::UniquePtr<Square, CountingDeleter> custom(new Square(), CountingDeleter(&calls));
+        my::SharedPtr<Square> sp = std::move(custom);
+        MY_CHECK(!custom && calls == 0);
+    }
+    MY_CHECK(calls == 1 && g_live == 0);
+
+    my::UniquePtr<Square> empty;
+    my::SharedPtr<Square> from_empty(std::move(empty));
+    MY_CHECK(!from_empty && from_empty.use_count() == 0);
+
+    std::cout << " 测试通过\n";
+}
+
+// ============================================================================
+// 主函数
+// ============================================================================
+
+int main() {
+    std::cout << "开始 UniquePtr 测试...\n";
+
+    test_exclusive_ownership();
+    test_promote_without_allocation();
+    test_promoted_behaves_like_shared_ptr();
+
+    std::cout << "\n所有 UniquePtr 测试通过!\n";
+    return 0;
+}
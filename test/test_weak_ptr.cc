@@ -1,7 +1,12 @@
 #include "my_shared_ptr.h"
 #include "my_weak_ptr.h"
+#include "test_check.h"
 #include <iostream>
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <iomanip>
 #include <thread>
 #include <vector>
 
@@ -165,6 +170,190 @@ void test_lock_race_condition() {
     std::cout << " 测试通过:多线程 lock() 安全\n";
 }
 
+void test_lock_after_death_is_sticky() {
+    std::cout << "\n========== 测试 3b:死亡后 lock() 保持失败 ==========\n";
+    
+    my::SharedPtr<TestObject> sp(new TestObject(30));
+    my::WeakPtr<TestObject> wp = sp;
+    sp.Reset();
+    
+    // 失败的 lock() 也会 fetch_add,但死亡标记位保证它们全部失败
+    for (int i = 0; i < 1000; ++i) {
+        assert(!wp.lock());
+    }
+    std::cout << "1000 次失败 lock() 后 use_count: " << wp.use_count() << "\n";
+    assert(wp.use_count() == 0);
+    assert(wp.expired());
+    
+    std::cout << " 测试通过:死亡状态不可逆\n";
+}
+
+void test_lock_revive_window() {
+    std::cout << "\n========== 测试 3c:归零窗口内的 lock() 复活 ==========\n";
+    
+    // Release() 递减到 0 与写入死亡标记之间,lock() 可能复活对象并立刻再次释放。
+    // 反复制造这个窗口,检查对象恰好析构一次、控制块不被提前释放
+    constexpr int ROUNDS = 2000;
+    constexpr int NUM_THREADS = 4;
+    
+    struct Counted {
+        std::atomic<int>* destroyed;
+        ~Counted() { ++*destroyed; }
+    };
+    
+    std::atomic<int> destroyed{0};
+    for (int round = 0; round < ROUNDS; ++round) {
+        my::SharedPtr<Counted> sp(new Counted{&destroyed});
+        my::WeakPtr<Counted> wp = sp;
+        std::atomic<bool> go{false};
+        
+        std::vector<std::thread> threads;
+        for (int i = 0; i < NUM_THREADS; ++i) {
+            my::WeakPtr<Counted> local = wp;
+            threads.emplace_back([local, &go]() {
+                while (!go.load(std::memory_order_acquire)) {}
+                for (int j = 0; j < 50; ++j) {
+                    my::SharedPtr<Counted> locked = local.lock();
+                }
+            });
+        }
+        wp.Reset();
+        go.store(true, std::memory_order_release);
+        sp.Reset();
+        for (auto& t : threads) {
+            t.join();
+        }
+        assert(destroyed == round + 1);
+    }
+    
+    std::cout << ROUNDS << " 轮后析构次数: " << destroyed.load() << "\n";
+    assert(destroyed == ROUNDS);
+    
+    std::cout << " 测试通过:复活窗口内对象恰好析构一次\n";
+}
+
+void test_lock_throughput_scaling() {
+    std::cout << "\n========== 测试 3d:lock() 竞争吞吐量(1..N 线程) ==========\n";
+    
+    constexpr int LOCKS_PER_THREAD = 1000000;
+    const int max_threads = std::max(2u, std::thread::hardware_concurrency());
+    
+    my::SharedPtr<TestObject> sp(new TestObject(31));
+    my::WeakPtr<TestObject> wp = sp;
+    
+    std::cout << std::setw(8) << "线程数" << std::setw(16) << "耗时(ms)"
+              << std::setw(16) << "Mlock/s" << "\n";
+    
+    for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+        std::atomic<int> ready{0};
+        std::atomic<bool> go{false};
+        std::atomic<long> success_count{0};
+        std::vector<std::thread> threads;
+        
+        for (int i = 0; i < num_threads; ++i) {
+            threads.emplace_back([&]() {
+                ++ready;
+                while (!go.load(std::memory_order_acquire)) {}
+                
+                long local_success = 0;
+                for (int j = 0; j < LOCKS_PER_THREAD; ++j) {
+                    my::SharedPtr<TestObject> locked = wp.lock();
+                    if (locked) ++local_success;
+                }
+                success_count += local_success;
+            });
+        }
+        
+        while (ready.load() != num_threads) {}
+        auto start = std::chrono::steady_clock::now();
+        go.store(true, std::memory_order_release);
+        for (auto& t : threads) {
+            t.join();
+        }
+        double elapsed_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+        
+        double total = static_cast<double>(num_threads) * LOCKS_PER_THREAD;
+        std::cout << std::setw(8) << num_threads
+                  << std::setw(16) << std::fixed << std::setprecision(2) << elapsed_ms
+                  << std::setw(16) << std::fixed << std::setprecision(2)
+                  << (total / elapsed_ms / 1000.0) << "\n";
+        
+        assert(success_count == static_cast<long>(total));  // sp 一直存活
+        
+        if (num_threads < max_threads && num_threads * 2 > max_threads) {
+            num_threads = max_threads / 2;  // 保证最后测一次 max_threads
+        }
+    }
+    
+    assert(sp.use_count() == 1);
+    
+    std::cout << " 测试完成:lock() 无 CAS 重试\n";
+}
+
+void test_expired_is_final() {
+    std::cout << "\n========== 测试 3e:expired() 为 true 后 lock() 不再成功 ==========\n";
+    
+    // 观察线程在归零窗口内看到 0 时会代为宣告死亡;
+    // 之后无论其他线程怎样 lock(),都不能再复活对象
+    constexpr int ROUNDS = 2000;
+    constexpr int NUM_LOCKERS = 3;
+    
+    struct Counted {
+        std::atomic<int>* destroyed;
+        ~Counted() { ++*destroyed; }
+    };
+    
+    std::atomic<int> destroyed{0};
+    std::atomic<int> observed_expired{0};
+    for (int round = 0; round < ROUNDS; ++round) {
+        my::SharedPtr<Counted> sp(new Counted{&destroyed});
+        my::WeakPtr<Counted> wp = sp;
+        std::atomic<bool> go{false};
+        std::atomic<bool> expired_seen{false};
+        
+        std::vector<std::thread> threads;
+        for (int i = 0; i < NUM_LOCKERS; ++i) {
+            threads.emplace_back([wp, &go, &expired_seen]() {
+                while (!go.load(std::memory_order_acquire)) {}
+                for (int j = 0; j < 50; ++j) {
+                    my::SharedPtr<Counted> locked = wp.lock();
+                    // expired() 已经返回过 true,之后开始的 lock() 必须失败
+                    bool was_expired = expired_seen.load(std::memory_order_acquire);
+                    if (was_expired) {
+                        assert(!wp.lock());
+                    }
+                }
+            });
+        }
+        threads.emplace_back([wp, &go, &expired_seen, &observed_expired]() {
+            while (!go.load(std::memory_order_acquire)) {}
+            for (int j = 0; j < 200; ++j) {
+                if (wp.expired()) {
+                    expired_seen.store(true, std::memory_order_release);
+                    ++observed_expired;
+                    assert(wp.use_count() == 0);
+                    assert(!wp.lock());
+                    break;
+                }
+            }
+        });
+        go.store(true, std::memory_order_release);
+        sp.Reset();
+        for (auto& t : threads) {
+            t.join();
+        }
+        assert(wp.expired() && !wp.lock());
+        assert(destroyed == round + 1);
+    }
+    
+    std::cout << ROUNDS << " 轮中观察到过期 " << observed_expired.load() << " 次, 析构次数: "
+              << destroyed.load() << "\n";
+    assert(destroyed == ROUNDS);
+    
+    std::cout << " 测试通过:expired() 一旦为 true 便永久成立\n";
+}
+
 void test_multiple_weak_from_same_shared() {
     std::cout << "\n========== 测试 4:多个 WeakPtr 共享 SharedPtr ==========\n";
     
@@ -182,8 +371,8 @@ void test_multiple_weak_from_same_shared() {
     
     // 所有 WeakPtr 都应该有效
     for (const auto& wp : WeakPtrs) {
-        assert(!wp.expired());
-        assert(wp.use_count() == 1);
+        MY_CHECK(!wp.expired());
+        MY_CHECK(wp.use_count() == 1);
     }
     
     // 释放 SharedPtr
@@ -191,8 +380,8 @@ void test_multiple_weak_from_same_shared() {
     
     std::cout << "SharedPtr 释放后:\n";
     for (const auto& wp : WeakPtrs) {
-        assert(wp.expired());
-        assert(wp.use_count() == 0);
+        MY_CHECK(wp.expired());
+        MY_CHECK(wp.use_count() == 0);
     }
     
     std::cout << " 测试通过:多个 WeakPtr 正确\n";
@@ -297,6 +486,10 @@ int main() {
     test_basic_usage();
     test_WeakPtr_lifetime();
     test_lock_race_condition();
+    test_lock_after_death_is_sticky();
+    test_lock_revive_window();
+    test_lock_throughput_scaling();
+    test_expired_is_final();
     test_multiple_weak_from_same_shared();
     test_reset_and_swap();
     test_WeakPtr_copy_and_move();
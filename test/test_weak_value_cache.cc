@@ -0,0 +1,269 @@
+#include "my_weak_value_cache.h"
+#include "test_check.h"
+
+#include <atomic>
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// 测试用类
+// ============================================================================
+
+class Resource {
+public:
+    Resource(int id) : id_(id) {
+        ++resource_count;
+    }
+
+    Resource(Resource&& other) : id_(other.id_) {
+        ++resource_count;
+    }
+
+    ~Resource() {
+        --resource_count;
+    }
+
+    int id_;
+    static std::atomic<int> resource_count;
+};
+
+std::atomic<int> Resource::resource_count{0};
+
+// 统计存活副本的键:映射表和控制块各持有一份
+struct TrackedKey {
+    int id;
+    explicit TrackedKey(int i) : id(i) { ++live; }
+    TrackedKey(const TrackedKey& other) : id(other.id) { ++live; }
+    ~TrackedKey() { --live; }
+    bool operator==(const TrackedKey& other) const { return id == other.id; }
+
+    static std::atomic<int> live;
+};
+
+std::atomic<int> TrackedKey::live{0};
+
+struct TrackedKeyHash {
+    size_t operator()(const TrackedKey& key) const { return std::hash<int>()(key.id); }
+};
+
+// ============================================================================
+// 测试函数
+// ============================================================================
+
+void test_hit_and_eager_purge() {
+    std::cout << "\n========== 测试 1:命中与即时清理 ==========\n";
+
+    my::WeakValueCache<int, Resource> cache;
+    int builds = 0;
+    auto factory = [&builds](int id) { ++builds; return Resource(id); };
+
+    {
+        my::SharedPtr<Resource> r1 = cache.GetOrCreate(1, factory);
+        my::SharedPtr<Resource> r2 = cache.GetOrCreate(2, factory);
+        my::SharedPtr<Resource> r1_again = cache.GetOrCreate(1, factory);
+
+        assert(r1.get() == r1_again.get());
+        assert(builds == 2);
+        assert(cache.size() == 2);
+        assert(cache.Get(2).get() == r2.get());
+
+        // r2 的最后一个强引用释放,释放线程随即删除条目(无需扫描)
+        r2.Reset();
+        std::cout << "r2 释放后 size: " << cache.size() << "\n";
+        assert(cache.size() == 1);
+        assert(!cache.Get(2));
+    }
+
+    std::cout << "所有引用释放后 size: " << cache.size() << "\n";
+    assert(cache.size() == 0);
+    assert(Resource::resource_count == 0);
+
+    // 过期后再次获取会重新构建
+    my::SharedPtr<Resource> r1 = cache.GetOrCreate(1, factory);
+    assert(builds == 3);
+    assert(r1->id_ == 1);
+
+    std::cout << " 测试通过:过期条目由钩子登记后删除\n";
+}
+
+void test_concurrent_build_once() {
+    std::cout << "\n========== 测试 2:并发未命中只构建一次 ==========\n";
+
+    constexpr int NUM_THREADS = 8;
+    constexpr int NUM_KEYS = 64;
+
+    my::WeakValueCache<int, Resource> cache(4);
+    std::atomic<int> builds{0};
+    std::vector<my::SharedPtr<Resource>> results(NUM_THREADS * NUM_KEYS);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NUM_THREADS; ++t) {
+        threads.emplace_back([&cache, &builds, &results, t]() {
+            for (int k = 0; k < NUM_KEYS; ++k) {
+                results[t * NUM_KEYS + k] = cache.GetOrCreate(k, [&builds](int id) {
+                    ++builds;
+                    std::this_thread::yield();
+                    return Resource(id);
+                });
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    std::cout << "构建次数: " << builds.load() << " (键数 " << NUM_KEYS << ")\n";
+    assert(builds == NUM_KEYS);
+    for (int t = 1; t < NUM_THREADS; ++t) {
+        for (int k = 0; k < NUM_KEYS; ++k) {
+            assert(results[t * NUM_KEYS + k].get() == results[k].get());
+        }
+    }
+
+    results.clear();
+    assert(cache.size() == 0);
+    assert(Resource::resource_count == 0);
+
+    std::cout << " 测试通过:每个键只构建一次\n";
+}
+
+void test_churn_under_contention() {
+    std::cout << "\n========== 测试 3:并发获取与释放 ==========\n";
+
+    constexpr int NUM_THREADS = 8;
+    constexpr int ITERATIONS = 20000;
+
+    my::WeakValueCache<int, Resource> cache;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NUM_THREADS; ++t) {
+        threads.emplace_back([&cache, t]() {
+            for (int i = 0; i < ITERATIONS; ++i) {
+                int key = (i + t) % 16;
+                my::SharedPtr<Resource> r = cache.GetOrCreate(key, [](int id) {
+                    return Resource(id);
+                });
+                assert(r->id_ == key);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    std::cout << "结束后 size: " << cache.size() << "\n";
+    assert(cache.size() == 0);
+    assert(Resource::resource_count == 0);
+
+    std::cout << " 测试通过:高频创建/过期无残留条目\n";
+}
+
+void test_values_outlive_cache() {
+    std::cout << "\n========== 测试 4:值比缓存活得久 ==========\n";
+
+    my::SharedPtr<Resource> survivor;
+    {
+        my::WeakValueCache<std::string, Resource> cache;
+        survivor = cache.GetOrCreate("config", [](const std::string&) {
+            return Resource(7);
+        });
+        // 已析构、尚未清理的值:缓存销毁时归还它的控制块
+        cache.GetOrCreate("stale", [](const std::string&) { return Resource(8); });
+    }
+
+    // 缓存已销毁,钩子发现缓存不在了,直接跳过
+    assert(survivor->id_ == 7);
+    survivor.Reset();
+    assert(Resource::resource_count == 0);
+
+    std::cout << " 测试通过:缓存先销毁时钩子安全跳过\n";
+}
+
+void test_nested_release_same_shard() {
+    std::cout << "\n========== 测试 5:值的析构函数释放同一分片的另一个值 ==========\n";
+
+    // 只有一个分片:父值析构时释放子值,两个钩子都落在同一分片上
+    struct Node {
+        int id;
+        my::SharedPtr<Node> child;
+        explicit Node(int i) : id(i) {}
+    };
+    my::WeakValueCache<int, Node> cache(1);
+    auto make_node = [](int id) { return Node(id); };
+
+    my::SharedPtr<Node> parent = cache.GetOrCreate(1, make_node);
+    parent->child = cache.GetOrCreate(2, make_node);
+    parent->child->child = cache.GetOrCreate(3, make_node);
+    assert(cache.size() == 3);
+
+    // 整条链在 Dispose() 里依次析构;钩子只 try_lock,不会自锁
+    parent.Reset();
+    assert(!cache.Get(1) && !cache.Get(2) && !cache.Get(3));
+    std::cout << "链释放后 size: " << cache.size() << "\n";
+    assert(cache.size() == 0);
+
+    // 过期后再次获取:先清理旧条目,再重新构建
+    my::SharedPtr<Node> first = cache.GetOrCreate(4, make_node);
+    first.Reset();
+    my::SharedPtr<Node> rebuilt = cache.GetOrCreate(4, make_node);
+    assert(cache.size() == 1);
+    assert(cache.Get(4).get() == rebuilt.get());
+
+    std::cout << " 测试通过:同一分片的嵌套释放不加锁、不死锁\n";
+}
+
+void test_untouched_shard_is_purged() {
+    std::cout << "\n========== 测试 6:之后不再访问的分片也会删除条目 ==========\n";
+
+    my::WeakValueCache<TrackedKey, Resource, TrackedKeyHash> cache;
+    my::SharedPtr<Resource> value =
+        cache.GetOrCreate(TrackedKey(7), [](const TrackedKey& key) { return Resource(key.id); });
+    MY_CHECK(TrackedKey::live == 2);  // 映射表的键 + 控制块里的键
+
+    // 释放后不再访问缓存:条目和控制块(连同键)在释放时就已回收
+    value.Reset();
+    std::cout << "释放后存活的键: " << TrackedKey::live.load() << "\n";
+    MY_CHECK(TrackedKey::live == 0);
+    MY_CHECK(cache.size() == 0);
+
+    // 持锁期间登记的条目由持锁线程解锁后接手
+    std::vector<my::SharedPtr<Resource>> values;
+    for (int i = 0; i < 64; ++i) {
+        values.push_back(cache.GetOrCreate(
+            TrackedKey(i), [](const TrackedKey& key) { return Resource(key.id); }));
+    }
+    std::atomic<bool> stop{false};
+    std::thread reader([&cache, &stop]() {
+        while (!stop.load()) cache.Get(TrackedKey(-1));
+    });
+    values.clear();
+    stop = true;
+    reader.join();
+    std::cout << "并发访问时释放后存活的键: " << TrackedKey::live.load() << "\n";
+    MY_CHECK(TrackedKey::live == 0);
+
+    std::cout << " 测试通过:条目不依赖后续访问即被删除\n";
+}
+
+// ============================================================================
+// 主函数
+// ============================================================================
+
+int main() {
+    std::cout << "\n";
+    std::cout << "╔══════════════════════════════════════╗\n";
+    std::cout << "║   WeakValueCache: 弱值并发缓存       ║\n";
+    std::cout << "╚══════════════════════════════════════╝\n";
+
+    test_hit_and_eager_purge();
+    test_concurrent_build_once();
+    test_churn_under_contention();
+    test_values_outlive_cache();
+    test_nested_release_same_shard();
+    test_untouched_shard_is_purged();
+
+    return 0;
+}
@@ -0,0 +1,311 @@
+// bench_compare: 比较两次 benchmark --json= 的结果
+//
+// 用法: bench_compare base.json new.json [--alpha=0.05] [--threshold=0.03]
+//
+// 对两边都存在的每个用例,用 Mann-Whitney U 检验比较各次重复的 ns/op 样本
+// (不假设正态分布,对偶发的调度噪声稳健)。
+// 只有 p < alpha 且中位数变化超过 threshold 时才判为显著。
+// 退出码:0 = 无显著变慢,1 = 至少一个用例显著变慢,2 = 参数或文件错误。
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// 最小 JSON 解析器(只支持 benchmark 输出用到的子集)
+// ============================================================================
+
+struct JsonValue {
+    enum Type { kNull, kBool, kNumber, kString, kArray, kObject };
+
+    Type type = kNull;
+    bool boolean = false;
+    double number = 0;
+    std::string string;
+    std::vector<JsonValue> array;
+    std::map<std::string, JsonValue> object;
+
+    const JsonValue* Get(const std::string& key) const {
+        auto it = object.find(key);
+        return it == object.end() ? nullptr : &it->second;
+    }
+};
+
+class JsonParser {
+public:
+    explicit JsonParser(const std::string& text) : text_(text), pos_(0) {}
+
+    bool Parse(JsonValue* value) {
+        if (!ParseValue(value)) return false;
+        SkipSpace();
+        return pos_ == text_.size();
+    }
+
+    size_t position() const { return pos_; }
+
+private:
+    void SkipSpace() {
+        while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+            ++pos_;
+        }
+    }
+
+    bool Consume(char ch) {
+        SkipSpace();
+        if (pos_ < text_.size() && text_[pos_] == ch) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    bool ParseLiteral(const char* literal) {
+        size_t n = std::char_traits<char>::length(literal);
+        if (text_.compare(pos_, n, literal) != 0) return false;
+        pos_ += n;
+        return true;
+    }
+
+    bool ParseString(std::string* out) {
+        if (!Consume('"')) return false;
+        while (pos_ < text_.size()) {
+            char ch = text_[pos_++];
+            if (ch == '"') return true;
+            if (ch == '\\') {
+                if (pos_ >= text_.size()) return false;
+                char esc = text_[pos_++];
+                switch (esc) {
+                    case 'n': out->push_back('\n'); break;
+                    case 't': out->push_back('\t'); break;
+                    case 'u':  // 只会出现控制字符,按单字节处理
+                        if (pos_ + 4 > text_.size()) return false;
+                        out->push_back(static_cast<char>(
+                            std::strtol(text_.substr(pos_, 4).c_str(), nullptr, 16)));
+                        pos_ += 4;
+                        break;
+                    default: out->push_back(esc); break;
+                }
+            } else {
+                out->push_back(ch);
+            }
+        }
+        return false;
+    }
+
+    bool ParseValue(JsonValue* value) {
+        SkipSpace();
+        if (pos_ >= text_.size()) return false;
+        char ch = text_[pos_];
+        if (ch == '{') {
+            ++pos_;
+            value->type = JsonValue::kObject;
+            if (Consume('}')) return true;
+            do {
+                std::string key;
+                SkipSpace();
+                if (!ParseString(&key) || !Consume(':')) return false;
+                if (!ParseValue(&value->object[key])) return false;
+            } while (Consume(','));
+            return Consume('}');
+        }
+        if (ch == '[') {
+            ++pos_;
+            value->type = JsonValue::kArray;
+            if (Consume(']')) return true;
+            do {
+                value->array.push_back(JsonValue());
+                if (!ParseValue(&value->array.back())) return false;
+            } while (Consume(','));
+            return Consume(']');
+        }
+        if (ch == '"') {
+            value->type = JsonValue::kString;
+            return ParseString(&value->string);
+        }
+        if (ParseLiteral("true")) {
+            value->type = JsonValue::kBool;
+            value->boolean = true;
+            return true;
+        }
+        if (ParseLiteral("false")) {
+            value->type = JsonValue::kBool;
+            return true;
+        }
+        if (ParseLiteral("null")) return true;
+
+        const char* begin = text_.c_str() + pos_;
+        char* end = nullptr;
+        value->number = std::strtod(begin, &end);
+        if (end == begin) return false;
+        value->type = JsonValue::kNumber;
+        pos_ += end - begin;
+        return true;
+    }
+
+    const std::string& text_;
+    size_t pos_;
+};
+
+// ============================================================================
+// 结果文件
+// ============================================================================
+
+struct Benchmark {
+    double median_ns = 0;
+    std::vector<double> samples;
+};
+
+typedef std::map<std::string, Benchmark> ResultSet;
+
+bool LoadResults(const std::string& path, ResultSet* results, std::vector<std::string>* order) {
+    std::ifstream in(path.c_str());
+    if (!in) {
+        std::cerr << "无法打开 " << path << "\n";
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    std::string text = buffer.str();
+
+    JsonValue root;
+    JsonParser parser(text);
+    if (!parser.Parse(&root)) {
+        std::cerr << path << ": JSON 解析失败(位置 " << parser.position() << ")\n";
+        return false;
+    }
+    const JsonValue* benchmarks = root.Get("benchmarks");
+    if (!benchmarks || benchmarks->type != JsonValue::kArray) {
+        std::cerr << path << ": 缺少 benchmarks 数组\n";
+        return false;
+    }
+    for (const JsonValue& item : benchmarks->array) {
+        const JsonValue* name = item.Get("name");
+        const JsonValue* median = item.Get("median_ns");
+        const JsonValue* samples = item.Get("samples_ns");
+        if (!name || !median || !samples) continue;
+        Benchmark& b = (*results)[name->string];
+        b.median_ns = median->number;
+        for (const JsonValue& s : samples->array) b.samples.push_back(s.number);
+        if (order) order->push_back(name->string);
+    }
+    return true;
+}
+
+// ============================================================================
+// Mann-Whitney U 检验(正态近似,含同秩修正),返回双侧 p 值
+// ============================================================================
+
+double MannWhitneyP(const std::vector<double>& a, const std::vector<double>& b) {
+    const size_t n1 = a.size(), n2 = b.size();
+    if (n1 == 0 || n2 == 0) return 1;
+
+    std::vector<std::pair<double, int>> all;
+    for (double v : a) all.push_back(std::make_pair(v, 0));
+    for (double v : b) all.push_back(std::make_pair(v, 1));
+    std::sort(all.begin(), all.end());
+
+    // 计算秩(相同值取平均秩),并累计同秩修正项
+    const size_t n = all.size();
+    double rank_sum_a = 0;
+    double tie_term = 0;
+    for (size_t i = 0; i < n;) {
+        size_t j = i;
+        while (j + 1 < n && all[j + 1].first == all[i].first) ++j;
+        double rank = (i + j) / 2.0 + 1;
+        for (size_t k = i; k <= j; ++k) {
+            if (all[k].second == 0) rank_sum_a += rank;
+        }
+        double t = static_cast<double>(j - i + 1);
+        tie_term += t * t * t - t;
+        i = j + 1;
+    }
+
+    double u = rank_sum_a - n1 * (n1 + 1) / 2.0;
+    double mean = n1 * n2 / 2.0;
+    double variance = n1 * n2 / 12.0 * ((n + 1) - tie_term / (double(n) * (n - 1)));
+    if (variance <= 0) return 1;
+    double z = (std::fabs(u - mean) - 0.5) / std::sqrt(variance);  // 连续性修正
+    if (z < 0) z = 0;
+    return std::erfc(z / std::sqrt(2.0));
+}
+
+// ============================================================================
+// 主函数
+// ============================================================================
+
+int main(int argc, char** argv) {
+    std::vector<std::string> files;
+    double alpha = 0.05;
+    double threshold = 0.03;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 8, "--alpha=") == 0) {
+            alpha = std::atof(arg.c_str() + 8);
+        } else if (arg.compare(0, 12, "--threshold=") == 0) {
+            threshold = std::atof(arg.c_str() + 12);
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (files.size() != 2) {
+        std::cerr << "用法: " << argv[0]
+                  << " base.json new.json [--alpha=0.05] [--threshold=0.03]\n";
+        return 2;
+    }
+
+    ResultSet base, current;
+    std::vector<std::string> order;
+    if (!LoadResults(files[0], &base, nullptr) ||
+        !LoadResults(files[1], &current, &order)) {
+        return 2;
+    }
+
+    std::cout << std::left << std::setw(52) << "用例" << std::right
+              << std::setw(12) << "基线ns/op" << std::setw(12) << "当前ns/op"
+              << std::setw(10) << "变化" << std::setw(10) << "p" << "  结论\n";
+    std::cout << std::string(104, '-') << "\n";
+
+    int regressions = 0, improvements = 0;
+    for (const std::string& name : order) {
+        auto it = base.find(name);
+        if (it == base.end()) continue;
+        const Benchmark& before = it->second;
+        const Benchmark& after = current[name];
+
+        double change = before.median_ns > 0
+                            ? (after.median_ns - before.median_ns) / before.median_ns
+                            : 0;
+        double p = MannWhitneyP(before.samples, after.samples);
+        bool significant = p < alpha && std::fabs(change) >= threshold;
+
+        const char* verdict = "无显著差异";
+        if (significant && change > 0) {
+            verdict = "变慢";
+            ++regressions;
+        } else if (significant) {
+            verdict = "变快";
+            ++improvements;
+        }
+
+        std::cout << std::left << std::setw(52) << name << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(12) << before.median_ns
+                  << std::setw(12) << after.median_ns
+                  << std::setw(9) << std::showpos << std::setprecision(1) << change * 100
+                  << "%" << std::noshowpos << std::setw(10) << std::setprecision(4) << p
+                  << "  " << verdict << "\n";
+    }
+
+    std::cout << "\n显著变慢: " << regressions << "  显著变快: " << improvements
+              << "  (alpha=" << std::setprecision(3) << alpha
+              << ", 阈值=" << std::setprecision(1) << threshold * 100 << "%)\n";
+    return regressions ? 1 : 0;
+}
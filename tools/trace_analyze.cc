@@ -0,0 +1,262 @@
+// trace_analyze: 分析 my::trace_dump() 写出的生命周期跟踪文件
+//
+// 用法: trace_analyze trace.bin [--top=10] [--object=0x地址]
+//
+// 按控制块地址把记录串成对象实例(地址被复用时,新的 create 开始新实例),
+// 用 create = 1、copy/weak_lock = +1、release = -1 重建所有者数量随时间的变化。
+// 输出:
+// - 各事件总数
+// - 按类型汇总:实例数、寿命(create -> dispose)p50/max、最大所有者数
+// - 所有者数最多的前 N 个实例
+// - 跟踪结束时既未 dispose 也未 destroy 的实例(可能泄漏,或只是还活着);
+//   没有 dispose 就 destroy 的是从未交出引用就被丢弃的控制块
+//   (例如 LazySharedPtr 并发首次共享时落败的一方),不算存活
+// - --object= 指定地址的完整时间线
+// 环形缓冲写满后最早的记录会被覆盖,create 之前就开始的实例标为"(create 已丢失)"。
+// 退出码:0 = 成功,2 = 参数或文件错误。
+
+#include "my_lifecycle_trace.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// 一个对象实例(控制块地址的一次使用)
+struct Instance {
+    uint64_t block = 0;
+    std::string type = "(create 已丢失)";
+    bool created = false;
+    bool disposed = false;
+    bool destroyed = false;
+    uint64_t created_ns = 0;
+    uint64_t disposed_ns = 0;
+    int64_t owners = 0;      // 重建的当前所有者数
+    int64_t max_owners = 0;
+    uint64_t events = 0;
+    std::vector<size_t> records;  // 在记录数组中的下标(仅 --object 时保存)
+};
+
+struct TypeSummary {
+    uint64_t instances = 0;
+    uint64_t alive = 0;
+    int64_t max_owners = 0;
+    std::vector<uint64_t> lifetimes_ns;
+};
+
+uint64_t Percentile(std::vector<uint64_t> values, double p) {
+    if (values.empty()) return 0;
+    std::sort(values.begin(), values.end());
+    size_t index = static_cast<size_t>(p / 100.0 * (values.size() - 1) + 0.5);
+    return values[std::min(index, values.size() - 1)];
+}
+
+std::string FormatDuration(uint64_t ns) {
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(1);
+    if (ns < 1000) {
+        os << ns << "ns";
+    } else if (ns < 1000000) {
+        os << ns / 1e3 << "us";
+    } else if (ns < 1000000000) {
+        os << ns / 1e6 << "ms";
+    } else {
+        os << ns / 1e9 << "s";
+    }
+    return os.str();
+}
+
+std::string FormatAddress(uint64_t address) {
+    std::ostringstream os;
+    os << "0x" << std::hex << address;
+    return os.str();
+}
+
+bool ParseFlag(const std::string& arg, const char* flag, std::string* value) {
+    std::string prefix = std::string("--") + flag + "=";
+    if (arg.compare(0, prefix.size(), prefix) != 0) return false;
+    *value = arg.substr(prefix.size());
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string path;
+    size_t top_n = 10;
+    uint64_t object = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        std::string value;
+        if (ParseFlag(arg, "top", &value)) {
+            top_n = static_cast<size_t>(std::max(0, std::atoi(value.c_str())));
+        } else if (ParseFlag(arg, "object", &value)) {
+            object = std::strtoull(value.c_str(), nullptr, 0);
+        } else if (path.empty() && arg.compare(0, 2, "--") != 0) {
+            path = arg;
+        } else {
+            path.clear();
+            break;
+        }
+    }
+    if (path.empty()) {
+        std::cerr << "用法: " << argv[0] << " trace.bin [--top=10] [--object=0x地址]\n";
+        return 2;
+    }
+
+    my::TraceFile file;
+    if (!my::read_trace_file(path, &file)) {
+        std::cerr << "无法读取跟踪文件 " << path << "\n";
+        return 2;
+    }
+    const std::vector<my::TraceRecord>& records = file.records;
+    if (records.empty()) {
+        std::cout << "跟踪文件为空\n";
+        return 0;
+    }
+
+    // ---- 重建实例 ----
+    std::vector<Instance> instances;
+    std::unordered_map<uint64_t, size_t> current;  // 地址 -> 当前实例
+    std::map<uint16_t, uint64_t> event_counts;
+    for (size_t i = 0; i < records.size(); ++i) {
+        const my::TraceRecord& record = records[i];
+        ++event_counts[record.event];
+
+        auto it = current.find(record.block);
+        bool starts_new = record.event == my::kTraceCreate || it == current.end() ||
+                          instances[it->second].destroyed;
+        if (starts_new) {
+            instances.push_back(Instance());
+            instances.back().block = record.block;
+            current[record.block] = instances.size() - 1;
+            it = current.find(record.block);
+        }
+        Instance& instance = instances[it->second];
+        ++instance.events;
+        if (record.block == object) instance.records.push_back(i);
+
+        switch (record.event) {
+            case my::kTraceCreate: {
+                auto name = file.type_names.find(static_cast<uint64_t>(record.value));
+                instance.type = name == file.type_names.end() ? "?" : name->second;
+                instance.created = true;
+                instance.created_ns = record.timestamp_ns;
+                instance.owners = 1;
+                break;
+            }
+            case my::kTraceCopy:
+            case my::kTraceWeakLock:
+                ++instance.owners;
+                break;
+            case my::kTraceRelease:
+                --instance.owners;
+                break;
+            case my::kTraceDispose:
+                instance.disposed = true;
+                instance.disposed_ns = record.timestamp_ns;
+                break;
+            case my::kTraceDestroy:
+                instance.destroyed = true;
+                break;
+            default:
+                break;
+        }
+        instance.max_owners = std::max(instance.max_owners, instance.owners);
+    }
+
+    uint64_t span = records.back().timestamp_ns - records.front().timestamp_ns;
+    std::cout << "记录 " << records.size() << " 条, 时间跨度 " << FormatDuration(span)
+              << ", 对象实例 " << instances.size() << " 个\n\n";
+
+    std::cout << "事件:\n";
+    for (const auto& entry : event_counts) {
+        std::cout << "  " << std::left << std::setw(18) << my::trace_event_name(entry.first)
+                  << std::right << entry.second << "\n";
+    }
+
+    // ---- 按类型汇总 ----
+    std::map<std::string, TypeSummary> by_type;
+    for (const Instance& instance : instances) {
+        TypeSummary& summary = by_type[instance.type];
+        ++summary.instances;
+        summary.max_owners = std::max(summary.max_owners, instance.max_owners);
+        if (instance.created && instance.disposed) {
+            summary.lifetimes_ns.push_back(instance.disposed_ns - instance.created_ns);
+        }
+        if (!instance.disposed && !instance.destroyed) ++summary.alive;
+    }
+    std::cout << "\n按类型:\n"
+              << "  " << std::left << std::setw(40) << "类型" << std::right << std::setw(10)
+              << "实例" << std::setw(10) << "未释放" << std::setw(12) << "寿命p50"
+              << std::setw(12) << "寿命max" << "  最大所有者\n";
+    for (const auto& entry : by_type) {
+        const TypeSummary& summary = entry.second;
+        std::cout << "  " << std::left << std::setw(40) << entry.first << std::right
+                  << std::setw(10) << summary.instances << std::setw(10) << summary.alive
+                  << std::setw(12) << FormatDuration(Percentile(summary.lifetimes_ns, 50))
+                  << std::setw(12) << FormatDuration(Percentile(summary.lifetimes_ns, 100))
+                  << std::setw(12) << summary.max_owners << "\n";
+    }
+
+    // ---- 所有者最多的实例 ----
+    std::vector<const Instance*> ranked;
+    for (const Instance& instance : instances) ranked.push_back(&instance);
+    std::stable_sort(ranked.begin(), ranked.end(), [](const Instance* a, const Instance* b) {
+        return a->max_owners > b->max_owners;
+    });
+    if (ranked.size() > top_n) ranked.resize(top_n);
+    std::cout << "\n所有者最多的 " << ranked.size() << " 个实例:\n";
+    for (const Instance* instance : ranked) {
+        std::cout << "  " << FormatAddress(instance->block) << "  " << instance->type
+                  << "  最大所有者=" << instance->max_owners << "  事件=" << instance->events
+                  << (instance->disposed || instance->destroyed ? "" : "  (未释放)") << "\n";
+    }
+
+    // ---- 跟踪结束时仍存活 ----
+    size_t alive = 0;
+    for (const Instance& instance : instances) {
+        if (instance.created && !instance.disposed && !instance.destroyed) ++alive;
+    }
+    std::cout << "\n跟踪结束时仍存活(有 create 但没有 dispose/destroy): " << alive << " 个\n";
+    size_t shown = 0;
+    for (const Instance& instance : instances) {
+        if (!instance.created || instance.disposed || instance.destroyed) continue;
+        if (shown++ == top_n) {
+            std::cout << "  ...\n";
+            break;
+        }
+        std::cout << "  " << FormatAddress(instance.block) << "  " << instance.type
+                  << "  当前所有者=" << instance.owners << "  已存活 "
+                  << FormatDuration(records.back().timestamp_ns - instance.created_ns) << "\n";
+    }
+
+    // ---- 单个对象的时间线 ----
+    if (object != 0) {
+        std::cout << "\n" << FormatAddress(object) << " 的时间线:\n";
+        uint64_t origin = records.front().timestamp_ns;
+        for (const Instance& instance : instances) {
+            if (instance.block != object) continue;
+            std::cout << "  -- 实例: " << instance.type << "\n";
+            int64_t owners = 0;
+            for (size_t index : instance.records) {
+                const my::TraceRecord& record = records[index];
+                if (record.event == my::kTraceCreate) owners = 1;
+                if (record.event == my::kTraceCopy || record.event == my::kTraceWeakLock) ++owners;
+                if (record.event == my::kTraceRelease) --owners;
+                std::cout << "  " << std::setw(12) << FormatDuration(record.timestamp_ns - origin)
+                          << "  线程 " << std::setw(3) << record.thread << "  " << std::left
+                          << std::setw(18) << my::trace_event_name(record.event) << std::right
+                          << "所有者=" << owners << "\n";
+            }
+        }
+    }
+    return 0;
+}